@@ -0,0 +1,539 @@
+// -----------------------------------------------------------------------------
+// BatchRenderer.cpp                                           BatchRenderer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref BatchRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <fcntl.h>     /* open() */
+#include <unistd.h>    /* close(), unlink() */
+#include <sys/stat.h>  /* stat() */
+#include <algorithm>   /* stable_sort(), max() */
+#include <fstream>
+#include <sstream>
+#include "message.h"
+#include "WorkerPool.h"
+#include "BatchRenderer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ------
+// larger
+// ------
+/**
+ * @brief  This function orders jobs by decreasing input size.
+ */
+static bool larger(const BatchRenderer::Job* a, const BatchRenderer::Job* b)
+{
+  return (a->size > b->size);
+}
+
+// --------
+// poolSize
+// --------
+/**
+ * @brief  This function returns the number of threads used for some tasks.
+ */
+static unsigned poolSize(unsigned threads, size_t tasks)
+{
+  // one thread per processor
+  if (threads == 0) threads = WorkerPool::processors();
+
+  // don't start more threads than files
+  if (threads > tasks) threads = tasks;
+
+  return threads;
+}
+
+// ------
+// runAll
+// ------
+/**
+ * @brief  This function runs all tasks on a new pool and waits for them.
+ */
+template <typename TASK>
+static void runAll(vector<TASK>& tasks, unsigned threads)
+{
+  WorkerPool pool( poolSize(threads, tasks.size()) );
+
+  for(typename vector<TASK>::size_type i = 0; i < tasks.size(); i++)
+  {
+    pool.submit(&tasks[i]);
+  }
+
+  pool.wait();
+}
+
+
+// -----------------------------------------------------------------------------
+// Tasks                                                                   Tasks
+// -----------------------------------------------------------------------------
+
+// ----------
+// RenderTask
+// ----------
+/**
+ * @brief  This task renders a single file.
+ *
+ * The lines are remembered by the memo of the thread that runs the task,
+ * so the memo lasts across files.
+ */
+class RenderTask : public WorkerPool::Task
+{
+
+public:
+
+  /// the constructor
+  RenderTask(BatchRenderer::Job& job, const LaTeXGenerator& generator, RenderCache* cache, vector<LineMemo>* memos)
+  : m_job(&job), m_generator(&generator), m_cache(cache), m_memos(memos)
+  {
+  }
+
+  /// this method renders the input file to the output file
+  void run()
+  {
+    // open input file
+    int in = open(m_job->input.c_str(), O_RDONLY);
+
+    if (in < 0)
+    {
+      m_job->error = "cannot open input file";
+
+      return;
+    }
+
+    // create output file
+    int out = open(m_job->output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+    if (out < 0)
+    {
+      m_job->error = "cannot create output file";
+
+      close(in);
+
+      return;
+    }
+
+    bool success;
+    bool written;
+
+    // a private copy of the generator's settings
+    LaTeXGenerator generator(*m_generator);
+
+    // counters of this file
+    RenderStats* stats = (generator.stats() != 0) ? &m_stats : 0;
+
+    generator.setStats(stats);
+
+    // memo of this thread
+    if (m_memos != 0) generator.setMemo( &(*m_memos)[ worker() ] );
+
+    FdSink    fdSink(out);
+    StatsSink statsSink(fdSink, m_stats);
+
+    OutputSink& sink = (stats != 0) ? static_cast<OutputSink&>(statsSink) : fdSink;
+
+    if (m_cache != 0)
+    {
+      InputReader reader;
+      reader.setStats(stats);
+      reader.open(in);
+
+      const char* data;
+      size_t      size;
+
+      reader.contents(data, size);
+
+      success = m_cache->render(generator, data, size, sink, written);
+    }
+
+    // scope of reader and buffer
+    else
+    {
+      InputReader reader;
+      reader.setStats(stats);
+      reader.open(in);
+
+      OutputBuffer buffer(sink);
+
+      success = generator.parse(reader, buffer);
+
+      buffer.flush();
+
+      written = buffer.good();
+    }
+
+    if (close(out) != 0) written = false;
+
+    close(in);
+
+    // rejected lines
+    m_job->problems = generator.problems();
+
+    // check result
+    if ( !written )
+    {
+      m_job->error = "cannot write output file";
+    }
+
+    else if ( !success )
+    {
+      m_job->error = "invalid markup";
+    }
+
+    // don't leave incomplete output behind
+    if ( !m_job->error.empty() )
+    {
+      unlink( m_job->output.c_str() );
+    }
+  }
+
+  /// the counters of this file
+  const RenderStats& stats() const
+  {
+    return m_stats;
+  }
+
+private:
+
+  /// the file to render
+  BatchRenderer::Job* m_job;
+
+  /// the settings
+  const LaTeXGenerator* m_generator;
+
+  /// the cache (if any)
+  RenderCache* m_cache;
+
+  /// the counters of this file (used if the settings have counters)
+  RenderStats m_stats;
+
+  /// the memos of all threads (0 if the settings have no memo)
+  vector<LineMemo>* m_memos;
+
+};
+
+// ---------
+// CheckTask
+// ---------
+/**
+ * @brief  This task checks the markup of a single file.
+ */
+class CheckTask : public WorkerPool::Task
+{
+
+public:
+
+  /// the constructor
+  CheckTask(BatchRenderer::Job& job, const MarkupChecker& checker)
+  : m_job(&job), m_checker(&checker)
+  {
+  }
+
+  /// this method checks the input file
+  void run()
+  {
+    // open input file
+    int in = open(m_job->input.c_str(), O_RDONLY);
+
+    if (in < 0)
+    {
+      m_job->error = "cannot open input file";
+
+      return;
+    }
+
+    // scope of reader
+    {
+      InputReader reader;
+      reader.open(in);
+
+      m_checker->check(reader, m_job->problems);
+    }
+
+    close(in);
+  }
+
+private:
+
+  /// the file to check
+  BatchRenderer::Job* m_job;
+
+  /// the trigger
+  const MarkupChecker* m_checker;
+
+};
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -------------
+// BatchRenderer
+// -------------
+/*
+ *
+ */
+BatchRenderer::BatchRenderer()
+{
+  m_cache = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// ---
+// add
+// ---
+/*
+ *
+ */
+void BatchRenderer::add(const string& input, const string& output)
+{
+  Job job;
+
+  job.input  = input;
+  job.output = output;
+  job.size   = 0;
+
+  m_jobs.push_back(job);
+}
+
+// ------------
+// readManifest
+// ------------
+/*
+ *
+ */
+bool BatchRenderer::readManifest(const string& path)
+{
+  ifstream manifest( path.c_str() );
+
+  if ( !manifest )
+  {
+    // notify user
+    msg::err( msg::catq("cannot open manifest: ", path) );
+
+    // signalize trouble
+    return false;
+  }
+
+  string   line;
+  unsigned number = 0;
+
+  while ( getline(manifest, line) )
+  {
+    number += 1;
+
+    stringstream fields(line);
+
+    string input;
+    string output;
+    string extra;
+
+    // skip empty lines
+    if ( !(fields >> input) ) continue;
+
+    // skip comments
+    if (input[0] == '#') continue;
+
+    // exactly two fields
+    if ( !(fields >> output) || (fields >> extra) )
+    {
+      // notify user
+      msg::err( msg::cat(msg::qcat(path, ":"), msg::cat(msg::str(number), ": expected input and output file")) );
+
+      // signalize trouble
+      return false;
+    }
+
+    add(input, output);
+  }
+
+  // signalize success
+  return true;
+}
+
+// --------
+// setCache
+// --------
+/*
+ *
+ */
+void BatchRenderer::setCache(RenderCache* cache)
+{
+  m_cache = cache;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool BatchRenderer::render(const LaTeXGenerator& generator, unsigned threads)
+{
+  // the order of execution
+  vector<Job*> order = schedule();
+
+  // one memo per thread, each with the full limit
+  vector<LineMemo> memos;
+
+  if (generator.memo() != 0) memos.resize(max(poolSize(threads, order.size()), 1u), LineMemo( generator.memo()->limit() ));
+
+  // the tasks must outlive the pool
+  vector<RenderTask> tasks;
+
+  tasks.reserve( order.size() );
+
+  for(vector<Job*>::size_type i = 0; i < order.size(); i++)
+  {
+    tasks.push_back( RenderTask(*order[i], generator, m_cache, (generator.memo() != 0) ? &memos : 0) );
+  }
+
+  runAll(tasks, threads);
+
+  // add up the counters of all files
+  if (generator.stats() != 0)
+  {
+    for(vector<RenderTask>::size_type i = 0; i < tasks.size(); i++)
+    {
+      generator.stats()->merge( tasks[i].stats() );
+    }
+  }
+
+  for(vector<LineMemo>::size_type i = 0; i < memos.size(); i++)
+  {
+    generator.memo()->merge( memos[i] );
+  }
+
+  // report failures in the given order
+  bool success = true;
+
+  for(vector<Job>::size_type i = 0; i < m_jobs.size(); i++)
+  {
+    const Job& job = m_jobs[i];
+
+    // notify user (recovered lines don't fail the file)
+    MarkupChecker::report(job.input, job.problems, job.error.empty());
+
+    if ( !job.error.empty() )
+    {
+      // notify user
+      msg::err( msg::qcat(job.input, msg::cat(": ", job.error)) );
+
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+// -----
+// check
+// -----
+/*
+ * Just like render(), the results are reported in the given order.
+ */
+bool BatchRenderer::check(const MarkupChecker& checker, unsigned threads)
+{
+  // the order of execution
+  vector<Job*> order = schedule();
+
+  // the tasks must outlive the pool
+  vector<CheckTask> tasks;
+
+  tasks.reserve( order.size() );
+
+  for(vector<Job*>::size_type i = 0; i < order.size(); i++)
+  {
+    tasks.push_back( CheckTask(*order[i], checker) );
+  }
+
+  runAll(tasks, threads);
+
+  // report failures in the given order
+  bool success = true;
+
+  for(vector<Job>::size_type i = 0; i < m_jobs.size(); i++)
+  {
+    const Job& job = m_jobs[i];
+
+    if ( !job.error.empty() )
+    {
+      // notify user
+      msg::err( msg::qcat(job.input, msg::cat(": ", job.error)) );
+
+      success = false;
+    }
+
+    if ( !job.problems.empty() )
+    {
+      // notify user
+      MarkupChecker::report(job.input, job.problems, false);
+
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// --------
+// schedule
+// --------
+/*
+ *
+ */
+vector<BatchRenderer::Job*> BatchRenderer::schedule()
+{
+  vector<Job*> order;
+
+  for(vector<Job>::size_type i = 0; i < m_jobs.size(); i++)
+  {
+    Job& job = m_jobs[i];
+
+    struct stat info;
+
+    job.size  = (stat(job.input.c_str(), &info) == 0) ? info.st_size : 0;
+    job.error = "";
+
+    job.problems.clear();
+
+    order.push_back(&job);
+  }
+
+  // largest files first
+  stable_sort(order.begin(), order.end(), larger);
+
+  return order;
+}
@@ -0,0 +1,175 @@
+// -----------------------------------------------------------------------------
+// BatchRenderer.h                                               BatchRenderer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref BatchRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef BATCHRENDERER_H_INCLUDE_NO1
+#define BATCHRENDERER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <sys/types.h>  /* off_t */
+#include <string>
+#include <vector>
+#include "LaTeXGenerator.h"
+#include "MarkupChecker.h"
+#include "RenderCache.h"
+
+
+// -------------
+// BatchRenderer
+// -------------
+/**
+ * @brief  This class renders many input files in one process.
+ *
+ * All files are rendered on a @ref WorkerPool, the largest ones first.
+ * Each worker uses its own copy of the given @ref LaTeXGenerator.
+ * A failing file doesn't stop the remaining ones.  Instead of rendering,
+ * the files can be checked only (the output files are ignored then).
+ */
+class BatchRenderer
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // Job
+  // ---
+  /**
+   * @brief  One input file and its output file.
+   */
+  struct Job
+  {
+    std::string input;   ///< the input file
+    std::string output;  ///< the output file
+    off_t       size;    ///< the size of the input file
+    std::string error;   ///< the reason of failure (empty on success)
+
+    /// the rejected lines (see check())
+    std::vector<MarkupChecker::Problem> problems;
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -------------
+  // BatchRenderer
+  // -------------
+  /**
+   * @brief  The standard-constructor.
+   */
+  BatchRenderer();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // add
+  // ---
+  /**
+   * @brief  This method adds one input file and its output file.
+   */
+  void add(const std::string& input, const std::string& output);
+
+  // ------------
+  // readManifest
+  // ------------
+  /**
+   * @brief  This method adds all pairs listed in the given file.
+   *
+   * Each line holds an input file and an output file separated by
+   * whitespace.  Empty lines and lines starting with # are ignored.
+   */
+  bool readManifest(const std::string& path);
+
+  // --------
+  // setCache
+  // --------
+  /**
+   * @brief  This method sets the cache used for all files (0 means none).
+   */
+  void setCache(RenderCache* cache);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders all files and reports each failure.
+   *
+   * @param generator  holds the settings used for all files.
+   * @param threads    holds the number of worker threads (0 means automatic).
+   *
+   * @return  false if at least one file failed
+   */
+  bool render(const LaTeXGenerator& generator, unsigned threads);
+
+  // -----
+  // check
+  // -----
+  /**
+   * @brief  This method checks the markup of all input files and reports
+   *         each rejected line.
+   *
+   * @param checker  holds the trigger used for all files.
+   * @param threads  holds the number of worker threads (0 means automatic).
+   *
+   * @return  false if at least one file failed
+   */
+  bool check(const MarkupChecker& checker, unsigned threads);
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // --------
+  // schedule
+  // --------
+  /**
+   * @brief  This method resets the results of all jobs and returns them
+   *         in the order of execution.
+   */
+  std::vector<Job*> schedule();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// all files to render
+  std::vector<Job> m_jobs;
+
+  /// the cache used for all files (if any)
+  RenderCache* m_cache;
+
+};
+
+#endif  /* #ifndef BATCHRENDERER_H_INCLUDE_NO1 */
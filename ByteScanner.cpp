@@ -0,0 +1,464 @@
+// -----------------------------------------------------------------------------
+// ByteScanner.cpp                                               ByteScanner.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref ByteScanner class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include "ByteScanner.h"
+
+// vector extensions (x86 only)
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define BYTESCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -----------
+// detectLevel
+// -----------
+/**
+ * @brief  This function returns the best implementation for this processor.
+ */
+static ByteScanner::Level detectLevel()
+{
+#ifdef BYTESCANNER_X86
+  __builtin_cpu_init();
+
+  if ( __builtin_cpu_supports("avx2") ) return ByteScanner::AVX2;
+
+  return ByteScanner::SSE2;
+#else
+  return ByteScanner::SCALAR;
+#endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Static members                                                 Static members
+// -----------------------------------------------------------------------------
+
+ByteScanner::Level ByteScanner::s_level = detectLevel();
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -----------
+// ByteScanner
+// -----------
+/*
+ *
+ */
+ByteScanner::ByteScanner()
+{
+  clear();
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// -----
+// clear
+// -----
+/*
+ *
+ */
+void ByteScanner::clear()
+{
+  for(unsigned i = 0; i < MAXBYTES; i++) m_bytes[i] = 0;
+
+  for(unsigned i = 0; i < 256; i++) m_member[i] = false;
+
+  m_count = 0;
+  m_below = 0;
+}
+
+// ---
+// add
+// ---
+/*
+ *
+ */
+bool ByteScanner::add(char c)
+{
+  // already part of the set
+  if ( contains(c) ) return true;
+
+  // no free slot
+  if (m_count == MAXBYTES) return false;
+
+  m_bytes[m_count] = c;
+
+  m_count += 1;
+
+  // unused slots repeat the first byte
+  for(unsigned i = m_count; i < MAXBYTES; i++) m_bytes[i] = m_bytes[0];
+
+  m_member[static_cast<unsigned char>(c)] = true;
+
+  // signalize success
+  return true;
+}
+
+// --------
+// addBelow
+// --------
+/*
+ *
+ */
+void ByteScanner::addBelow(unsigned char limit)
+{
+  if (limit > 128) limit = 128;
+
+  if (limit > m_below) m_below = limit;
+
+  for(unsigned i = 0; i < m_below; i++) m_member[i] = true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ----
+// find
+// ----
+/*
+ *
+ */
+const char* ByteScanner::find(const char* begin, const char* end) const
+{
+  // empty set
+  if ((m_count == 0) && (m_below == 0)) return end;
+
+  // most runs are short, so check some bytes before setting up vectors
+  const char* head = ((end - begin) > 16) ? begin + 16 : end;
+
+  while (begin != head)
+  {
+    if ( contains(*begin) ) return begin;
+
+    ++begin;
+  }
+
+  // short run without a member
+  if (begin == end) return end;
+
+  switch (s_level)
+  {
+    case AVX2: return findAVX2(begin, end);
+    case SSE2: return findSSE2(begin, end);
+    default:   break;
+  }
+
+  return findScalar(begin, end);
+}
+
+// ----
+// skip
+// ----
+/*
+ *
+ */
+const char* ByteScanner::skip(const char* begin, const char* end, size_t& count) const
+{
+  // nothing to pass
+  if (count == 0) return begin;
+
+  switch (s_level)
+  {
+    case AVX2: return skipAVX2(begin, end, count);
+    case SSE2: return skipSSE2(begin, end, count);
+    default:   break;
+  }
+
+  return skipScalar(begin, end, count);
+}
+
+// --------
+// setLevel
+// --------
+/*
+ *
+ */
+void ByteScanner::setLevel(Level level)
+{
+  Level best = detectLevel();
+
+  s_level = (level < best) ? level : best;
+}
+
+// --------
+// getLevel
+// --------
+/*
+ *
+ */
+ByteScanner::Level ByteScanner::getLevel()
+{
+  return s_level;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ----------
+// findScalar
+// ----------
+/*
+ *
+ */
+const char* ByteScanner::findScalar(const char* begin, const char* end) const
+{
+  while ((begin != end) && !contains(*begin)) ++begin;
+
+  return begin;
+}
+
+// --------
+// findSSE2
+// --------
+/*
+ * The set of single bytes always fills all 16 slots (unused slots repeat
+ * a member), so every block costs the same fixed number of comparisons.
+ * When only the limit is used, the slots hold 0, which is below it.
+ */
+const char* ByteScanner::findSSE2(const char* begin, const char* end) const
+{
+#ifdef BYTESCANNER_X86
+  // broadcast slots
+  __m128i set[MAXBYTES];
+
+  for(unsigned i = 0; i < MAXBYTES; i++)
+  {
+    set[i] = _mm_set1_epi8(m_bytes[i]);
+  }
+
+  // x <= max  <=>  min(x, max) == x
+  const bool    below = (m_below > 0);
+  const __m128i max   = _mm_set1_epi8(static_cast<char>(below ? m_below - 1 : 0));
+
+  while (end - begin >= 16)
+  {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+
+    __m128i hit = below ? _mm_cmpeq_epi8(_mm_min_epu8(x, max), x) : _mm_setzero_si128();
+
+    for(unsigned i = 0; i < MAXBYTES; i++)
+    {
+      hit = _mm_or_si128(hit, _mm_cmpeq_epi8(x, set[i]));
+    }
+
+    const int mask = _mm_movemask_epi8(hit);
+
+    if (mask != 0) return begin + __builtin_ctz(mask);
+
+    begin += 16;
+  }
+#endif
+
+  // remaining bytes
+  return findScalar(begin, end);
+}
+
+// --------
+// findAVX2
+// --------
+/*
+ *
+ */
+#ifdef BYTESCANNER_X86
+__attribute__((target("avx2")))
+#endif
+const char* ByteScanner::findAVX2(const char* begin, const char* end) const
+{
+#ifdef BYTESCANNER_X86
+  // broadcast slots
+  __m256i set[MAXBYTES];
+
+  for(unsigned i = 0; i < MAXBYTES; i++)
+  {
+    set[i] = _mm256_set1_epi8(m_bytes[i]);
+  }
+
+  // x <= max  <=>  min(x, max) == x
+  const bool    below = (m_below > 0);
+  const __m256i max   = _mm256_set1_epi8(static_cast<char>(below ? m_below - 1 : 0));
+
+  while (end - begin >= 32)
+  {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+
+    __m256i hit = below ? _mm256_cmpeq_epi8(_mm256_min_epu8(x, max), x) : _mm256_setzero_si256();
+
+    for(unsigned i = 0; i < MAXBYTES; i++)
+    {
+      hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(x, set[i]));
+    }
+
+    const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+
+    if (mask != 0) return begin + __builtin_ctz(mask);
+
+    begin += 32;
+  }
+#endif
+
+  // remaining bytes
+  return findSSE2(begin, end);
+}
+
+// ----------
+// skipScalar
+// ----------
+/*
+ *
+ */
+const char* ByteScanner::skipScalar(const char* begin, const char* end, size_t& count) const
+{
+  while (begin != end)
+  {
+    if (contains(*begin++) && (--count == 0)) return begin;
+  }
+
+  return end;
+}
+
+// --------
+// skipSSE2
+// --------
+/*
+ * Each block is compared like in findSSE2(), but with the used slots
+ * only (skipping runs long enough to pay for the loop), and its members
+ * are counted at once.  Only the block holding the count-th member is
+ * looked at bit by bit.
+ */
+const char* ByteScanner::skipSSE2(const char* begin, const char* end, size_t& count) const
+{
+#ifdef BYTESCANNER_X86
+  // broadcast slots
+  __m128i set[MAXBYTES];
+
+  for(unsigned i = 0; i < MAXBYTES; i++)
+  {
+    set[i] = _mm_set1_epi8(m_bytes[i]);
+  }
+
+  // x <= max  <=>  min(x, max) == x
+  const bool    below = (m_below > 0);
+  const __m128i max   = _mm_set1_epi8(static_cast<char>(below ? m_below - 1 : 0));
+
+  while (end - begin >= 16)
+  {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+
+    __m128i hit = below ? _mm_cmpeq_epi8(_mm_min_epu8(x, max), x) : _mm_setzero_si128();
+
+    for(unsigned i = 0; i < m_count; i++)
+    {
+      hit = _mm_or_si128(hit, _mm_cmpeq_epi8(x, set[i]));
+    }
+
+    unsigned mask  = static_cast<unsigned>(_mm_movemask_epi8(hit));
+    size_t   found = __builtin_popcount(mask);
+
+    if (found >= count)
+    {
+      // drop the members in front of the count-th one
+      for(; count > 1; count--) mask &= mask - 1;
+
+      count = 0;
+
+      return begin + __builtin_ctz(mask) + 1;
+    }
+
+    count -= found;
+
+    begin += 16;
+  }
+#endif
+
+  // remaining bytes
+  return skipScalar(begin, end, count);
+}
+
+// --------
+// skipAVX2
+// --------
+/*
+ *
+ */
+#ifdef BYTESCANNER_X86
+__attribute__((target("avx2,popcnt")))
+#endif
+const char* ByteScanner::skipAVX2(const char* begin, const char* end, size_t& count) const
+{
+#ifdef BYTESCANNER_X86
+  // broadcast slots
+  __m256i set[MAXBYTES];
+
+  for(unsigned i = 0; i < MAXBYTES; i++)
+  {
+    set[i] = _mm256_set1_epi8(m_bytes[i]);
+  }
+
+  // x <= max  <=>  min(x, max) == x
+  const bool    below = (m_below > 0);
+  const __m256i max   = _mm256_set1_epi8(static_cast<char>(below ? m_below - 1 : 0));
+
+  while (end - begin >= 32)
+  {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+
+    __m256i hit = below ? _mm256_cmpeq_epi8(_mm256_min_epu8(x, max), x) : _mm256_setzero_si256();
+
+    for(unsigned i = 0; i < m_count; i++)
+    {
+      hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(x, set[i]));
+    }
+
+    unsigned mask  = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+    size_t   found = __builtin_popcount(mask);
+
+    if (found >= count)
+    {
+      // drop the members in front of the count-th one
+      for(; count > 1; count--) mask &= mask - 1;
+
+      count = 0;
+
+      return begin + __builtin_ctz(mask) + 1;
+    }
+
+    count -= found;
+
+    begin += 32;
+  }
+#endif
+
+  // remaining bytes
+  return skipSSE2(begin, end, count);
+}
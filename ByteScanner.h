@@ -0,0 +1,234 @@
+// -----------------------------------------------------------------------------
+// ByteScanner.h                                                   ByteScanner.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref ByteScanner class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef BYTESCANNER_H_INCLUDE_NO1
+#define BYTESCANNER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+
+
+// -----------
+// ByteScanner
+// -----------
+/**
+ * @brief  This class finds the first occurrence of any byte of a small set.
+ *
+ * A set consists of up to @ref MAXBYTES single bytes plus (optionally)
+ * all bytes below a given limit.  The search uses AVX2 or SSE2 when the
+ * processor supports it and falls back to a table lookup otherwise.
+ * The implementation is selected once at program start.
+ */
+class ByteScanner
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Settings                                                           Settings
+  // ---------------------------------------------------------------------------
+
+  /// the maximum number of single bytes in a set
+  static const unsigned MAXBYTES = 16;
+
+  /// the available implementations
+  enum Level
+  {
+    SCALAR,  ///< table lookup
+    SSE2,    ///< 16 bytes per step
+    AVX2     ///< 32 bytes per step
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // ByteScanner
+  // -----------
+  /**
+   * @brief  The standard-constructor creates an empty set.
+   */
+  ByteScanner();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // clear
+  // -----
+  /**
+   * @brief  This method removes all bytes from the set.
+   */
+  void clear();
+
+  // ---
+  // add
+  // ---
+  /**
+   * @brief  This method adds a single byte to the set.
+   *
+   * @return  false if the set is already full
+   */
+  bool add(char c);
+
+  // --------
+  // addBelow
+  // --------
+  /**
+   * @brief  This method adds all bytes below the given limit (at most 128).
+   */
+  void addBelow(unsigned char limit);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // find
+  // ----
+  /**
+   * @brief  This method returns the first byte in [begin, end) that is
+   *         part of the set (or end if there is none).
+   */
+  const char* find(const char* begin, const char* end) const;
+
+  // ----
+  // skip
+  // ----
+  /**
+   * @brief  This method returns the position behind the count-th byte in
+   *         [begin, end) that is part of the set.
+   *
+   * @param count  holds the number of members to pass (decreased by the
+   *               members found, so it's 0 unless end is returned).
+   */
+  const char* skip(const char* begin, const char* end, std::size_t& count) const;
+
+  // --------
+  // contains
+  // --------
+  /**
+   * @brief  This method checks whether the given byte is part of the set.
+   */
+  bool contains(char c) const
+  {
+    return m_member[static_cast<unsigned char>(c)];
+  }
+
+  // --------
+  // setLevel
+  // --------
+  /**
+   * @brief  This method selects the implementation used by all scanners.
+   *
+   * Levels that are not supported by the processor are lowered.
+   */
+  static void setLevel(Level level);
+
+  // --------
+  // getLevel
+  // --------
+  /**
+   * @brief  This method returns the implementation used by all scanners.
+   */
+  static Level getLevel();
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ----------
+  // findScalar
+  // ----------
+  /**
+   * @brief  This method searches the set with the lookup table.
+   */
+  const char* findScalar(const char* begin, const char* end) const;
+
+  // --------
+  // findSSE2
+  // --------
+  /**
+   * @brief  This method searches the set 16 bytes at a time.
+   */
+  const char* findSSE2(const char* begin, const char* end) const;
+
+  // --------
+  // findAVX2
+  // --------
+  /**
+   * @brief  This method searches the set 32 bytes at a time.
+   */
+  const char* findAVX2(const char* begin, const char* end) const;
+
+  // ----------
+  // skipScalar
+  // ----------
+  /**
+   * @brief  This method passes members with the lookup table.
+   */
+  const char* skipScalar(const char* begin, const char* end, std::size_t& count) const;
+
+  // --------
+  // skipSSE2
+  // --------
+  /**
+   * @brief  This method passes members 16 bytes at a time.
+   */
+  const char* skipSSE2(const char* begin, const char* end, std::size_t& count) const;
+
+  // --------
+  // skipAVX2
+  // --------
+  /**
+   * @brief  This method passes members 32 bytes at a time.
+   */
+  const char* skipAVX2(const char* begin, const char* end, std::size_t& count) const;
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the single bytes (unused slots repeat the first byte)
+  char m_bytes[MAXBYTES];
+
+  /// the number of single bytes
+  unsigned m_count;
+
+  /// all bytes below this limit are part of the set
+  unsigned char m_below;
+
+  /// the lookup table
+  bool m_member[256];
+
+  /// the selected implementation
+  static Level s_level;
+
+};
+
+#endif  /* #ifndef BYTESCANNER_H_INCLUDE_NO1 */
@@ -0,0 +1,434 @@
+// -----------------------------------------------------------------------------
+// IncrementalRenderer.cpp                               IncrementalRenderer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref IncrementalRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstdio>      /* rename() */
+#include <fcntl.h>     /* open() */
+#include <unistd.h>    /* close(), unlink() */
+#include <sys/stat.h>  /* stat() */
+#include <fstream>
+#include <sstream>
+#include "message.h"
+#include "InputReader.h"
+#include "OutputBuffer.h"
+#include "OutputSink.h"
+#include "RenderCache.h"
+#include "IncrementalRenderer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the first line of each state file
+static const char* const MAGIC = "parcolor-state 1";
+
+/// the maximum number of lines in a block
+static const unsigned MAXLINES = 1024;
+
+/// a block ends behind a line whose hash has none of these bits set
+static const uint64_t CUTMASK = 63;
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -------------------
+// IncrementalRenderer
+// -------------------
+/*
+ *
+ */
+IncrementalRenderer::IncrementalRenderer(const string& output)
+{
+  m_output   = output;
+  m_state    = output + ".state";
+  m_verify   = false;
+  m_reused   = 0;
+  m_rendered = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ------------
+// enableVerify
+// ------------
+/*
+ *
+ */
+void IncrementalRenderer::enableVerify(bool flag)
+{
+  m_verify = flag;
+}
+
+// ------
+// render
+// ------
+/*
+ * The position within the paragraph is tracked by the same rules that
+ * LaTeXGenerator::parseLines() applies, so the state at the beginning of
+ * each block is known without rendering the blocks in front of it.
+ */
+bool IncrementalRenderer::render(const LaTeXGenerator& settings, const char* data, size_t size)
+{
+  // parseLines() changes the generator
+  LaTeXGenerator generator(settings);
+
+  generator.m_problems.clear();
+
+  m_problems.clear();
+
+  string signature = generator.signature();
+
+  if ( !loadState(signature) )
+  {
+    m_previous.clear();
+    m_blocks.clear();
+  }
+
+  string       code;
+  OutputBuffer out(code);
+
+  generator.openOutput(out);
+
+  out.flush();
+
+  // the blocks of the new output
+  vector<uint64_t> hashes;
+  vector<Range>    ranges;
+
+  // lines per paragraph and initial paragraph behind the recent line
+  unsigned lpp     = 0;
+  bool     initial = true;
+
+  // the recent block
+  const char* begin     = data;
+  unsigned    firstLpp  = 0;
+  bool        firstInit = true;
+  size_t      firstLine = 0;
+  unsigned    lines     = 0;
+  uint64_t    hash      = RenderCache::BASIS;
+  bool        cut       = false;
+
+  InputReader scanner;
+  scanner.open(data, size);
+
+  while (true)
+  {
+    const char* position = scanner.position();
+
+    const char* line;
+    size_t      length;
+
+    bool more = scanner.readLine(line, length);
+
+    unsigned nextLpp     = lpp;
+    bool     nextInitial = initial;
+
+    if (more)
+    {
+      // check lines within initial paragraph
+      if (nextInitial && (generator.m_maxFirst > 0) && (nextLpp == generator.m_maxFirst))
+      {
+        nextLpp     = 0;
+        nextInitial = false;
+      }
+
+      // check lines within each paragraph
+      if ((generator.m_maxEach > 0) && (nextLpp == generator.m_maxEach))
+      {
+        nextLpp     = 0;
+        nextInitial = false;
+      }
+
+      nextLpp += 1;
+    }
+
+    // finish recent block
+    if ((lines > 0) && (!more || cut || (nextLpp == 1)))
+    {
+      Range range;
+
+      range.offset = code.size();
+
+      map<uint64_t, Range>::const_iterator found = m_blocks.find(hash);
+
+      // copy previous code
+      if (found != m_blocks.end())
+      {
+        code.append(m_previous, found->second.offset, found->second.length);
+
+        m_reused += 1;
+      }
+
+      // render block
+      else
+      {
+        InputReader reader;
+        reader.open(begin, position - begin);
+
+        // lines in front of the block
+        generator.m_line = firstLine;
+
+        bool success = generator.parseLines(reader, firstLpp, firstInit, out);
+
+        m_problems = generator.m_problems;
+
+        if ( !success )
+        {
+          // notify user
+          msg::err( msg::catq("invalid markup, output not replaced: ", m_output) );
+
+          // signalize trouble
+          return false;
+        }
+
+        out.flush();
+
+        m_rendered += 1;
+      }
+
+      range.length = code.size() - range.offset;
+
+      hashes.push_back(hash);
+      ranges.push_back(range);
+
+      // start next block
+      begin      = position;
+      firstLpp   = lpp;
+      firstInit  = initial;
+      firstLine += lines;
+      lines      = 0;
+      hash       = RenderCache::BASIS;
+    }
+
+    if ( !more ) break;
+
+    // the code of a block depends on how its first line is joined
+    // (nothing in front of it, a paragraph break or a line break)
+    if (lines == 0)
+    {
+      unsigned start = (firstLpp == 0) ? 0 : ((nextLpp == 1) ? 1 : 2);
+
+      hash = RenderCache::hash(reinterpret_cast<const char*>(&start), sizeof(start), hash);
+    }
+
+    uint64_t lineHash = RenderCache::hash(line, length);
+
+    hash = RenderCache::hash(reinterpret_cast<const char*>(&lineHash), sizeof(lineHash), hash);
+
+    lpp     = nextLpp;
+    initial = nextInitial;
+    lines  += 1;
+
+    cut = (lines >= MAXLINES) || ((lineHash & CUTMASK) == 0);
+  }
+
+  generator.closeOutput(lpp, out);
+
+  out.flush();
+
+  // compare with a full render
+  if (m_verify)
+  {
+    string full;
+
+    generator.render(data, size, full);
+
+    if (full != code)
+    {
+      // notify user
+      msg::err( msg::catq("incremental render differs from full render: ", m_output) );
+
+      // signalize trouble
+      return false;
+    }
+  }
+
+  double started = (generator.m_stats != 0) ? RenderStats::now() : 0;
+
+  // the state refers to the output, so it's written last
+  bool written = writeFile(m_output, code) && saveState(signature, hashes, ranges);
+
+  if (generator.m_stats != 0)
+  {
+    generator.m_stats->writeSeconds += RenderStats::now() - started;
+    generator.m_stats->bytesWritten += code.size();
+  }
+
+  if ( !written )
+  {
+    // notify user
+    msg::err( msg::catq("cannot write output file: ", m_output) );
+
+    // signalize trouble
+    return false;
+  }
+
+  // signalize success
+  return true;
+}
+
+// --------
+// problems
+// --------
+/*
+ *
+ */
+const vector<MarkupChecker::Problem>& IncrementalRenderer::problems() const
+{
+  return m_problems;
+}
+
+// ------
+// report
+// ------
+/*
+ *
+ */
+void IncrementalRenderer::report() const
+{
+  ostringstream line;
+
+  line << "incremental: " << m_reused << " of " << (m_reused + m_rendered) << " blocks reused";
+
+  // notify user
+  msg::nfo( line.str() );
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ---------
+// loadState
+// ---------
+/*
+ * The state file starts with the magic line, the generator's signature
+ * and the size and modification time of the output.  Each following line holds the
+ * hash, the offset and the length of a block.
+ */
+bool IncrementalRenderer::loadState(const string& signature)
+{
+  ifstream state( m_state.c_str() );
+
+  string line;
+
+  if (!getline(state, line) || (line != MAGIC)) return false;
+
+  if (!getline(state, line) || (line != signature)) return false;
+
+  // the output must not have changed in the meantime
+  off_t  size;
+  time_t seconds;
+  long   nanoseconds;
+
+  if ( !(state >> size >> seconds >> nanoseconds) ) return false;
+
+  struct stat info;
+
+  if (stat(m_output.c_str(), &info) != 0) return false;
+
+  if ((info.st_size != size) || (info.st_mtim.tv_sec != seconds) || (info.st_mtim.tv_nsec != nanoseconds)) return false;
+
+  ifstream output(m_output.c_str(), ios::in | ios::binary);
+
+  m_previous.resize(size);
+
+  if ((size > 0) && !output.read(&m_previous[0], size)) return false;
+
+  m_blocks.clear();
+
+  uint64_t key;
+  Range    range;
+
+  while (state >> hex >> key >> dec >> range.offset >> range.length)
+  {
+    if ((range.offset > m_previous.size()) || (range.length > m_previous.size() - range.offset)) return false;
+
+    m_blocks[key] = range;
+  }
+
+  // signalize success
+  return state.eof();
+}
+
+// ---------
+// saveState
+// ---------
+/*
+ *
+ */
+bool IncrementalRenderer::saveState(const string& signature, const vector<uint64_t>& hashes,
+                                    const vector<Range>& ranges) const
+{
+  struct stat info;
+
+  if (stat(m_output.c_str(), &info) != 0) return false;
+
+  ostringstream state;
+
+  state << MAGIC << "\n" << signature << "\n";
+
+  state << info.st_size << " " << info.st_mtim.tv_sec << " " << info.st_mtim.tv_nsec << "\n";
+
+  for(vector<uint64_t>::size_type i = 0; i < hashes.size(); i++)
+  {
+    state << hex << hashes[i] << dec << " " << ranges[i].offset << " " << ranges[i].length << "\n";
+  }
+
+  return writeFile(m_state, state.str());
+}
+
+// ---------
+// writeFile
+// ---------
+/*
+ * Readers see either the old or the new content, never a mixture.
+ */
+bool IncrementalRenderer::writeFile(const string& path, const string& data)
+{
+  string temp = path + ".tmp";
+
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+  if (fd < 0) return false;
+
+  FdSink sink(fd);
+
+  bool written = sink.write(data.data(), data.size());
+
+  if (close(fd) != 0) written = false;
+
+  if (!written || (rename(temp.c_str(), path.c_str()) != 0))
+  {
+    unlink( temp.c_str() );
+
+    // signalize trouble
+    return false;
+  }
+
+  // signalize success
+  return true;
+}
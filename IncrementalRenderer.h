@@ -0,0 +1,198 @@
+// -----------------------------------------------------------------------------
+// IncrementalRenderer.h                                   IncrementalRenderer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref IncrementalRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef INCREMENTALRENDERER_H_INCLUDE_NO1
+#define INCREMENTALRENDERER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <stdint.h>  /* uint64_t */
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "LaTeXGenerator.h"
+
+
+// -------------------
+// IncrementalRenderer
+// -------------------
+/**
+ * @brief  This class renders into a file and reuses the unchanged
+ *         parts of its previous content.
+ *
+ * The input is cut into blocks of lines.  Each paragraph starts a new
+ * block, and long paragraphs are cut behind lines whose hash ends with
+ * six zero bits, so an inserted line doesn't shift all following cuts.
+ * Blocks never hold a paragraph break behind their first line, so the
+ * code of a block only depends on its lines and on how its first line
+ * is joined to the previous one.
+ *
+ * A state file next to the output lists the hash of each block and the
+ * range of the output it produced.  The next run copies the code of all
+ * blocks found there and only renders the others.  The state is ignored
+ * if the settings or the output file have changed in the meantime.
+ */
+class IncrementalRenderer
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -------------------
+  // IncrementalRenderer
+  // -------------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param output  holds the output file (the state file is output + ".state").
+   */
+  explicit IncrementalRenderer(const std::string& output);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ------------
+  // enableVerify
+  // ------------
+  /**
+   * @brief  This method enables or disables the comparison with a full render.
+   */
+  void enableVerify(bool flag);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method replaces the output file and the state file.
+   *
+   * @param generator  holds the settings.
+   * @param data       points to the input.
+   * @param size       holds the size of the input.
+   *
+   * @return  false if the input could not be rendered, the result differs
+   *          from a full render (see enableVerify()) or a file couldn't be
+   *          written
+   */
+  bool render(const LaTeXGenerator& generator, const char* data, std::size_t size);
+
+  // --------
+  // problems
+  // --------
+  /**
+   * @brief  This method returns the lines rejected while rendering the
+   *         changed blocks (see LaTeXGenerator::problems()).
+   */
+  const std::vector<MarkupChecker::Problem>& problems() const;
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method prints the number of reused blocks via stderr.
+   */
+  void report() const;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // Range
+  // -----
+  /**
+   * @brief  The code of a block within the output.
+   */
+  struct Range
+  {
+    std::size_t offset;  ///< the first byte
+    std::size_t length;  ///< the number of bytes
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ---------
+  // loadState
+  // ---------
+  /**
+   * @brief  This method reads the previous output and its blocks.
+   *
+   * @return  false if there is no usable state
+   */
+  bool loadState(const std::string& signature);
+
+  // ---------
+  // saveState
+  // ---------
+  /**
+   * @brief  This method writes the blocks of the output file.
+   */
+  bool saveState(const std::string& signature, const std::vector<uint64_t>& hashes,
+                 const std::vector<Range>& ranges) const;
+
+  // ---------
+  // writeFile
+  // ---------
+  /**
+   * @brief  This method replaces a file by means of a temporary file.
+   */
+  static bool writeFile(const std::string& path, const std::string& data);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the output file
+  std::string m_output;
+
+  /// the state file
+  std::string m_state;
+
+  /// compare the result with a full render
+  bool m_verify;
+
+  /// the content of the previous output
+  std::string m_previous;
+
+  /// the code of the previous blocks (by hash)
+  std::map<uint64_t, Range> m_blocks;
+
+  /// the number of blocks copied
+  unsigned m_reused;
+
+  /// the number of blocks rendered
+  unsigned m_rendered;
+
+  /// the lines rejected by the recent render
+  std::vector<MarkupChecker::Problem> m_problems;
+
+};
+
+#endif  /* #ifndef INCREMENTALRENDERER_H_INCLUDE_NO1 */
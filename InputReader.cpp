@@ -0,0 +1,671 @@
+// -----------------------------------------------------------------------------
+// InputReader.cpp                                               InputReader.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref InputReader class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>    /* read() */
+#include <sys/mman.h>  /* mmap() */
+#include <sys/stat.h>  /* fstat() */
+#include "ByteScanner.h"
+#include "RenderStats.h"
+#include "InputReader.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the number of bytes requested by each read(2)
+static const size_t BLOCKSIZE = 256 * 1024;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -----------
+// terminators
+// -----------
+/**
+ * @brief  This function returns a scanner that finds CR and LF.
+ */
+static ByteScanner terminators()
+{
+  ByteScanner scanner;
+
+  scanner.add('\r');
+  scanner.add('\n');
+
+  return scanner;
+}
+
+
+// -----------------------------------------------------------------------------
+// Static members                                                 Static members
+// -----------------------------------------------------------------------------
+
+/// finds CR and LF (set up before any thread starts)
+static const ByteScanner s_terminators = terminators();
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -----------
+// InputReader
+// -----------
+/*
+ *
+ */
+InputReader::InputReader()
+{
+  m_fd      = -1;
+  m_stream  = 0;
+  m_map     = 0;
+  m_mapSize = 0;
+  m_pos     = 0;
+  m_end     = 0;
+  m_cr      = 0;
+  m_lf      = 0;
+  m_eof     = true;
+  m_partial = false;
+  m_stats   = 0;
+}
+
+// ------------
+// ~InputReader
+// ------------
+/*
+ *
+ */
+InputReader::~InputReader()
+{
+  close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void InputReader::open(int fd)
+{
+  // drop recent state
+  close();
+
+  m_fd  = fd;
+  m_eof = false;
+
+  // try to map regular files
+  struct stat info;
+
+  if ((fstat(fd, &info) == 0) && S_ISREG(info.st_mode) && (info.st_size > 0))
+  {
+    // the mapping starts at the current file offset
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+
+    if ((offset == 0) && (static_cast<off_t>(static_cast<size_t>(info.st_size)) == info.st_size))
+    {
+      double started = (m_stats != 0) ? RenderStats::now() : 0;
+
+      void* addr = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (addr != MAP_FAILED)
+      {
+        // the kernel should read ahead aggressively
+        madvise(addr, info.st_size, MADV_SEQUENTIAL);
+
+        m_map     = static_cast<char*>(addr);
+        m_mapSize = info.st_size;
+        m_pos     = m_map;
+        m_end     = m_map + m_mapSize;
+        m_eof     = true;
+
+        // page faults are counted as parsing
+        if (m_stats != 0)
+        {
+          m_stats->readSeconds += RenderStats::now() - started;
+          m_stats->bytesRead   += m_mapSize;
+        }
+      }
+    }
+  }
+}
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void InputReader::open(const char* data, size_t size)
+{
+  // drop recent state
+  close();
+
+  m_pos = data;
+  m_end = data + size;
+}
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void InputReader::open(istream& stream)
+{
+  // drop recent state
+  close();
+
+  m_stream = &stream;
+  m_eof    = false;
+}
+
+// --------
+// setStats
+// --------
+/*
+ *
+ */
+void InputReader::setStats(RenderStats* stats)
+{
+  m_stats = stats;
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void InputReader::close()
+{
+  // release mapping
+  if (m_map != 0)
+  {
+    munmap(m_map, m_mapSize);
+  }
+
+  m_fd      = -1;
+  m_stream  = 0;
+  m_map     = 0;
+  m_mapSize = 0;
+  m_pos     = 0;
+  m_end     = 0;
+  m_cr      = 0;
+  m_lf      = 0;
+  m_eof     = true;
+  m_partial = false;
+
+  m_carry.clear();
+  m_held.clear();
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// --------
+// readLine
+// --------
+/*
+ *
+ */
+bool InputReader::readLine(const char*& line, size_t& size)
+{
+  // reset buffer
+  m_carry.clear();
+
+  // initialize return value
+  bool extracted = false;
+
+  while (true)
+  {
+    // look for CR or LF
+    const char* term = findTerm();
+
+    // line finished within current window
+    if (term != m_end)
+    {
+      if ( m_carry.empty() )
+      {
+        // hand out a view into the window
+        line = m_pos;
+        size = term - m_pos;
+      }
+
+      else
+      {
+        // complete carried line
+        m_carry.append(m_pos, term);
+
+        line = m_carry.data();
+        size = m_carry.size();
+      }
+
+      // skip terminator
+      m_pos = term + 1;
+
+      extracted = true;
+
+      break;
+    }
+
+    // line continues in the next block
+    if (m_pos != m_end)
+    {
+      m_carry.append(m_pos, m_end);
+
+      m_pos = m_end;
+
+      extracted = true;
+    }
+
+    // no more data
+    if ( !refill() )
+    {
+      line = m_carry.data();
+      size = m_carry.size();
+
+      break;
+    }
+  }
+
+  // drop trailing whitespace
+  while ((size > 0) && ((line[size - 1] == ' ') || (line[size - 1] == '\t')))
+  {
+    size -= 1;
+  }
+
+  // signalize whether some data has been extracted or not
+  return extracted;
+}
+
+// --------
+// readPart
+// --------
+/*
+ * Trailing spaces and tabs of an unfinished part are held back, because
+ * they are dropped if nothing else follows them on the line.  So a part
+ * never ends with a space or a tab unless it finishes the line.
+ */
+bool InputReader::readPart(const char*& part, size_t& size, bool& complete)
+{
+  while (true)
+  {
+    // look for CR or LF
+    const char* term = findTerm();
+
+    // limit the part (a mapped file is a single window)
+    const char* stop = (static_cast<size_t>(term - m_pos) > BLOCKSIZE) ? m_pos + BLOCKSIZE : term;
+
+    // line finished within this part
+    if ((stop == term) && (term != m_end))
+    {
+      if ( m_held.empty() )
+      {
+        // hand out a view into the window
+        part = m_pos;
+        size = term - m_pos;
+      }
+
+      else
+      {
+        // the held characters come first
+        m_carry.assign(m_held);
+        m_carry.append(m_pos, term);
+
+        m_held.clear();
+
+        part = m_carry.data();
+        size = m_carry.size();
+      }
+
+      // skip terminator
+      m_pos = term + 1;
+
+      m_partial = false;
+
+      complete = true;
+
+      break;
+    }
+
+    // hold back trailing spaces and tabs
+    const char* cut = stop;
+
+    while ((cut != m_pos) && ((cut[-1] == ' ') || (cut[-1] == '\t'))) --cut;
+
+    // line continues in the next part
+    if (cut != m_pos)
+    {
+      if ( m_held.empty() )
+      {
+        part = m_pos;
+        size = cut - m_pos;
+      }
+
+      else
+      {
+        m_carry.assign(m_held);
+        m_carry.append(m_pos, cut);
+
+        part = m_carry.data();
+        size = m_carry.size();
+      }
+
+      m_held.assign(cut, stop);
+
+      m_pos = stop;
+
+      m_partial = true;
+
+      complete = false;
+
+      // signalize success
+      return true;
+    }
+
+    // nothing but spaces and tabs so far
+    if (stop != m_pos)
+    {
+      m_held.append(m_pos, stop);
+
+      m_pos = stop;
+
+      m_partial = true;
+    }
+
+    // window not exhausted
+    if (m_pos != m_end) continue;
+
+    // no more data
+    if ( !refill() )
+    {
+      // nothing left of the recent line
+      if ( !m_partial ) return false;
+
+      m_held.clear();
+
+      part = m_held.data();
+      size = 0;
+
+      m_partial = false;
+
+      complete = true;
+
+      break;
+    }
+  }
+
+  // drop trailing whitespace
+  while ((size > 0) && ((part[size - 1] == ' ') || (part[size - 1] == '\t')))
+  {
+    size -= 1;
+  }
+
+  // signalize success
+  return true;
+}
+
+// ---------
+// readBlock
+// ---------
+/*
+ *
+ */
+bool InputReader::readBlock(const char*& data, size_t& size)
+{
+  // window exhausted
+  if ((m_pos == m_end) && !refill())
+  {
+    // no more data
+    return false;
+  }
+
+  // hand out the rest of the window
+  data = m_pos;
+  size = m_end - m_pos;
+
+  m_pos = m_end;
+
+  // signalize success
+  return true;
+}
+
+// ---------
+// skipLines
+// ---------
+/*
+ * The terminators are counted in vectors (see ByteScanner::skip()), so
+ * short lines cost hardly more than long ones.  Just like readLine(), a
+ * last line without terminator counts as well.
+ */
+size_t InputReader::skipLines(size_t count)
+{
+  const ByteScanner& scanner = s_terminators;
+
+  size_t skipped = 0;
+
+  // some characters of the current line have been skipped
+  bool started = false;
+
+  while (skipped < count)
+  {
+    size_t left = count - skipped;
+
+    const char* pos = scanner.skip(m_pos, m_end, left);
+
+    skipped = count - left;
+
+    // last line finished within current window
+    if (left == 0)
+    {
+      m_pos = pos;
+
+      break;
+    }
+
+    // line continues in the next block
+    if (m_pos != m_end)
+    {
+      started = !scanner.contains(m_end[-1]);
+
+      m_pos = m_end;
+    }
+
+    // no more data
+    if ( !refill() )
+    {
+      if (started) skipped += 1;
+
+      break;
+    }
+  }
+
+  return skipped;
+}
+
+// ---------
+// copyLines
+// ---------
+/*
+ *
+ */
+size_t InputReader::copyLines(size_t count, string& text)
+{
+  const char* line;
+  size_t      size;
+
+  size_t copied = 0;
+
+  while ((copied < count) && readLine(line, size))
+  {
+    text.append(line, size);
+    text += '\n';
+
+    copied += 1;
+  }
+
+  return copied;
+}
+
+// --------
+// contents
+// --------
+/*
+ *
+ */
+void InputReader::contents(const char*& data, size_t& size)
+{
+  // read the rest of the file descriptor
+  if ( !m_eof )
+  {
+    // keep unread characters of the current window
+    vector<char> all(m_pos, m_end);
+
+    m_pos = m_end;
+
+    while ( refill() )
+    {
+      all.insert(all.end(), m_pos, m_end);
+
+      m_pos = m_end;
+    }
+
+    m_block.swap(all);
+
+    m_pos = m_block.empty() ? 0 : &m_block[0];
+    m_end = m_pos + m_block.size();
+    m_cr  = 0;
+    m_lf  = 0;
+  }
+
+  data = m_pos;
+  size = m_end - m_pos;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ------
+// refill
+// ------
+/*
+ *
+ */
+bool InputReader::refill()
+{
+  if (m_eof) return false;
+
+  // allocate buffer once
+  if ( m_block.empty() )
+  {
+    m_block.resize(BLOCKSIZE);
+  }
+
+  ssize_t got;
+
+  double started = (m_stats != 0) ? RenderStats::now() : 0;
+
+  if (m_stream != 0)
+  {
+    m_stream->read(&m_block[0], m_block.size());
+
+    got = m_stream->gcount();
+  }
+
+  else
+  {
+    // retry interrupted reads
+    do
+    {
+      got = read(m_fd, &m_block[0], m_block.size());
+    }
+    while ((got < 0) && (errno == EINTR));
+  }
+
+  if (m_stats != 0)
+  {
+    m_stats->readSeconds += RenderStats::now() - started;
+
+    if (got > 0) m_stats->bytesRead += got;
+  }
+
+  // end of file or error
+  if (got <= 0)
+  {
+    m_eof = true;
+
+    return false;
+  }
+
+  // set new window
+  m_pos = &m_block[0];
+  m_end = m_pos + got;
+  m_cr  = 0;
+  m_lf  = 0;
+
+  // signalize success
+  return true;
+}
+
+// --------
+// findTerm
+// --------
+/*
+ * The positions of the next CR and the next LF are remembered
+ * separately, so a file that only uses one kind of terminator
+ * is scanned just once for the other kind.
+ */
+const char* InputReader::findTerm()
+{
+  // empty window
+  if (m_pos == m_end) return m_end;
+
+  // update position of next CR
+  if ((m_cr == 0) || (m_cr < m_pos))
+  {
+    const void* cr = memchr(m_pos, '\r', m_end - m_pos);
+
+    m_cr = (cr == 0) ? m_end : static_cast<const char*>(cr);
+  }
+
+  // update position of next LF
+  if ((m_lf == 0) || (m_lf < m_pos))
+  {
+    const void* lf = memchr(m_pos, '\n', m_end - m_pos);
+
+    m_lf = (lf == 0) ? m_end : static_cast<const char*>(lf);
+  }
+
+  return (m_cr < m_lf) ? m_cr : m_lf;
+}
@@ -0,0 +1,310 @@
+// -----------------------------------------------------------------------------
+// InputReader.h                                                   InputReader.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref InputReader class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef INPUTREADER_H_INCLUDE_NO1
+#define INPUTREADER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+// Declarations                                                     Declarations
+// -----------------------------------------------------------------------------
+class RenderStats;
+
+
+// -----------
+// InputReader
+// -----------
+/**
+ * @brief  This class splits the data of a file descriptor into lines.
+ *
+ * Regular files are mapped into memory, other file descriptors (and input
+ * streams) are read in large blocks via read(2), and characters that are already in memory
+ * are used as they are.  Each extracted line is handed out as a view into
+ * the mapping (or the block buffer), so no characters are copied unless
+ * a line crosses the boundary between two blocks.
+ *
+ * Each CR and each LF finishes a line (a CRLF pair therefore yields an
+ * additional empty line) and trailing spaces and tabs are removed.
+ */
+class InputReader
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // InputReader
+  // -----------
+  /**
+   * @brief  The standard-constructor.
+   */
+  InputReader();
+
+  // ------------
+  // ~InputReader
+  // ------------
+  /**
+   * @brief  The destructor releases the mapping.
+   */
+  ~InputReader();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // open
+  // ----
+  /**
+   * @brief  This method attaches the reader to the given file descriptor.
+   *
+   * The file descriptor is not closed by the reader.
+   */
+  void open(int fd);
+
+  // ----
+  // open
+  // ----
+  /**
+   * @brief  This method attaches the reader to the given characters.
+   *
+   * The characters are not copied, they must outlive the reader.
+   */
+  void open(const char* data, std::size_t size);
+
+  // ----
+  // open
+  // ----
+  /**
+   * @brief  This method attaches the reader to the given input stream.
+   *
+   * The stream must outlive the reader.
+   */
+  void open(std::istream& stream);
+
+  // --------
+  // setStats
+  // --------
+  /**
+   * @brief  This method attaches counters (0 detaches them).
+   *
+   * Only data taken from a file descriptor or an input stream is counted,
+   * characters given via open(const char*, std::size_t) have already
+   * been read by someone else.
+   */
+  void setStats(RenderStats* stats);
+
+  // -----
+  // close
+  // -----
+  /**
+   * @brief  This method detaches the reader from its file descriptor.
+   */
+  void close();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // --------
+  // readLine
+  // --------
+  /**
+   * @brief  This method extracts the next line.
+   *
+   * @param line  receives the first character of the extracted line.
+   * @param size  receives the number of characters in the extracted line.
+   *
+   * @return  false if there is no more data
+   *
+   * The returned view stays valid until the next call.
+   */
+  bool readLine(const char*& line, std::size_t& size);
+
+  // --------
+  // readPart
+  // --------
+  /**
+   * @brief  This method extracts the next line or the next part of a
+   *         long line.
+   *
+   * Just like readLine(), but a line that is longer than a block or
+   * crosses the boundary between two blocks is handed out in several
+   * parts, so no more than a block (plus a run of spaces and tabs) is
+   * ever copied.  Don't mix both methods within a single line.
+   *
+   * @param part      receives the first character of the part.
+   * @param size      receives the number of characters in the part.
+   * @param complete  receives false if the line continues in the next part.
+   *
+   * @return  false if there is no more data
+   */
+  bool readPart(const char*& part, std::size_t& size, bool& complete);
+
+  // ---------
+  // readBlock
+  // ---------
+  /**
+   * @brief  This method hands out the characters that haven't been read
+   *         yet, up to the end of the current block (or mapping).
+   *
+   * The characters aren't split into lines, so CR and LF are included.
+   * Don't mix this method with readLine() or readPart() within a line.
+   *
+   * @param data  receives the first character.
+   * @param size  receives the number of characters (never 0).
+   *
+   * @return  false if there is no more data
+   */
+  bool readBlock(const char*& data, std::size_t& size);
+
+  // ---------
+  // skipLines
+  // ---------
+  /**
+   * @brief  This method skips the given number of lines.
+   *
+   * Only the terminators are searched for: skipped lines are neither
+   * trimmed nor copied, even if they cross block boundaries.
+   *
+   * @return  the number of lines actually skipped
+   */
+  std::size_t skipLines(std::size_t count);
+
+  // ---------
+  // copyLines
+  // ---------
+  /**
+   * @brief  This method appends the given number of lines to a string
+   *         (each trimmed like by readLine() and finished by an LF).
+   *
+   * @return  the number of lines actually copied
+   */
+  std::size_t copyLines(std::size_t count, std::string& text);
+
+  // --------
+  // contents
+  // --------
+  /**
+   * @brief  This method provides all remaining characters in one piece.
+   *
+   * Input that is neither mapped nor given as characters is read
+   * completely into an internal buffer first.
+   */
+  void contents(const char*& data, std::size_t& size);
+
+  // --------
+  // position
+  // --------
+  /**
+   * @brief  This method returns the first unread character.
+   *
+   * The result is only meaningful after contents() has been called or
+   * if the input is mapped or has been given as characters.
+   */
+  const char* position() const
+  {
+    return m_pos;
+  }
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ------
+  // refill
+  // ------
+  /**
+   * @brief  This method reads the next block from the file descriptor
+   *         (or the input stream).
+   */
+  bool refill();
+
+  // --------
+  // findTerm
+  // --------
+  /**
+   * @brief  This method returns the first CR or LF in the current window.
+   */
+  const char* findTerm();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the attached file descriptor
+  int m_fd;
+
+  /// the attached input stream (if any)
+  std::istream* m_stream;
+
+  /// the mapped file (if any)
+  char* m_map;
+
+  /// the size of the mapped file
+  std::size_t m_mapSize;
+
+  /// the block buffer
+  std::vector<char> m_block;
+
+  /// the first unread character
+  const char* m_pos;
+
+  /// behind the last unread character
+  const char* m_end;
+
+  /// the next CR within the current window (or m_end)
+  const char* m_cr;
+
+  /// the next LF within the current window (or m_end)
+  const char* m_lf;
+
+  /// the beginning of a line that crosses block boundaries
+  std::string m_carry;
+
+  /// the spaces and tabs held back by readPart()
+  std::string m_held;
+
+  /// readPart() has handed out a part of the recent line
+  bool m_partial;
+
+  /// no more data available from the file descriptor
+  bool m_eof;
+
+  /// the counters (if any)
+  RenderStats* m_stats;
+
+};
+
+#endif  /* #ifndef INPUTREADER_H_INCLUDE_NO1 */
@@ -0,0 +1,762 @@
+// -----------------------------------------------------------------------------
+// KeywordMatcher.cpp                                         KeywordMatcher.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref KeywordMatcher class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>  /* memcpy() */
+#include <fstream>
+#include <sstream>
+#include "message.h"
+#include "OutputSink.h"
+#include "RenderCache.h"
+#include "KeywordMatcher.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the first line of a compiled automaton (change whenever the layout changes)
+static const char FORMAT[] = "parcolor-keywords-1";
+
+/// the keyword must not follow a word character
+static const unsigned char BOUNDFIRST = 1;
+
+/// the keyword must not precede a word character
+static const unsigned char BOUNDLAST = 2;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ------
+// isWord
+// ------
+/**
+ * @brief  This function checks whether the given character is a letter,
+ *         a digit or an underscore.
+ */
+static inline bool isWord(char c)
+{
+  return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '_');
+}
+
+// ------
+// append
+// ------
+/**
+ * @brief  This function appends the bytes of all values.
+ */
+template<class T>
+static void append(string& data, const vector<T>& values)
+{
+  if ( !values.empty() ) data.append(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T));
+}
+
+// -------
+// extract
+// -------
+/**
+ * @brief  This function reads values appended by append().
+ *
+ * @return  false if there aren't enough bytes left
+ */
+template<class T>
+static bool extract(const string& data, size_t& pos, vector<T>& values, size_t count)
+{
+  if ((data.size() - pos) / sizeof(T) < count) return false;
+
+  values.resize(count);
+
+  if (count > 0) memcpy(&values[0], data.data() + pos, count * sizeof(T));
+
+  pos += count * sizeof(T);
+
+  // signalize success
+  return true;
+}
+
+// --------
+// addPlain
+// --------
+/**
+ * @brief  This function appends plain characters (merged with plain
+ *         characters right in front of them).
+ */
+static void addPlain(vector<SpanLexer::Span>& spans, const char* line, const char* first, const char* end)
+{
+  if (first == end) return;
+
+  size_t offset = first - line;
+
+  // extend recent plain span
+  if (!spans.empty() && (spans.back().kind == SpanLexer::PLAIN) &&
+      (spans.back().offset + spans.back().length == offset))
+  {
+    spans.back().length += end - first;
+
+    return;
+  }
+
+  SpanLexer::Span span;
+
+  span.offset = offset;
+  span.length = end - first;
+  span.kind   = SpanLexer::PLAIN;
+  span.color  = 0;
+
+  spans.push_back(span);
+}
+
+// -------
+// addAuto
+// -------
+/**
+ * @brief  This function appends colored characters.
+ */
+static void addAuto(vector<SpanLexer::Span>& spans, const char* line, const char* first, const char* end, const char* color)
+{
+  SpanLexer::Span span;
+
+  span.offset = first - line;
+  span.length = end - first;
+  span.kind   = SpanLexer::AUTO;
+  span.color  = color;
+
+  spans.push_back(span);
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// --------------
+// KeywordMatcher
+// --------------
+/*
+ *
+ */
+KeywordMatcher::KeywordMatcher()
+{
+  clear();
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                               Initialization
+// -----------------------------------------------------------------------------
+
+// ---
+// add
+// ---
+/*
+ *
+ */
+void KeywordMatcher::add(const string& keyword, const string& color)
+{
+  if ( !keyword.empty() ) m_pending[keyword] = color;
+}
+
+// -------
+// compile
+// -------
+/*
+ * The keywords are inserted in sorted order, so each new node is the
+ * last child of its parent, and a keyword shares its path with the
+ * previous one up to their common prefix.  The nodes are renumbered in
+ * breadth-first order afterwards, so the children of each node are
+ * adjacent and sorted by their labels, and each suffix link points to
+ * a node that has been finished before.
+ */
+void KeywordMatcher::compile()
+{
+  clear();
+
+  // the trie in order of insertion
+  vector<uint32_t>      parent(1, 0);
+  vector<uint32_t>      firstChild(1, 0);
+  vector<uint32_t>      lastChild(1, 0);
+  vector<uint32_t>      nextSibling(1, 0);
+  vector<uint32_t>      keyword(1, 0);
+  vector<unsigned char> label(1, 0);
+
+  // the nodes of the previous keyword
+  vector<uint32_t> path(1, 0);
+
+  string previous;
+  string listing;
+
+  map<string, uint32_t> colors;
+
+  for(map<string, string>::const_iterator it = m_pending.begin(); it != m_pending.end(); ++it)
+  {
+    const string& word = it->first;
+
+    // common prefix
+    size_t common = 0;
+
+    while ((common < previous.size()) && (common < word.size()) && (previous[common] == word[common])) ++common;
+
+    path.resize(common + 1);
+
+    for(size_t d = common; d < word.size(); d++)
+    {
+      uint32_t node = static_cast<uint32_t>(label.size());
+      uint32_t up   = path[d];
+
+      parent.push_back(up);
+      firstChild.push_back(0);
+      lastChild.push_back(0);
+      nextSibling.push_back(0);
+      keyword.push_back(0);
+      label.push_back(static_cast<unsigned char>(word[d]));
+
+      if (firstChild[up] == 0) firstChild[up] = node;
+      else                     nextSibling[lastChild[up]] = node;
+
+      lastChild[up] = node;
+
+      path.push_back(node);
+    }
+
+    // new color
+    map<string, uint32_t>::iterator color = colors.find(it->second);
+
+    if (color == colors.end())
+    {
+      color = colors.insert( make_pair(it->second, static_cast<uint32_t>(m_colors.size())) ).first;
+
+      m_colors.push_back(it->second);
+    }
+
+    keyword[path.back()] = static_cast<uint32_t>(m_length.size()) + 1;
+
+    m_length.push_back( static_cast<uint32_t>(word.size()) );
+    m_color.push_back(color->second);
+    m_bounds.push_back( (isWord(word[0]) ? BOUNDFIRST : 0) | (isWord(word[word.size() - 1]) ? BOUNDLAST : 0) );
+
+    listing += word + '\0' + it->second + '\0';
+
+    previous = word;
+  }
+
+  m_pending.clear();
+
+  // breadth-first order
+  vector<uint32_t> order(1, 0);
+  vector<uint32_t> renumbered(label.size(), 0);
+
+  size_t nodes = label.size();
+
+  m_first.assign(nodes, 0);
+  m_count.assign(nodes, 0);
+  m_label.assign(nodes, 0);
+  m_fail.assign(nodes, 0);
+  m_dict.assign(nodes, 0);
+  m_keyword.assign(nodes, 0);
+  m_depth.assign(nodes, 0);
+
+  for(size_t i = 0; i < order.size(); i++)
+  {
+    uint32_t old = order[i];
+
+    m_first[i]   = static_cast<uint32_t>(order.size());
+    m_label[i]   = label[old];
+    m_keyword[i] = keyword[old];
+
+    for(uint32_t c = firstChild[old]; c != 0; c = nextSibling[c])
+    {
+      renumbered[c] = static_cast<uint32_t>(order.size());
+
+      order.push_back(c);
+
+      m_count[i] += 1;
+    }
+  }
+
+  for(uint32_t c = 0; c < m_count[0]; c++)
+  {
+    m_root[m_label[m_first[0] + c]] = m_first[0] + c;
+  }
+
+  // suffix links (the root and its children link to the root)
+  for(size_t i = 1; i < nodes; i++)
+  {
+    uint32_t up = renumbered[parent[order[i]]];
+
+    uint32_t fail = 0;
+
+    if (up != 0)
+    {
+      uint32_t f = m_fail[up];
+
+      while (((fail = child(f, m_label[i])) == 0) && (f != 0)) f = m_fail[f];
+    }
+
+    m_fail[i] = fail;
+    m_dict[i] = (m_keyword[fail] != 0) ? fail : m_dict[fail];
+  }
+
+  // depths
+  for(size_t i = 0; i < nodes; i++)
+  {
+    for(uint32_t c = 0; c < m_count[i]; c++)
+    {
+      m_depth[m_first[i] + c] = m_depth[i] + 1;
+    }
+  }
+
+  m_digest = RenderCache::key(listing.data(), listing.size(), FORMAT);
+}
+
+// ----
+// load
+// ----
+/*
+ * The whole list is read first, because its hash names the compiled
+ * automaton in the cache.  The automaton is left out of the cache's
+ * counters, which describe rendered documents.
+ */
+bool KeywordMatcher::load(const string& path, RenderCache* cache)
+{
+  ifstream list( path.c_str() );
+
+  if ( !list )
+  {
+    // notify user
+    msg::err( msg::catq("cannot open keyword list: ", path) );
+
+    // signalize trouble
+    return false;
+  }
+
+  ostringstream content;
+  content << list.rdbuf();
+
+  string text = content.str();
+  string key  = RenderCache::key(text.data(), text.size(), FORMAT);
+  string head = RenderCache::header(text.size(), FORMAT);
+
+  // reuse compiled automaton
+  if (cache != 0)
+  {
+    ostringstream data;
+    StreamSink    sink(data);
+
+    if ((cache->fetch(key, head, sink, false) == RenderCache::FETCHED) && restore( data.str() )) return true;
+  }
+
+  istringstream lines(text);
+
+  string   line;
+  unsigned number = 0;
+
+  while ( getline(lines, line) )
+  {
+    number += 1;
+
+    stringstream fields(line);
+
+    string keyword;
+    string color;
+    string extra;
+
+    // skip empty lines
+    if ( !(fields >> keyword) ) continue;
+
+    // skip comments
+    if (keyword[0] == '#') continue;
+
+    // exactly two fields
+    if ( !(fields >> color) || (fields >> extra) )
+    {
+      // notify user
+      msg::err( msg::cat(msg::qcat(path, ":"), msg::cat(msg::str(number), ": expected keyword and color")) );
+
+      m_pending.clear();
+
+      // signalize trouble
+      return false;
+    }
+
+    add(keyword, color);
+  }
+
+  compile();
+
+  if (cache != 0) cache->store(key, head, save(), false);
+
+  // signalize success
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ----
+// save
+// ----
+/*
+ * The arrays are stored as they are in memory, so the data is only
+ * valid on machines of the same byte order.
+ */
+string KeywordMatcher::save() const
+{
+  string data;
+
+  data += FORMAT;
+  data += '\n';
+  data += m_digest;
+  data += '\n';
+
+  vector<uint32_t> counts(3);
+
+  counts[0] = static_cast<uint32_t>(m_colors.size());
+  counts[1] = static_cast<uint32_t>(m_length.size());
+  counts[2] = static_cast<uint32_t>(m_label.size());
+
+  append(data, counts);
+
+  for(size_t i = 0; i < m_colors.size(); i++)
+  {
+    data += m_colors[i];
+    data += '\0';
+  }
+
+  append(data, m_length);
+  append(data, m_color);
+  append(data, m_bounds);
+  append(data, m_first);
+  append(data, m_count);
+  append(data, m_label);
+  append(data, m_fail);
+  append(data, m_dict);
+  append(data, m_keyword);
+
+  return data;
+}
+
+// -------
+// restore
+// -------
+/*
+ * The data may come from a shared cache directory, so each index is
+ * checked before it's used.  The children of each node must directly
+ * follow the children of the node in front of it (just like build()
+ * numbers them), so each node has exactly one parent and the depths are
+ * right.  Suffix links must lead to shallower nodes, so scan() never
+ * reads outside of the line and always terminates.
+ */
+bool KeywordMatcher::restore(const string& data)
+{
+  clear();
+
+  size_t pos = data.find('\n');
+
+  if ((pos == string::npos) || (data.compare(0, pos, FORMAT) != 0)) return false;
+
+  size_t eol = data.find('\n', pos + 1);
+
+  if (eol == string::npos) return false;
+
+  string digest = data.substr(pos + 1, eol - pos - 1);
+
+  pos = eol + 1;
+
+  vector<uint32_t> counts;
+
+  if ( !extract(data, pos, counts, 3) ) return false;
+
+  for(uint32_t i = 0; i < counts[0]; i++)
+  {
+    size_t nul = data.find('\0', pos);
+
+    if (nul == string::npos)
+    {
+      clear();
+
+      return false;
+    }
+
+    m_colors.push_back( data.substr(pos, nul - pos) );
+
+    pos = nul + 1;
+  }
+
+  size_t keywords = counts[1];
+  size_t nodes    = counts[2];
+
+  bool valid = extract(data, pos, m_length,  keywords) &&
+               extract(data, pos, m_color,   keywords) &&
+               extract(data, pos, m_bounds,  keywords) &&
+               extract(data, pos, m_first,   nodes)    &&
+               extract(data, pos, m_count,   nodes)    &&
+               extract(data, pos, m_label,   nodes)    &&
+               extract(data, pos, m_fail,    nodes)    &&
+               extract(data, pos, m_dict,    nodes)    &&
+               extract(data, pos, m_keyword, nodes)    &&
+               (pos == data.size()) && (nodes > 0);
+
+  m_depth.assign(nodes, 0);
+
+  // the first child of the recent node in breadth-first order
+  size_t offset = 1;
+
+  for(size_t i = 0; valid && (i < nodes); i++)
+  {
+    valid = (m_first[i] == offset) && ((m_count[i] == 0) || ((m_first[i] > i) && (m_count[i] <= nodes - m_first[i])));
+
+    offset += m_count[i];
+
+    for(uint32_t c = 0; valid && (c < m_count[i]); c++)
+    {
+      m_depth[m_first[i] + c] = m_depth[i] + 1;
+    }
+  }
+
+  // each node apart from the root is a child
+  valid = valid && (offset == nodes);
+
+  for(size_t i = 1; valid && (i < nodes); i++)
+  {
+    valid = (m_fail[i] < nodes) && (m_depth[m_fail[i]] < m_depth[i]) &&
+            (m_dict[i] < nodes) && (m_depth[m_dict[i]] < m_depth[i]) && (m_keyword[i] <= keywords);
+
+    if (valid && (m_keyword[i] != 0)) valid = (m_length[m_keyword[i] - 1] == m_depth[i]);
+  }
+
+  for(size_t k = 0; valid && (k < keywords); k++)
+  {
+    valid = (m_color[k] < m_colors.size());
+  }
+
+  if (!valid || (m_keyword[0] != 0))
+  {
+    clear();
+
+    return false;
+  }
+
+  for(uint32_t c = 0; c < m_count[0]; c++)
+  {
+    m_root[m_label[m_first[0] + c]] = m_first[0] + c;
+  }
+
+  m_digest = digest;
+
+  // signalize success
+  return true;
+}
+
+// ---------
+// highlight
+// ---------
+/*
+ * Just like SyntaxHighlighter::highlight(), single triggers are scanned
+ * together with the plain characters around them.  Plain spans aren't
+ * joined across a gap, which is left by a dropped escape sequence.
+ */
+void KeywordMatcher::highlight(const char* line, const vector<SpanLexer::Span>& spans, vector<SpanLexer::Span>& result) const
+{
+  result.clear();
+
+  // within manual markup
+  bool colored = false;
+
+  size_t i = 0;
+
+  while (i < spans.size())
+  {
+    const SpanLexer::Span& span = spans[i];
+
+    bool plain = (span.kind == SpanLexer::PLAIN) || (span.kind == SpanLexer::STRAY);
+
+    // keep markup and colored code
+    if (colored || !plain)
+    {
+      if (span.kind == SpanLexer::NAME) colored = true;
+      if (span.kind == SpanLexer::END)  colored = false;
+
+      result.push_back(span);
+
+      i += 1;
+
+      continue;
+    }
+
+    // join plain characters and single triggers
+    const char* first = line + span.offset;
+    const char* end   = first + span.length;
+
+    for(i += 1; i < spans.size(); i++)
+    {
+      if ((spans[i].kind != SpanLexer::PLAIN) && (spans[i].kind != SpanLexer::STRAY)) break;
+
+      if (line + spans[i].offset != end) break;
+
+      end = line + spans[i].offset + spans[i].length;
+    }
+
+    scan(line, first, end, result);
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// -----
+// child
+// -----
+/*
+ *
+ */
+uint32_t KeywordMatcher::child(uint32_t node, unsigned char label) const
+{
+  if (node == 0) return m_root[label];
+
+  // binary search among the sorted children
+  uint32_t low  = m_first[node];
+  uint32_t high = low + m_count[node];
+
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+
+    if      (m_label[middle] < label) low  = middle + 1;
+    else if (m_label[middle] > label) high = middle;
+    else return middle;
+  }
+
+  return 0;
+}
+
+// ----
+// scan
+// ----
+/*
+ * A match is held back until no later match can start in front of it
+ * or at the same character, which is the case as soon as the recent
+ * node is shallower than the distance to the start of the match.  The
+ * scan restarts behind each accepted match, so matches that overlap it
+ * are forgotten.  Only the characters behind the match and in front of
+ * the recent one are scanned twice, which are never more than the
+ * longest keyword.
+ */
+void KeywordMatcher::scan(const char* line, const char* first, const char* end, vector<SpanLexer::Span>& result) const
+{
+  // behind the last accepted match
+  const char* done = first;
+
+  // the match held back (if start != 0)
+  const char* start = 0;
+  const char* stop  = 0;
+  uint32_t    color = 0;
+
+  uint32_t node = 0;
+
+  const char* p = first;
+
+  while ((p != end) || (start != 0))
+  {
+    if (p != end)
+    {
+      unsigned char c = static_cast<unsigned char>(*p++);
+
+      uint32_t next;
+
+      // follow suffix links
+      while (((next = child(node, c)) == 0) && (node != 0)) node = m_fail[node];
+
+      node = next;
+
+      // longest match ending here that fits the word boundaries
+      for(uint32_t hit = (m_keyword[node] != 0) ? node : m_dict[node]; hit != 0; hit = m_dict[hit])
+      {
+        uint32_t k = m_keyword[hit] - 1;
+
+        const char* s = p - m_length[k];
+
+        // never in front of the run
+        if (s < first) continue;
+
+        if ((m_bounds[k] & BOUNDFIRST) && (s != first) && isWord(s[-1])) continue;
+        if ((m_bounds[k] & BOUNDLAST)  && (p != end)   && isWord(*p))    continue;
+
+        // starts in front of the held match or at the same character
+        if ((start == 0) || (s <= start))
+        {
+          start = s;
+          stop  = p;
+          color = m_color[k];
+        }
+
+        break;
+      }
+
+    }
+
+    // the held match is final at the end of the run
+    if ((start == 0) || ((p != end) && (p - m_depth[node] <= start))) continue;
+
+    addPlain(result, line, done, start);
+    addAuto(result, line, start, stop, m_colors[color].c_str());
+
+    // restart behind the match
+    done  = stop;
+    p     = stop;
+    node  = 0;
+    start = 0;
+  }
+
+  addPlain(result, line, done, end);
+}
+
+// -----
+// clear
+// -----
+/*
+ *
+ */
+void KeywordMatcher::clear()
+{
+  m_digest.clear();
+  m_colors.clear();
+  m_length.clear();
+  m_color.clear();
+  m_bounds.clear();
+
+  // only the root
+  m_first.assign(1, 0);
+  m_count.assign(1, 0);
+  m_label.assign(1, 0);
+  m_fail.assign(1, 0);
+  m_dict.assign(1, 0);
+  m_keyword.assign(1, 0);
+  m_depth.assign(1, 0);
+
+  for(unsigned i = 0; i < 256; i++)
+  {
+    m_root[i] = 0;
+  }
+}
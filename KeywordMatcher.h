@@ -0,0 +1,248 @@
+// -----------------------------------------------------------------------------
+// KeywordMatcher.h                                             KeywordMatcher.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref KeywordMatcher class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef KEYWORDMATCHER_H_INCLUDE_NO1
+#define KEYWORDMATCHER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <stdint.h>  /* uint32_t */
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "SpanLexer.h"
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// the cache includes this file indirectly
+class RenderCache;
+
+
+// --------------
+// KeywordMatcher
+// --------------
+/**
+ * @brief  This class colors the keywords of a user-supplied list.
+ *
+ * All keywords are compiled into an Aho-Corasick automaton, so each
+ * line is scanned once, no matter how many keywords there are.  The
+ * leftmost match wins, and the longest one among those starting at the
+ * same character.  A keyword that starts (ends) with a letter, a digit
+ * or an underscore only matches where no such character precedes
+ * (follows) it, so <tt>open</tt> doesn't match within <tt>fopen</tt>.
+ *
+ * Once compiled, the matcher is never changed, so all threads may share
+ * the same one.
+ */
+class KeywordMatcher
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // --------------
+  // KeywordMatcher
+  // --------------
+  /**
+   * @brief  The standard-constructor (no keywords).
+   */
+  KeywordMatcher();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // add
+  // ---
+  /**
+   * @brief  This method adds a keyword (a later color replaces an earlier one).
+   */
+  void add(const std::string& keyword, const std::string& color);
+
+  // -------
+  // compile
+  // -------
+  /**
+   * @brief  This method replaces the automaton by one that matches all
+   *         keywords added so far (which are forgotten then).
+   */
+  void compile();
+
+  // ----
+  // load
+  // ----
+  /**
+   * @brief  This method reads and compiles a keyword list.
+   *
+   * Each line holds a keyword and its color, separated by spaces or tabs.
+   * Empty lines and lines starting with # are skipped.  If a cache is
+   * given, the compiled automaton is stored in it and reused as long as
+   * the list doesn't change.
+   *
+   * @return  false if the list could not be read
+   */
+  bool load(const std::string& path, RenderCache* cache = 0);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // size
+  // ----
+  /**
+   * @brief  This method returns the number of compiled keywords.
+   */
+  std::size_t size() const
+  {
+    return m_length.size();
+  }
+
+  // ------
+  // digest
+  // ------
+  /**
+   * @brief  This method returns a hash of all compiled keywords and colors.
+   */
+  const std::string& digest() const
+  {
+    return m_digest;
+  }
+
+  // ----
+  // save
+  // ----
+  /**
+   * @brief  This method returns the compiled automaton in binary form.
+   */
+  std::string save() const;
+
+  // -------
+  // restore
+  // -------
+  /**
+   * @brief  This method replaces the automaton by one returned by save().
+   *
+   * @return  false if the data is broken (the matcher is empty then)
+   */
+  bool restore(const std::string& data);
+
+  // ---------
+  // highlight
+  // ---------
+  /**
+   * @brief  This method colors the keywords within the plain spans of a line.
+   *
+   * @param line    points to the first character of the line.
+   * @param spans   holds the spans of the line (see SpanLexer::lex()).
+   * @param result  receives the spans with the keywords colored.
+   */
+  void highlight(const char* line, const std::vector<SpanLexer::Span>& spans, std::vector<SpanLexer::Span>& result) const;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // child
+  // -----
+  /**
+   * @brief  This method returns the child of a node (0 if there is none).
+   */
+  uint32_t child(uint32_t node, unsigned char label) const;
+
+  // ----
+  // scan
+  // ----
+  /**
+   * @brief  This method splits a run of plain characters into plain and
+   *         colored spans.
+   */
+  void scan(const char* line, const char* first, const char* end, std::vector<SpanLexer::Span>& result) const;
+
+  // -----
+  // clear
+  // -----
+  /**
+   * @brief  This method forgets the automaton.
+   */
+  void clear();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the keywords not compiled yet and their colors
+  std::map<std::string, std::string> m_pending;
+
+  /// a hash of all compiled keywords and colors
+  std::string m_digest;
+
+  /// all color names
+  std::vector<std::string> m_colors;
+
+  /// the length of each keyword
+  std::vector<uint32_t> m_length;
+
+  /// the color of each keyword (index of m_colors)
+  std::vector<uint32_t> m_color;
+
+  /// the word boundaries each keyword needs (see KeywordMatcher.cpp)
+  std::vector<unsigned char> m_bounds;
+
+  /// the first child of each node (the children of a node are adjacent)
+  std::vector<uint32_t> m_first;
+
+  /// the number of children of each node
+  std::vector<uint32_t> m_count;
+
+  /// the character leading to each node
+  std::vector<unsigned char> m_label;
+
+  /// the node of the longest proper suffix of each node
+  std::vector<uint32_t> m_fail;
+
+  /// the node of the longest proper suffix that is a keyword (0 if none)
+  std::vector<uint32_t> m_dict;
+
+  /// the keyword ending at each node plus one (0 if none)
+  std::vector<uint32_t> m_keyword;
+
+  /// the number of characters leading to each node (not saved)
+  std::vector<uint32_t> m_depth;
+
+  /// the children of the root (0 if none)
+  uint32_t m_root[256];
+
+};
+
+#endif  /* #ifndef KEYWORDMATCHER_H_INCLUDE_NO1 */
@@ -12,7 +12,11 @@
 // -----------------------------------------------------------------------------
 // Includes                                                             Includes
 // -----------------------------------------------------------------------------
-#include <iostream>
+#include <algorithm>  /* min(), max() */
+#include <deque>
+#include <sstream>
+#include "WorkerPool.h"
+#include "SpanEmitter.h"
 #include "LaTeXGenerator.h"
 
 
@@ -22,6 +26,208 @@
 using namespace std;
 
 
+// -----------------------------------------------------------------------------
+// Escape table                                                     Escape table
+// -----------------------------------------------------------------------------
+
+// table entries
+#define ESC(s)   { s, sizeof(s) - 1 }
+#define SELF(c)  { IDENTITY + c, 1 }
+#define CTRL     ESC("[CTRL]")
+
+/// the LaTeX code of all 256 characters (indexed by unsigned char)
+static const Escape ESCAPE[256] =
+{
+  /*   0 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*   8 */ CTRL, ESC("\\ \\ "), CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  16 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  24 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  32 */ ESC("\\ "), SELF(33), ESC("\\grqq{}"), ESC("\\#"), ESC("\\$"), ESC("\\%"), ESC("\\&"), SELF(39),
+  /*  40 */ SELF(40), SELF(41), SELF(42), SELF(43), SELF(44), ESC("-{}"), SELF(46), SELF(47),
+  /*  48 */ SELF(48), SELF(49), SELF(50), SELF(51), SELF(52), SELF(53), SELF(54), SELF(55),
+  /*  56 */ SELF(56), SELF(57), SELF(58), SELF(59), ESC("<{}"), SELF(61), ESC(">{}"), SELF(63),
+  /*  64 */ SELF(64), SELF(65), SELF(66), SELF(67), SELF(68), SELF(69), SELF(70), SELF(71),
+  /*  72 */ SELF(72), SELF(73), SELF(74), SELF(75), SELF(76), SELF(77), SELF(78), SELF(79),
+  /*  80 */ SELF(80), SELF(81), SELF(82), SELF(83), SELF(84), SELF(85), SELF(86), SELF(87),
+  /*  88 */ SELF(88), SELF(89), SELF(90), SELF(91), ESC("\\textbackslash{}"), SELF(93), ESC("\\^{}"), ESC("\\_"),
+  /*  96 */ SELF(96), SELF(97), SELF(98), SELF(99), SELF(100), SELF(101), SELF(102), SELF(103),
+  /* 104 */ SELF(104), SELF(105), SELF(106), SELF(107), SELF(108), SELF(109), SELF(110), SELF(111),
+  /* 112 */ SELF(112), SELF(113), SELF(114), SELF(115), SELF(116), SELF(117), SELF(118), SELF(119),
+  /* 120 */ SELF(120), SELF(121), SELF(122), ESC("\\{"), SELF(124), ESC("\\}"), ESC("\\textasciitilde{}"), SELF(127),
+  /* 128 */ SELF(128), SELF(129), SELF(130), SELF(131), SELF(132), SELF(133), SELF(134), SELF(135),
+  /* 136 */ SELF(136), SELF(137), SELF(138), SELF(139), SELF(140), SELF(141), SELF(142), SELF(143),
+  /* 144 */ SELF(144), SELF(145), SELF(146), SELF(147), SELF(148), SELF(149), SELF(150), SELF(151),
+  /* 152 */ SELF(152), SELF(153), SELF(154), SELF(155), SELF(156), SELF(157), SELF(158), SELF(159),
+  /* 160 */ SELF(160), SELF(161), SELF(162), SELF(163), SELF(164), SELF(165), SELF(166), SELF(167),
+  /* 168 */ SELF(168), SELF(169), SELF(170), SELF(171), SELF(172), SELF(173), SELF(174), SELF(175),
+  /* 176 */ SELF(176), SELF(177), SELF(178), SELF(179), SELF(180), SELF(181), SELF(182), SELF(183),
+  /* 184 */ SELF(184), SELF(185), SELF(186), SELF(187), SELF(188), SELF(189), SELF(190), SELF(191),
+  /* 192 */ SELF(192), SELF(193), SELF(194), SELF(195), SELF(196), SELF(197), SELF(198), SELF(199),
+  /* 200 */ SELF(200), SELF(201), SELF(202), SELF(203), SELF(204), SELF(205), SELF(206), SELF(207),
+  /* 208 */ SELF(208), SELF(209), SELF(210), SELF(211), SELF(212), SELF(213), SELF(214), SELF(215),
+  /* 216 */ SELF(216), SELF(217), SELF(218), SELF(219), SELF(220), SELF(221), SELF(222), SELF(223),
+  /* 224 */ SELF(224), SELF(225), SELF(226), SELF(227), SELF(228), SELF(229), SELF(230), SELF(231),
+  /* 232 */ SELF(232), SELF(233), SELF(234), SELF(235), SELF(236), SELF(237), SELF(238), SELF(239),
+  /* 240 */ SELF(240), SELF(241), SELF(242), SELF(243), SELF(244), SELF(245), SELF(246), SELF(247),
+  /* 248 */ SELF(248), SELF(249), SELF(250), SELF(251), SELF(252), SELF(253), SELF(254), SELF(255)
+};
+
+#undef CTRL
+#undef SELF
+#undef ESC
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the minimum number of input bytes rendered by one parallel task
+static const size_t CHUNKSIZE = 1024 * 1024;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ----------
+// countSpans
+// ----------
+/**
+ * @brief  This function returns the number of highlighted sequences of a
+ *         line or of a part of it (as counted by LaTeXGenerator::emitSpans()).
+ *
+ * An unfinished color name is counted by the part that finishes it.
+ */
+static size_t countSpans(const vector<SpanLexer::Span>& spans, bool unfinished = false)
+{
+  size_t count = 0;
+
+  for(size_t i = 0; i < spans.size(); i++)
+  {
+    if ((spans[i].kind == SpanLexer::NAME) || (spans[i].kind == SpanLexer::AUTO)) count += 1;
+  }
+
+  if (unfinished && (count > 0)) count -= 1;
+
+  return count;
+}
+
+
+// -----------------------------------------------------------------------------
+// Tasks                                                                   Tasks
+// -----------------------------------------------------------------------------
+
+// -------------
+// ParagraphTask
+// -------------
+/**
+ * @brief  This task renders a run of complete paragraphs into a string.
+ *
+ * Except for the document's first chunk, the recent paragraph is
+ * considered full, so the paragraph break is emitted as soon as the
+ * chunk's first line has been parsed successfully.  The lines are
+ * remembered by the memo of the thread that runs the task, so the memo
+ * lasts across chunks.
+ */
+class ParagraphTask : public WorkerPool::Task
+{
+
+public:
+
+  /// the constructor
+  ParagraphTask(const LaTeXGenerator& generator, const char* data, size_t size, bool leading, size_t lines, vector<LineMemo>* memos)
+  : m_generator(generator), m_data(data), m_size(size), m_success(false), m_memos(memos)
+  {
+    m_lpp     = leading ? 0 : generator.m_maxEach;
+    m_initial = leading;
+
+    // lines in front of the chunk
+    m_generator.m_line = lines;
+
+    m_generator.m_problems.clear();
+
+    // counters of this thread
+    if (generator.m_stats != 0) m_generator.m_stats = &m_stats;
+  }
+
+  /// this method renders the paragraphs
+  void run()
+  {
+    // memo of this thread
+    if (m_memos != 0) m_generator.m_memo = &(*m_memos)[ worker() ];
+
+    InputReader reader;
+    reader.open(m_data, m_size);
+
+    OutputBuffer out(m_output);
+
+    m_success = m_generator.parseLines(reader, m_lpp, m_initial, out);
+
+    out.flush();
+  }
+
+  /// the generated LaTeX code
+  const string& output() const
+  {
+    return m_output;
+  }
+
+  /// all lines have been parsed successfully
+  bool success() const
+  {
+    return m_success;
+  }
+
+  /// the number of lines in the last paragraph
+  unsigned lpp() const
+  {
+    return m_lpp;
+  }
+
+  /// the rejected lines of this chunk
+  const vector<MarkupChecker::Problem>& problems() const
+  {
+    return m_generator.m_problems;
+  }
+
+  /// the counters of this chunk
+  const RenderStats& stats() const
+  {
+    return m_stats;
+  }
+
+private:
+
+  /// a private copy of the settings
+  LaTeXGenerator m_generator;
+
+  /// the first character of the paragraphs
+  const char* m_data;
+
+  /// the number of characters
+  size_t m_size;
+
+  /// lines per paragraph
+  unsigned m_lpp;
+
+  /// initial paragraph
+  bool m_initial;
+
+  /// the generated LaTeX code
+  string m_output;
+
+  /// all lines have been parsed successfully
+  bool m_success;
+
+  /// the counters of this chunk (used if the settings have counters)
+  RenderStats m_stats;
+
+  /// the memos of all threads (0 if the settings have no memo)
+  vector<LineMemo>* m_memos;
+
+};
+
+
 // -----------------------------------------------------------------------------
 // Construction                                                     Construction
 // -----------------------------------------------------------------------------
@@ -39,10 +245,19 @@ LaTeXGenerator::LaTeXGenerator()
   m_document = false;
   m_maxFirst = 0;
   m_maxEach  = 0;
-  m_line     = "";
+  m_flush    = false;
+  m_compact  = false;
+  m_spaces   = false;
   m_parsed   = "";
-  m_cc       = 0;
-  m_rc       = 0;
+  m_stats    = 0;
+  m_keywords = 0;
+  m_recover  = false;
+  m_line     = 0;
+  m_memo     = 0;
+  m_emitter  = 0;
+
+  updateScanner();
+  updateGroups();
 }
 
 
@@ -59,6 +274,30 @@ LaTeXGenerator::LaTeXGenerator()
 void LaTeXGenerator::setSyntaxCharacter(char trigger)
 {
   m_trigger = trigger;
+
+  m_lexer.setTrigger(trigger);
+}
+
+// -----------
+// setLanguage
+// -----------
+/*
+ *
+ */
+bool LaTeXGenerator::setLanguage(const string& name)
+{
+  return m_highlighter.setLanguage(name);
+}
+
+// -----------
+// setKeywords
+// -----------
+/*
+ *
+ */
+void LaTeXGenerator::setKeywords(const KeywordMatcher* keywords)
+{
+  m_keywords = keywords;
 }
 
 // ---------------------
@@ -70,6 +309,8 @@ void LaTeXGenerator::setSyntaxCharacter(char trigger)
 void LaTeXGenerator::enableBackgroundColor(bool flag)
 {
   m_bgcolor = flag;
+
+  updateGroups();
 }
 
 // --------------
@@ -83,133 +324,743 @@ void LaTeXGenerator::enableDocument(bool flag)
   m_document = flag;
 }
 
-// ----------------
-// setMaxLinesFirst
-// ----------------
+// -----------------
+// enableInteractive
+// -----------------
+/*
+ *
+ */
+void LaTeXGenerator::enableInteractive(bool flag)
+{
+  m_flush = flag;
+}
+
+// -------------
+// enableCompact
+// -------------
+/*
+ *
+ */
+void LaTeXGenerator::enableCompact(bool flag)
+{
+  m_compact = flag;
+
+  updateGroups();
+}
+
+// -------------------
+// enableCompactSpaces
+// -------------------
+/*
+ *
+ */
+void LaTeXGenerator::enableCompactSpaces(bool flag)
+{
+  m_spaces = flag;
+}
+
+// ----------------
+// setMaxLinesFirst
+// ----------------
+/*
+ *
+ */
+void LaTeXGenerator::setMaxLinesFirst(unsigned max)
+{
+  m_maxFirst = max;
+}
+
+// ---------------
+// setMaxLinesEach
+// ---------------
+/*
+ *
+ */
+void LaTeXGenerator::setMaxLinesEach(unsigned max)
+{
+  m_maxEach = max;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// --------
+// setStats
+// --------
+/*
+ *
+ */
+void LaTeXGenerator::setStats(RenderStats* stats)
+{
+  m_stats = stats;
+}
+
+// -------------
+// enableRecover
+// -------------
+/*
+ *
+ */
+void LaTeXGenerator::enableRecover(bool flag)
+{
+  m_recover = flag;
+}
+
+// -------
+// setMemo
+// -------
+/*
+ *
+ */
+void LaTeXGenerator::setMemo(LineMemo* memo)
+{
+  m_memo = memo;
+}
+
+// ---------
+// signature
+// ---------
+/*
+ * Bump the format version whenever the generated code changes.
+ */
+string LaTeXGenerator::signature() const
+{
+  ostringstream sig;
+
+  sig << "parcolor-2"
+      << " trigger="  << static_cast<unsigned>(static_cast<unsigned char>(m_trigger))
+      << " bgcolor="  << m_bgcolor
+      << " document=" << m_document
+      << " first="    << m_maxFirst
+      << " each="     << m_maxEach
+      << " compact="  << m_compact
+      << " spaces="   << m_spaces;
+
+  // older signatures stay valid
+  if (m_highlighter.language() != SyntaxHighlighter::NONE) sig << " highlight=" << m_highlighter.name();
+  if (m_keywords != 0)                                     sig << " keywords="  << m_keywords->digest();
+  if (m_recover)                                           sig << " recover=1";
+
+  return sig.str();
+}
+
+// -----
+// stats
+// -----
+/*
+ *
+ */
+RenderStats* LaTeXGenerator::stats() const
+{
+  return m_stats;
+}
+
+// ----
+// memo
+// ----
+/*
+ *
+ */
+LineMemo* LaTeXGenerator::memo() const
+{
+  return m_memo;
+}
+
+// --------
+// problems
+// --------
+/*
+ *
+ */
+const vector<MarkupChecker::Problem>& LaTeXGenerator::problems() const
+{
+  return m_problems;
+}
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool LaTeXGenerator::render(const char* data, size_t size, string& out, unsigned threads)
+{
+  // keep capacity
+  out.clear();
+
+  InputReader reader;
+  reader.open(data, size);
+
+  OutputBuffer buffer(out);
+
+  return parse(reader, buffer, threads);
+}
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool LaTeXGenerator::render(const char* data, size_t size, OutputSink& sink, unsigned threads)
+{
+  InputReader reader;
+  reader.open(data, size);
+
+  OutputBuffer buffer(sink);
+
+  return parse(reader, buffer, threads);
+}
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool LaTeXGenerator::render(istream& in, OutputSink& sink, unsigned threads)
+{
+  InputReader reader;
+  reader.setStats(m_stats);
+  reader.open(in);
+
+  OutputBuffer buffer(sink);
+
+  return parse(reader, buffer, threads);
+}
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool LaTeXGenerator::render(int fd, OutputSink& sink, unsigned threads)
+{
+  InputReader reader;
+  reader.setStats(m_stats);
+  reader.open(fd);
+
+  return render(reader, sink, threads);
+}
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool LaTeXGenerator::render(InputReader& reader, OutputSink& sink, unsigned threads)
+{
+  OutputBuffer buffer(sink);
+
+  return parse(reader, buffer, threads);
+}
+
+// -----
+// parse
+// -----
+/*
+ * With counters attached, the time spent here apart from reading and
+ * writing is counted as parsing.
+ */
+bool LaTeXGenerator::parse(InputReader& reader, OutputBuffer& out, unsigned threads)
+{
+  double started = 0;
+  double waited  = 0;
+
+  if (m_stats != 0)
+  {
+    started = RenderStats::now();
+    waited  = m_stats->readSeconds + m_stats->writeSeconds;
+  }
+
+  if (m_emitter != 0) m_emitter->open(out);
+  else                openOutput(out);
+
+  // forget the recent input
+  m_line = 0;
+
+  m_problems.clear();
+
+  // lines per paragraph
+  unsigned lpp = 0;
+
+  // initial paragraph
+  bool initial = true;
+
+  // comments and strings may span several lines
+  m_highlighter.reset();
+
+  // so do the spans passed to other formats
+  if ((m_highlighter.language() != SyntaxHighlighter::NONE) || (m_emitter != 0)) threads = 1;
+
+  // generate LaTeX code
+  bool success = ((threads > 1) && (m_maxEach > 0)) ? parseParallel(reader, out, threads, lpp)
+                                                     : parseLines(reader, lpp, initial, out);
+
+  // don't finish broken code
+  if (success)
+  {
+    if (m_emitter != 0) m_emitter->close(out);
+    else                closeOutput(lpp, out);
+
+    // write remaining data
+    out.flush();
+
+    // all data has been written or not
+    success = out.good();
+  }
+
+  if (m_stats != 0)
+  {
+    waited = m_stats->readSeconds + m_stats->writeSeconds - waited;
+
+    m_stats->parseSeconds += RenderStats::now() - started - waited;
+  }
+
+  return success;
+}
+
+// ----------
+// parseLines
+// ----------
+/*
+ * The enclosing group has already been opened.  It is left open for the
+ * caller, so the lines of another reader can be appended seamlessly.
+ */
+bool LaTeXGenerator::parseLines(InputReader& reader, unsigned& lpp, bool& initial, OutputBuffer& out)
+{
+  // reset buffer
+  m_parsed.clear();
+
+  // the currently extracted line (or its first part)
+  const char* line = 0;
+  size_t      size = 0;
+
+  bool complete = true;
+
+  // the highlighters need whole lines (apart from ANSI), so does recovering
+  bool whole = m_highlighter.wholeLines() || (m_keywords != 0) || m_recover;
+
+  // the colors of the syntax highlighter depend on the lines before (and
+  // the memo holds LaTeX code only)
+  LineMemo* memo = ((m_highlighter.language() == SyntaxHighlighter::NONE) && (m_emitter == 0)) ? m_memo : 0;
+
+  if (memo != 0) memo->setContext( signature() );
+
+  // the highlighted sequences of a line
+  size_t spans = 0;
+
+  // get all lines
+  while (whole ? reader.readLine(line, size) : reader.readPart(line, size, complete))
+  {
+    m_line += 1;
+
+    // long line
+    if ( !complete )
+    {
+      // signalize trouble
+      if ( !parseLongLine(reader, line, size, lpp, initial, out) ) return false;
+
+      continue;
+    }
+
+    // repeated line
+    if ((memo != 0) && memo->recall(line, size, m_parsed, spans))
+    {
+      // the characters are counted by their spans
+      if (m_stats != 0)
+      {
+        m_stats->spans += spans;
+
+        m_lexer.lex(line, size, m_spans);
+      }
+    }
+
+    // generate LaTeX code
+    else if ( parseLine(line, size) )
+    {
+      if (memo != 0) memo->store(line, size, m_parsed, countSpans(m_spans));
+    }
+
+    else if ( !recoverLine(line, size) )
+    {
+      // signalize trouble
+      return false;
+    }
+
+    if (m_stats != 0) countText(line, m_spans);
+
+    appendLine(line, size, lpp, initial, out);
+  }
+
+  // signalize success
+  return true;
+}
+
+// -------------
+// parseLongLine
+// -------------
+/*
+ * The first part is never empty (see InputReader::readPart()), so the
+ * line isn't either.  Just like a line rejected by parseLine(), the
+ * code written so far remains in the output if the markup turns out
+ * to be incomplete.  Terminal colors (--highlight ansi) look the same as
+ * in a short line, but a run that crosses two parts is colored twice,
+ * and a single trigger that ended a part stays uncolored.
+ */
+bool LaTeXGenerator::parseLongLine(InputReader& reader, const char* part, size_t size, unsigned& lpp, bool& initial, OutputBuffer& out)
+{
+  startLine(lpp, initial, out);
+
+  SpanLexer::Progress progress = { false, false, false };
+
+  // the number of characters in the line
+  size_t total = 0;
+
+  // the trigger that opened the recent color name and the name
+  size_t opened = 0;
+  string color;
+
+  bool complete = false;
+
+  while (true)
+  {
+    bool continued = progress.naming;
+
+    bool success = m_lexer.lexPart(part, size, complete, progress, m_spans);
+
+    // remember the recent color name for diagnostics
+    for(size_t i = 0; i < m_spans.size(); i++)
+    {
+      const SpanLexer::Span& span = m_spans[i];
+
+      if (span.kind != SpanLexer::NAME) continue;
+
+      if (!continued || (i > 0))
+      {
+        opened = total + span.offset - 2;
+
+        color.clear();
+      }
+
+      if (color.size() < MarkupChecker::MAXCOLOR)
+      {
+        color.append(part + span.offset, min(span.length, MarkupChecker::MAXCOLOR - color.size()));
+      }
+    }
+
+    if ( !success )
+    {
+      MarkupChecker::Problem problem;
+
+      problem.line    = m_line;
+      problem.column  = progress.trigger ? total + size : opened + 1;
+      problem.reason  = progress.trigger ? MarkupChecker::TRIGGER : (progress.naming ? MarkupChecker::NAME : MarkupChecker::SEQUENCE);
+      problem.colored = progress.colored;
+
+      if (progress.colored || progress.naming) problem.color = color;
+
+      m_problems.push_back(problem);
+
+      // signalize trouble
+      return false;
+    }
+
+    // color terminal output (an escape sequence may continue)
+    if (m_highlighter.language() == SyntaxHighlighter::ANSI) m_highlighter.highlight(part, m_spans, total > 0);
+
+    // pass the spans to other formats
+    if (m_emitter != 0)
+    {
+      m_emitter->emitPart(part, size, m_spans, continued, progress.naming, out);
+
+      if (m_stats != 0) m_stats->spans += countSpans(m_spans, progress.naming);
+    }
+
+    else
+    {
+      m_parsed.clear();
+
+      emitSpans(part, m_spans, continued, progress.naming);
+
+      // show LaTeX code of the part
+      out << m_parsed;
+    }
+
+    if (m_stats != 0) countText(part, m_spans);
+
+    total += size;
+
+    if ( complete ) break;
+
+    reader.readPart(part, size, complete);
+  }
+
+  if (m_emitter != 0) m_emitter->endLine(out);
+
+  if (m_stats != 0) m_stats->countLine(total, lpp == 0);
+
+  // increase line counter
+  lpp += 1;
+
+  // signalize success
+  return true;
+}
+
+// -----------
+// recoverLine
+// -----------
+/*
+ * The line is checked once more to find out what's wrong with it.  It's
+ * displayed as plain code, so each trigger shows up as it is.
+ */
+bool LaTeXGenerator::recoverLine(const char* line, size_t size)
+{
+  MarkupChecker::Problem problem;
+
+  MarkupChecker(m_trigger).checkLine(line, size, problem);
+
+  problem.line = m_line;
+
+  m_problems.push_back(problem);
+
+  // signalize trouble
+  if ( !m_recover ) return false;
+
+  // a rejected line is never empty
+  m_spans.clear();
+
+  SpanLexer::Span span;
+
+  span.offset = 0;
+  span.length = size;
+  span.kind   = SpanLexer::PLAIN;
+  span.color  = 0;
+
+  m_spans.push_back(span);
+
+  emitLine(line, size, m_spans);
+
+  // signalize success
+  return true;
+}
+
+// ----------
+// openOutput
+// ----------
+/*
+ *
+ */
+void LaTeXGenerator::openOutput(OutputBuffer& out) const
+{
+  if (m_document) openDocument(out);
+
+  if (m_compact) setupGroups(out);
+
+  openGroup(out);
+}
+
+// -----------
+// closeOutput
+// -----------
+/*
+ *
+ */
+void LaTeXGenerator::closeOutput(unsigned lpp, OutputBuffer& out) const
+{
+  // don't break LaTeX line
+  if (lpp > 0) out << "%\n";
+
+  closeGroup(out);
+
+  if (m_document) closeDocument(out);
+}
+
+// ----------
+// appendLine
+// ----------
+/*
+ * The LaTeX code of the line has already been generated (unless the
+ * spans are passed to other formats).
+ */
+void LaTeXGenerator::appendLine(const char* line, size_t size, unsigned& lpp, bool& initial, OutputBuffer& out)
+{
+  startLine(lpp, initial, out);
+
+  // pass the spans to other formats
+  if (m_emitter != 0)
+  {
+    m_emitter->emitPart(line, size, m_spans, false, false, out);
+    m_emitter->endLine(out);
+
+    if (m_stats != 0) m_stats->spans += countSpans(m_spans);
+  }
+
+  // show LaTeX line
+  else
+  {
+    out << m_parsed;
+  }
+
+  if (m_stats != 0) m_stats->countLine(size, lpp == 0);
+
+  // increase line counter
+  lpp += 1;
+}
+
+// ---------
+// startLine
+// ---------
 /*
  *
  */
-void LaTeXGenerator::setMaxLinesFirst(unsigned max)
+void LaTeXGenerator::startLine(unsigned& lpp, bool& initial, OutputBuffer& out) const
 {
-  m_maxFirst = max;
+  // check lines within initial paragraph and within each paragraph
+  if ((initial && (m_maxFirst > 0) && (lpp == m_maxFirst)) || ((m_maxEach > 0) && (lpp == m_maxEach)))
+  {
+    // other formats only count the paragraphs
+    if (m_emitter == 0)
+    {
+      // don't break LaTeX line
+      if (lpp > 0) out << "%\n";
+
+      closeGroup(out);
+
+      // paragraph finished
+      if (m_flush) out.flush();
+
+      out << "\\par\n";
+
+      openGroup(out);
+    }
+
+    lpp = 0;
+
+    initial = false;
+  }
+
+  // break recent line
+  if ((lpp > 0) && (m_emitter == 0)) out << "\\\\{}%\n";
 }
 
-// ---------------
-// setMaxLinesEach
-// ---------------
+// -------------
+// parseParallel
+// -------------
 /*
- *
+ * The input is cut into chunks of complete paragraphs, so each chunk can
+ * be rendered on its own.  The chunks are written in their original order
+ * and only a few of them are kept in memory at the same time.  If a chunk
+ * fails, its partial output is written just like the serial run would.
+ * The lines are counted by the same reader that parseLines() uses, so
+ * chunks are cut only at the paragraph boundaries parseLines() would also
+ * see.  Each thread keeps its own memo for all chunks it renders.
  */
-void LaTeXGenerator::setMaxLinesEach(unsigned max)
+bool LaTeXGenerator::parseParallel(InputReader& reader, OutputBuffer& out, unsigned threads, unsigned& lpp)
 {
-  m_maxEach = max;
-}
+  // all characters in one piece
+  const char* data;
+  size_t      size;
 
+  reader.contents(data, size);
 
-// -----------------------------------------------------------------------------
-// Handling                                                             Handling
-// -----------------------------------------------------------------------------
+  const char* end = data + size;
 
-// -----
-// parse
-// -----
-/*
- *
- */
-bool LaTeXGenerator::parse()
-{
-  // reset buffers
-  m_line   = "";
-  m_parsed = "";
-  m_cc     = 0;
-  m_rc     = 0;
+  // lines within the initial paragraph
+  unsigned first = ((m_maxFirst > 0) && (m_maxFirst < m_maxEach)) ? m_maxFirst : m_maxEach;
 
-  if (m_document) openDocument();
+  // find chunk boundaries
+  InputReader scanner;
+  scanner.open(data, size);
 
-  openGroup();
+  // the chunks that haven't been written yet
+  deque<ParagraphTask*> pending;
 
-  // lines per paragraph
-  unsigned lpp = 0;
+  // the number of paragraphs and lines passed to all chunks so far
+  size_t paragraphs = 0;
+  size_t lines      = 0;
 
-  // initial paragraph
-  bool initial = true;
+  bool success = true;
+  bool done    = false;
+
+  WorkerPool pool(threads);
+
+  // one memo per thread, each with the full limit
+  vector<LineMemo> memos;
+
+  if (m_memo != 0) memos.resize(max(pool.size(), 1u), LineMemo( m_memo->limit() ));
 
-  // get all lines from stdin
-  while ( readLine() )
+  while (success && !done)
   {
-    // generate LaTeX code
-    if ( !parseLine() )
-    {
-      // signalize trouble
-      return false;
-    }
+    const char* begin = scanner.position();
+
+    bool leading = (paragraphs == 0);
 
-    // check lines within initial paragraph
-    if (initial && (m_maxFirst > 0))
+    size_t skipped = lines;
+
+    // collect complete paragraphs
+    do
     {
-      if (lpp == m_maxFirst)
-      {
-        // don't break LaTeX line
-        if (lpp > 0) cout << "%" << endl;
+      lines += scanner.skipLines((paragraphs == 0) ? first : m_maxEach);
 
-        closeGroup();
+      paragraphs += 1;
+    }
+    while ((scanner.position() != end) && (static_cast<size_t>(scanner.position() - begin) < CHUNKSIZE));
 
-        cout << "\\par" << endl;
+    done = (scanner.position() == end);
 
-        openGroup();
+    ParagraphTask* task = new ParagraphTask(*this, begin, scanner.position() - begin, leading, skipped, (m_memo != 0) ? &memos : 0);
 
-        lpp = 0;
+    pending.push_back(task);
 
-        initial = false;
-      }
-    }
+    pool.submit(task);
 
-    // check lines within each paragraph
-    if (m_maxEach > 0)
+    // write finished chunks
+    while (!pending.empty() && (done || (pending.size() >= 2 * threads)))
     {
-      if (lpp == m_maxEach)
-      {
-        // don't break LaTeX line
-        if (lpp > 0) cout << "%" << endl;
+      task = pending.front();
 
-        closeGroup();
+      pool.wait(task);
 
-        cout << "\\par" << endl;
+      pending.pop_front();
 
-        openGroup();
+      out << task->output();
 
-        lpp = 0;
+      success = task->success();
 
-        initial = false;
-      }
-    }
+      lpp = task->lpp();
 
+      if (m_stats != 0) m_stats->merge( task->stats() );
 
-    // break recent line
-    if (lpp > 0) cout << "\\\\{}%" << endl;
+      m_problems.insert(m_problems.end(), task->problems().begin(), task->problems().end());
 
-    // show LaTeX line
-    cout << m_parsed;
+      delete task;
 
-    // increase line counter
-    lpp += 1;
-  }
+      if ( !success ) break;
 
-  // don't break LaTeX line
-  if (lpp > 0) cout << "%" << endl;
+      // chunk finished
+      if (m_flush) out.flush();
+    }
+  }
 
-  closeGroup();
+  // drop remaining chunks
+  pool.wait();
 
-  if (m_document) closeDocument();
+  for(size_t i = 0; i < memos.size(); i++) m_memo->merge( memos[i] );
 
-  // signalize success
-  return true;
-}
+  while ( !pending.empty() )
+  {
+    delete pending.front();
 
+    pending.pop_front();
+  }
 
-// -----------------------------------------------------------------------------
-// Internal methods                                             Internal methods
-// -----------------------------------------------------------------------------
+  return success;
+}
 
 // ------------
 // openDocument
@@ -217,30 +1068,30 @@ bool LaTeXGenerator::parse()
 /*
  *
  */
-void LaTeXGenerator::openDocument() const
-{
-  cout << "\\documentclass" << endl;
-  cout << "[" << endl;
-  cout << "  draft    = true," << endl;
-  cout << "  fontsize = 11pt," << endl;
-  cout << "  parskip  = half-," << endl;
-  cout << "  BCOR     = 0pt," << endl;
-  cout << "  DIV      = 11," << endl;
-  cout << "  ngerman," << endl;
-  cout << "  dvipsnames" << endl;
-  cout << "]" << endl;
-  cout << "{scrartcl}" << endl;
-  cout << endl;
-  cout << "\\usepackage[utf8]{inputenc}" << endl;
-  cout << "\\usepackage[T1]{fontenc}" << endl;
-  cout << "\\usepackage{lmodern}" << endl;
-  cout << "\\usepackage{babel}" << endl;
-  cout << "\\usepackage{xcolor}" << endl;
-  cout << endl;
-  cout << "% ------------------------------------------------------------------------------" << endl;
-  cout << "\\begin{document}" << endl;
-  cout << "% ------------------------------------------------------------------------------" << endl;
-  cout << "\\small" << endl;
+void LaTeXGenerator::openDocument(OutputBuffer& out) const
+{
+  out << "\\documentclass\n";
+  out << "[\n";
+  out << "  draft    = true,\n";
+  out << "  fontsize = 11pt,\n";
+  out << "  parskip  = half-,\n";
+  out << "  BCOR     = 0pt,\n";
+  out << "  DIV      = 11,\n";
+  out << "  ngerman,\n";
+  out << "  dvipsnames\n";
+  out << "]\n";
+  out << "{scrartcl}\n";
+  out << "\n";
+  out << "\\usepackage[utf8]{inputenc}\n";
+  out << "\\usepackage[T1]{fontenc}\n";
+  out << "\\usepackage{lmodern}\n";
+  out << "\\usepackage{babel}\n";
+  out << "\\usepackage{xcolor}\n";
+  out << "\n";
+  out << "% ------------------------------------------------------------------------------\n";
+  out << "\\begin{document}\n";
+  out << "% ------------------------------------------------------------------------------\n";
+  out << "\\small\n";
 }
 
 // -------------
@@ -249,11 +1100,11 @@ void LaTeXGenerator::openDocument() const
 /*
  *
  */
-void LaTeXGenerator::closeDocument() const
+void LaTeXGenerator::closeDocument(OutputBuffer& out) const
 {
-  cout << "% ------------------------------------------------------------------------------" << endl;
-  cout << "\\end{document}" << endl;
-  cout << "% ------------------------------------------------------------------------------" << endl;
+  out << "% ------------------------------------------------------------------------------\n";
+  out << "\\end{document}\n";
+  out << "% ------------------------------------------------------------------------------\n";
 }
 
 // ---------
@@ -262,40 +1113,9 @@ void LaTeXGenerator::closeDocument() const
 /*
  *
  */
-void LaTeXGenerator::openGroup() const
+void LaTeXGenerator::openGroup(OutputBuffer& out) const
 {
-  // always open LaTeX paragraph
-  cout << "\\begingroup" << endl;
-  cout << "\\ttfamily" << endl;
-  cout << "\\setbox100=\\hbox{(}%" << endl;
-  cout << "\\dimen100=\\ht100" << endl;
-  cout << "\\advance\\dimen100 by \\dp100" << endl;
-  cout << "\\renewcommand{\\ }{\\hspace*{0.5em}}%" << endl;
-  cout << "\\definecolor{R}{named}{Red}%" << endl;
-  cout << "\\definecolor{G}{named}{ForestGreen}%" << endl;
-  cout << "\\definecolor{B}{named}{Cerulean}%" << endl;
-  cout << "\\definecolor{C}{named}{Cyan}%" << endl;
-  cout << "\\definecolor{M}{named}{Magenta}%" << endl;
-  cout << "\\definecolor{Y}{named}{YellowOrange}%" << endl;
-
-  // use background color (\colorbox)
-  if (m_bgcolor)
-  {
-    cout << "\\definecolor{background}{rgb}{0.82,0.82,0.92}%" << endl;
-    cout << "\\dimen200=\\linewidth" << endl;
-    cout << "\\advance\\dimen200 by -2\\fboxsep" << endl;
-    cout << "\\colorbox{background}%" << endl;
-    cout << "{%" << endl;
-    cout << "\\parbox{\\dimen200}%" << endl;
-    cout << "{%" << endl;
-  }
-
-  // no background color
-  else
-  {
-    cout << "\\parbox{\\linewidth}%" << endl;
-    cout << "{%" << endl;
-  }
+  out << m_openGroup;
 }
 
 // ----------
@@ -304,260 +1124,301 @@ void LaTeXGenerator::openGroup() const
 /*
  *
  */
-void LaTeXGenerator::closeGroup() const
+void LaTeXGenerator::closeGroup(OutputBuffer& out) const
 {
-  // always close \parbox
-  cout << "}% <-- parbox" << endl;
+  out << m_closeGroup;
+}
 
-  // close \colorbox
+// -----------
+// setupGroups
+// -----------
+/*
+ * The macro is \long, so its argument may hold any number of lines.  The
+ * colors are defined within its group, so they don't leak into the
+ * document that includes the code.
+ */
+void LaTeXGenerator::setupGroups(OutputBuffer& out) const
+{
+  out << "\\long\\def\\parcolorgroup#1{%\n";
+  out << "\\begingroup\n";
+  out << "\\ttfamily\n";
+  out << "\\setbox100=\\hbox{(}%\n";
+  out << "\\dimen100=\\ht100\n";
+  out << "\\advance\\dimen100 by \\dp100\n";
+  out << "\\renewcommand{\\ }{\\hspace*{0.5em}}%\n";
+  out << "\\definecolor{R}{named}{Red}%\n";
+  out << "\\definecolor{G}{named}{ForestGreen}%\n";
+  out << "\\definecolor{B}{named}{Cerulean}%\n";
+  out << "\\definecolor{C}{named}{Cyan}%\n";
+  out << "\\definecolor{M}{named}{Magenta}%\n";
+  out << "\\definecolor{Y}{named}{YellowOrange}%\n";
+
+  // use background color (\colorbox)
   if (m_bgcolor)
   {
-    cout << "}% <-- colorbox" << endl;
+    out << "\\definecolor{background}{rgb}{0.82,0.82,0.92}%\n";
+    out << "\\dimen200=\\linewidth\n";
+    out << "\\advance\\dimen200 by -2\\fboxsep\n";
+    out << "\\colorbox{background}{\\parbox{\\dimen200}{#1}}%\n";
   }
 
-  // always close LaTeX group
-  cout << "\\endgroup" << endl;
+  // no background color
+  else
+  {
+    out << "\\parbox{\\linewidth}{#1}%\n";
+  }
+
+  out << "\\endgroup}%\n";
 }
 
 // --------
-// readLine
+// emitLine
 // --------
 /*
- *
+ * The spans have been checked by the lexer, so there is nothing left
+ * that could fail.
  */
-bool LaTeXGenerator::readLine()
+void LaTeXGenerator::emitLine(const char* line, size_t size, const vector<SpanLexer::Span>& spans)
 {
-  // reset buffer
-  m_line = "";
+  // reset buffer (keeps capacity)
+  m_parsed.clear();
 
-  // initialize return value
-  bool extracted = false;
+  // the spans are passed to other formats instead (see appendLine())
+  if (m_emitter != 0) return;
 
-  // a sequence of whitespace characters
-  string blank = "";
-
-  // get characters from stdin
-  while ( cin.get(m_cc) )
+  // empty line extracted (or nothing but escape sequences)
+  if ((size == 0) || spans.empty())
   {
-    // CR
-    if (m_cc == 13)
-    {
-      // at least one byte extracted from stream
-      extracted = true;
+    // display empty line
+    m_parsed.assign("\\rule{0pt}{\\dimen100}");
 
-      // line finished
-      break;
-    }
+    return;
+  }
 
-    // LF
-    else if (m_cc == 10)
-    {
-      // standalone LF
-      if (m_rc != 13)
-      {
-        // at least one byte extracted from stream
-        extracted = true;
+  emitSpans(line, spans, false, false);
+}
 
-        // line finished
-        break;
-      }
-    }
+// ---------
+// emitSpans
+// ---------
+/*
+ * The buffer isn't reset, so the caller decides when the code is taken.
+ */
+void LaTeXGenerator::emitSpans(const char* line, const vector<SpanLexer::Span>& spans, bool continued, bool unfinished)
+{
+  for(size_t i = 0; i < spans.size(); i++)
+  {
+    const SpanLexer::Span& span = spans[i];
 
-    else
+    const char* first = line + span.offset;
+
+    switch (span.kind)
     {
-      // at least one byte extracted from stream
-      extracted = true;
+      case SpanLexer::PLAIN:
+      case SpanLexer::CODE:
+        emitText(first, first + span.length);
+        break;
 
-      // TAB
-      if (m_cc == 9)
-      {
-        // buffer whitespace character
-        blank += m_cc;
-      }
+      case SpanLexer::NAME:
+        // don't translate color name
+        if (!continued || (i > 0)) m_parsed += "\\textcolor{";
 
-      // SPACE
-      else if (m_cc == 32)
-      {
-        // buffer whitespace character
-        blank += m_cc;
-      }
+        m_parsed.append(first, span.length);
 
-      // regular characters
-      else
-      {
-        // check buffer
-        if ( !blank.empty() )
+        // color name finished
+        if (!unfinished || (i + 1 < spans.size()))
         {
-          // append all buffered characters
-          m_line.append(blank);
+          m_parsed += "}{\\textbf{";
 
-          // reset buffer
-          blank = "";
+          if (m_stats != 0) m_stats->spans += 1;
         }
+        break;
 
-        // append current character
-        m_line += m_cc;
-      }
-    }
+      case SpanLexer::STRAY:
+        // encode markup character and the following one (the trigger
+        // may have ended the previous part)
+        translate(m_trigger, m_parsed);
+        translate(first[span.length - 1], m_parsed);
+        break;
 
-    // update recent character
-    m_rc = m_cc;
-  }
+      case SpanLexer::END:
+        // close LaTeX commands (\textcolor and \textbf)
+        m_parsed += "}}";
+        break;
+
+      case SpanLexer::AUTO:
+        // colored by the highlighter
+        m_parsed += "\\textcolor{";
+        m_parsed += span.color;
+        m_parsed += "}{\\textbf{";
+        emitText(first, first + span.length);
+        m_parsed += "}}";
 
-  // signalize whether some data has been extracted or not
-  return extracted;
+        if (m_stats != 0) m_stats->spans += 1;
+        break;
+    }
+  }
 }
 
-// ---------
-// parseLine
-// ---------
+// --------
+// emitText
+// --------
 /*
  *
  */
-bool LaTeXGenerator::parseLine()
+void LaTeXGenerator::emitText(const char* first, const char* end)
 {
-  // reset buffer
-  m_parsed = "";
-
-  // empty line extracted
-  if ( m_line.empty() )
+  while (first != end)
   {
-    // display empty line
-    m_parsed = "\\rule{0pt}{\\dimen100}";
+    // copy plain characters in one go
+    const char* stop = m_special.find(first, end);
 
-    // signalize success
-    return true;
-  }
+    m_parsed.append(first, stop);
 
-  // the parser's states
-  enum
-  {
-    PLAINCODE,
-    ENTERMARKUP,
-    COLORNAME,
-    COLORCODE,
-    LEAVEMARKUP
-  }
-  context(PLAINCODE);
+    first = stop;
 
-  // parse extracted line
-  for(string::size_type i = 0; i < m_line.size(); i++)
-  {
-    // get current character
-    const char& c = m_line[i];
+    if (first == end) break;
 
-    // PLAINCODE
-    if (context == PLAINCODE)
+    // collapse spaces and tabs
+    if (m_spaces && ((*first == ' ') || (*first == '\t')))
     {
-      // first markup character found
-      if (c == m_trigger)
-      {
-        // next context
-        context = ENTERMARKUP;
-      }
-
-      else
-      {
-        // append translated character
-        m_parsed += translate(c);
-      }
+      first = translateSpaces(first, end, m_parsed);
     }
 
-    // ENTERMARKUP
-    else if (context == ENTERMARKUP)
+    else
     {
-      // second markup character found
-      if (c == m_trigger)
-      {
-        // start color command
-        m_parsed += "\\textcolor{";
+      // append translated character
+      translate(*first++, m_parsed);
+    }
+  }
+}
 
-        // next context
-        context = COLORNAME;
-      }
+// ---------
+// countText
+// ---------
+/*
+ * A stray trigger is displayed together with the following character,
+ * even if the trigger ended the previous part.
+ */
+void LaTeXGenerator::countText(const char* line, const vector<SpanLexer::Span>& spans) const
+{
+  for(size_t i = 0; i < spans.size(); i++)
+  {
+    const SpanLexer::Span& span = spans[i];
 
-      // markup character only occurred once
-      else
-      {
-        // encode first markup character
-        m_parsed += translate(m_trigger);
+    const char* first = line + span.offset;
 
-        // encode current character
-        m_parsed += translate(c);
+    switch (span.kind)
+    {
+      case SpanLexer::PLAIN:
+      case SpanLexer::CODE:
+      case SpanLexer::AUTO:
+        m_stats->countChars(first, span.length);
+        break;
 
-        // back to previous context
-        context = PLAINCODE;
-      }
+      case SpanLexer::STRAY:
+        m_stats->countChars(&m_trigger, 1);
+        m_stats->countChars(first + span.length - 1, 1);
+        break;
+
+      case SpanLexer::NAME:
+      case SpanLexer::END:
+        break;
     }
+  }
+}
 
-    // COLORNAME
-    else if (context == COLORNAME)
-    {
-      // color name completed
-      if (c == m_trigger)
-      {
-        // extend color command
-        m_parsed += "}{\\textbf{";
+// -------------
+// updateScanner
+// -------------
+/*
+ * The set holds the 14 printable characters with an escape sequence.  The
+ * trigger is left to the lexer.
+ */
+void LaTeXGenerator::updateScanner()
+{
+  m_special.clear();
 
-        // next context
-        context = COLORCODE;
-      }
+  // control characters and SPACE
+  m_special.addBelow(33);
 
-      // read color name
-      else
-      {
-        // don't translate color name
-        m_parsed += c;
-      }
-    }
+  // all other characters that aren't mapped to themselves
+  for(unsigned i = 33; i < 256; i++)
+  {
+    if (ESCAPE[i].text != IDENTITY + i) m_special.add(static_cast<char>(i));
+  }
+}
 
-    // COLORCODE
-    else if (context == COLORCODE)
-    {
-      // first markup character found
-      if (c == m_trigger)
-      {
-        // next context
-        context = LEAVEMARKUP;
-      }
+// ------------
+// updateGroups
+// ------------
+/*
+ * Each paragraph copies the finished code instead of checking the
+ * settings again.
+ */
+void LaTeXGenerator::updateGroups()
+{
+  m_openGroup.clear();
+  m_closeGroup.clear();
 
-      else
-      {
-        // encode current character
-        m_parsed += translate(c);
-      }
-    }
+  OutputBuffer open(m_openGroup);
+  OutputBuffer close(m_closeGroup);
 
-    // LEAVEMARKUP
-    else if (context == LEAVEMARKUP)
-    {
-      // second markup character found
-      if (c == m_trigger)
-      {
-        // close LaTeX commands (\textcolor and \textbf)
-        m_parsed += "}}";
+  // layout defined by setupGroups()
+  if (m_compact)
+  {
+    open  << "\\parcolorgroup{%\n";
 
-        // back to initial context
-        context = PLAINCODE;
-      }
+    // close argument of \parcolorgroup
+    close << "}%\n";
 
-      // markup character only occurred once
-      else
-      {
-        // encode recent markup character
-        m_parsed += translate(m_trigger);
+    return;
+  }
 
-        // encode current character
-        m_parsed += translate(c);
+  // always open LaTeX paragraph
+  open << "\\begingroup\n";
+  open << "\\ttfamily\n";
+  open << "\\setbox100=\\hbox{(}%\n";
+  open << "\\dimen100=\\ht100\n";
+  open << "\\advance\\dimen100 by \\dp100\n";
+  open << "\\renewcommand{\\ }{\\hspace*{0.5em}}%\n";
+  open << "\\definecolor{R}{named}{Red}%\n";
+  open << "\\definecolor{G}{named}{ForestGreen}%\n";
+  open << "\\definecolor{B}{named}{Cerulean}%\n";
+  open << "\\definecolor{C}{named}{Cyan}%\n";
+  open << "\\definecolor{M}{named}{Magenta}%\n";
+  open << "\\definecolor{Y}{named}{YellowOrange}%\n";
 
-        // back to previous context
-        context = COLORCODE;
-      }
-    }
+  // use background color (\colorbox)
+  if (m_bgcolor)
+  {
+    open << "\\definecolor{background}{rgb}{0.82,0.82,0.92}%\n";
+    open << "\\dimen200=\\linewidth\n";
+    open << "\\advance\\dimen200 by -2\\fboxsep\n";
+    open << "\\colorbox{background}%\n";
+    open << "{%\n";
+    open << "\\parbox{\\dimen200}%\n";
+    open << "{%\n";
+  }
+
+  // no background color
+  else
+  {
+    open << "\\parbox{\\linewidth}%\n";
+    open << "{%\n";
+  }
+
+  // always close \parbox
+  close << "}% <-- parbox\n";
+
+  // close \colorbox
+  if (m_bgcolor)
+  {
+    close << "}% <-- colorbox\n";
   }
 
-  // check final state
-  return (context == PLAINCODE);
+  // always close LaTeX group
+  close << "\\endgroup\n";
 }
 
 // ---------
@@ -566,61 +1427,59 @@ bool LaTeXGenerator::parseLine()
 /*
  *
  */
-string LaTeXGenerator::translate(char c) const
-{
-  // translate these characters
-  switch(c) 
-  {
-    case    0:
-    case    1:
-    case    2:
-    case    3:
-    case    4:
-    case    5:
-    case    6:
-    case    7:
-    case    8: return "[CTRL]";
-    case    9: return "\\ \\ ";
-    case   10:
-    case   11:
-    case   12:
-    case   13:
-    case   14:
-    case   15:
-    case   16:
-    case   17:
-    case   18:
-    case   19:
-    case   20:
-    case   21:
-    case   22:
-    case   23:
-    case   24:
-    case   25:
-    case   26:
-    case   27:
-    case   28:
-    case   29:
-    case   30:
-    case   31: return "[CTRL]";
-    case '\\': return "\\textbackslash{}";
-    case  '~': return "\\textasciitilde{}";
-    case  '"': return "\\grqq{}";
-    case  '^': return "\\^{}";
-    case  '{': return "\\{";
-    case  '}': return "\\}";
-    case  '&': return "\\&";
-    case  '$': return "\\$";
-    case  '%': return "\\%";
-    case  '#': return "\\#";
-    case  '_': return "\\_";
-    case  '-': return "-{}";
-    case  '<': return "<{}";
-    case  '>': return ">{}";
-    case  ' ': return "\\ ";
-  }
-
-  // identity map
-  return string(1, c);
+void LaTeXGenerator::translate(char c, string& out) const
+{
+  // look up LaTeX code
+  const Escape& e = ESCAPE[static_cast<unsigned char>(c)];
+
+  out.append(e.text, e.size);
 }
 
+// ---------------
+// translateSpaces
+// ---------------
+/*
+ * A space is half an em wide and a tab is one em wide (just like \ and
+ * \ \ ), so the columns stay where they are.  Single spaces are left as
+ * they are, because \hspace* would be longer.
+ */
+const char* LaTeXGenerator::translateSpaces(const char* first, const char* end, string& out) const
+{
+  // the width of the run in half ems
+  unsigned halves = 0;
+
+  const char* p = first;
+
+  for(; p != end; p++)
+  {
+    if      (*p == ' ')  halves += 1;
+    else if (*p == '\t') halves += 2;
+    else break;
+  }
+
+  if (halves == 1)
+  {
+    out += "\\ ";
+
+    return p;
+  }
+
+  // convert ems to digits
+  char     digits[16];
+  unsigned count = 0;
+
+  for(unsigned ems = halves / 2; (ems > 0) || (count == 0); ems /= 10)
+  {
+    digits[count++] = static_cast<char>('0' + ems % 10);
+  }
+
+  out += "\\hspace*{";
+
+  while (count > 0) out += digits[--count];
+
+  if (halves % 2) out += ".5";
+
+  out += "em}";
+
+  return p;
+}
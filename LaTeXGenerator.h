@@ -19,7 +19,24 @@
 // -----------------------------------------------------------------------------
 // Includes                                                             Includes
 // -----------------------------------------------------------------------------
+#include <cstddef>
 #include <string>
+#include <vector>
+#include "ByteScanner.h"
+#include "InputReader.h"
+#include "KeywordMatcher.h"
+#include "LineMemo.h"
+#include "MarkupChecker.h"
+#include "OutputBuffer.h"
+#include "RenderStats.h"
+#include "SpanLexer.h"
+#include "SyntaxHighlighter.h"
+
+
+// -----------------------------------------------------------------------------
+// Declarations                                                     Declarations
+// -----------------------------------------------------------------------------
+class SpanEmitter;
 
 
 // --------------
@@ -58,6 +75,28 @@ public:
    */
   void setSyntaxCharacter(char trigger);
 
+  // -----------
+  // setLanguage
+  // -----------
+  /**
+   * @brief  This method selects the language colored by the built-in
+   *         highlighter (none by default).
+   *
+   * @return  false if the language is unknown
+   */
+  bool setLanguage(const std::string& name);
+
+  // -----------
+  // setKeywords
+  // -----------
+  /**
+   * @brief  This method attaches a keyword list (0 detaches it).
+   *
+   * The list is shared by all copies of the generator, so it must not
+   * change while they are in use.
+   */
+  void setKeywords(const KeywordMatcher* keywords);
+
   // ---------------------
   // enableBackgroundColor
   // ---------------------
@@ -74,6 +113,32 @@ public:
    */
   void enableDocument(bool flag);
 
+  // -----------------
+  // enableInteractive
+  // -----------------
+  /**
+   * @brief  This method defines whether to flush the output after each paragraph.
+   */
+  void enableInteractive(bool flag);
+
+  // -------------
+  // enableCompact
+  // -------------
+  /**
+   * @brief  This method defines whether to define the colors and the
+   *         paragraph layout once instead of in each paragraph.
+   */
+  void enableCompact(bool flag);
+
+  // -------------------
+  // enableCompactSpaces
+  // -------------------
+  /**
+   * @brief  This method defines whether to collapse each run of spaces
+   *         and tabs into a single \\hspace* command.
+   */
+  void enableCompactSpaces(bool flag);
+
   // ----------------
   // setMaxLinesFirst
   // ----------------
@@ -90,18 +155,149 @@ public:
    */
   void setMaxLinesEach(unsigned max);
 
+  // --------
+  // setStats
+  // --------
+  /**
+   * @brief  This method attaches counters (0 detaches them).
+   *
+   * Copies of the generator share the counters, so each thread needs
+   * its own ones (see RenderStats).
+   */
+  void setStats(RenderStats* stats);
+
+  // -------------
+  // enableRecover
+  // -------------
+  /**
+   * @brief  This method defines whether a line with incomplete markup
+   *         is displayed as plain code instead of stopping the parser.
+   *
+   * Either way, each rejected line is added to problems().
+   */
+  void enableRecover(bool flag);
+
+  // -------
+  // setMemo
+  // -------
+  /**
+   * @brief  This method attaches a memo that reuses the code of repeated
+   *         lines (0 detaches it).
+   *
+   * Just like the counters, copies of the generator share the memo, so
+   * each thread needs its own one.  The memo isn't used while plain code
+   * is colored by setLanguage(), since the colors depend on the lines
+   * before.
+   */
+  void setMemo(LineMemo* memo);
+
 
   // ---------------------------------------------------------------------------
   // Handling                                                           Handling
   // ---------------------------------------------------------------------------
 
+  // ---------
+  // signature
+  // ---------
+  /**
+   * @brief  This method describes all settings that affect the output.
+   *
+   * Two generators with the same signature produce the same code for
+   * the same input.  The signature includes a format version that
+   * changes whenever the generated code changes.
+   */
+  std::string signature() const;
+
+  // -----
+  // stats
+  // -----
+  /**
+   * @brief  This method returns the attached counters (if any).
+   */
+  RenderStats* stats() const;
+
+  // ----
+  // memo
+  // ----
+  /**
+   * @brief  This method returns the attached memo (0 if none).
+   */
+  LineMemo* memo() const;
+
+  // --------
+  // problems
+  // --------
+  /**
+   * @brief  This method returns the lines rejected by the recent parse()
+   *         (at most one unless recovering).
+   */
+  const std::vector<MarkupChecker::Problem>& problems() const;
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the given characters into a string.
+   *
+   * @param data     points to the first character to render.
+   * @param size     holds the number of characters to render.
+   * @param out      receives the generated LaTeX code.
+   * @param threads  holds the number of threads (see parse()).
+   *
+   * The characters are not copied.  The string is cleared first, so a
+   * caller that passes the same string again keeps its capacity.
+   */
+  bool render(const char* data, std::size_t size, std::string& out, unsigned threads = 1);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the given characters into a sink.
+   */
+  bool render(const char* data, std::size_t size, OutputSink& sink, unsigned threads = 1);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the given input stream into a sink.
+   */
+  bool render(std::istream& in, OutputSink& sink, unsigned threads = 1);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the given file descriptor into a sink.
+   *
+   * The file descriptor is not closed.
+   */
+  bool render(int fd, OutputSink& sink, unsigned threads = 1);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the remaining lines of a reader into a sink.
+   */
+  bool render(InputReader& reader, OutputSink& sink, unsigned threads = 1);
+
   // -----
   // parse
   // -----
   /**
-   * @brief  This method parses the code from stdin.
+   * @brief  This method parses the code from the given reader.
+   *
+   * @param reader   delivers the lines to parse.
+   * @param out      receives the generated LaTeX code.
+   * @param threads  holds the number of threads.
+   *
+   * If more than one thread is requested and the paragraphs are limited
+   * by setMaxLinesEach(), the paragraphs are rendered in parallel.  The
+   * generated code doesn't depend on the number of threads.
    */
-  bool parse();
+  bool parse(InputReader& reader, OutputBuffer& out, unsigned threads = 1);
 
 
 protected:
@@ -116,7 +312,7 @@ protected:
   /**
    * @brief  This method starts a complete LaTeX file.
    */
-  void openDocument() const;
+  void openDocument(OutputBuffer& out) const;
 
   // -------------
   // closeDocument
@@ -124,7 +320,7 @@ protected:
   /**
    * @brief  This method finishes a complete LaTeX file.
    */
-  void closeDocument() const;
+  void closeDocument(OutputBuffer& out) const;
 
   // ---------
   // openGroup
@@ -132,7 +328,7 @@ protected:
   /**
    * @brief  This method starts a colored paragraph.
    */
-  void openGroup() const;
+  void openGroup(OutputBuffer& out) const;
 
   // ----------
   // closeGroup
@@ -140,35 +336,258 @@ protected:
   /**
    * @brief  This method finishes a colored paragraph.
    */
-  void closeGroup() const;
+  void closeGroup(OutputBuffer& out) const;
 
-  // --------
-  // readLine
-  // --------
+  // -----------
+  // setupGroups
+  // -----------
+  /**
+   * @brief  This method defines the \\parcolorgroup macro used by each
+   *         paragraph in compact mode (the colors are local to it).
+   */
+  void setupGroups(OutputBuffer& out) const;
+
+  // ----------
+  // openOutput
+  // ----------
+  /**
+   * @brief  This method writes everything in front of the first line.
+   */
+  void openOutput(OutputBuffer& out) const;
+
+  // -----------
+  // closeOutput
+  // -----------
+  /**
+   * @brief  This method writes everything behind the last line.
+   *
+   * @param lpp  holds the number of lines in the recent paragraph.
+   * @param out  receives the generated LaTeX code.
+   */
+  void closeOutput(unsigned lpp, OutputBuffer& out) const;
+
+  // ----------
+  // appendLine
+  // ----------
+  /**
+   * @brief  This method writes the code of the recently parsed line
+   *         and starts a new paragraph if the recent one is full.
+   *
+   * @param line     points to the first character of the parsed line.
+   * @param size     holds the number of characters in the parsed line.
+   * @param lpp      holds the number of lines in the recent paragraph.
+   * @param initial  holds whether the recent paragraph is the initial one.
+   * @param out      receives the generated LaTeX code.
+   */
+  void appendLine(const char* line, std::size_t size, unsigned& lpp, bool& initial, OutputBuffer& out);
+
+  // ---------
+  // startLine
+  // ---------
+  /**
+   * @brief  This method starts a new paragraph if the recent one is full
+   *         and breaks the recent line (see appendLine()).
+   *
+   * While the spans are passed to other formats, the paragraphs are only
+   * counted (for the counters).
+   */
+  void startLine(unsigned& lpp, bool& initial, OutputBuffer& out) const;
+
+  // ----------
+  // parseLines
+  // ----------
+  /**
+   * @brief  This method renders all lines of the given reader.
+   *
+   * @param reader   delivers the lines to parse.
+   * @param lpp      holds the number of lines in the recent paragraph.
+   * @param initial  holds whether the recent paragraph is the initial one.
+   * @param out      receives the generated LaTeX code.
+   */
+  bool parseLines(InputReader& reader, unsigned& lpp, bool& initial, OutputBuffer& out);
+
+  // -------------
+  // parseLongLine
+  // -------------
+  /**
+   * @brief  This method renders a line part by part (see InputReader::readPart()).
+   *
+   * The code of each part is written before the next one is read, so
+   * the memory needed doesn't grow with the length of the line.
+   *
+   * @param reader   delivers the remaining parts.
+   * @param part     points to the first part.
+   * @param size     holds the number of characters in the first part.
+   * @param lpp      holds the number of lines in the recent paragraph.
+   * @param initial  holds whether the recent paragraph is the initial one.
+   * @param out      receives the generated LaTeX code.
+   */
+  bool parseLongLine(InputReader& reader, const char* part, std::size_t size, unsigned& lpp, bool& initial, OutputBuffer& out);
+
+  // -------------
+  // parseParallel
+  // -------------
+  /**
+   * @brief  This method renders the paragraphs on several threads.
+   */
+  bool parseParallel(InputReader& reader, OutputBuffer& out, unsigned threads, unsigned& lpp);
+
+  // -----------
+  // recoverLine
+  // -----------
   /**
-   * @brief  This method extracts one line from stdin.
+   * @brief  This method adds a line rejected by parseLine() to problems()
+   *         and creates the code that displays it as plain code.
+   *
+   * @return  false if not recovering
    */
-  bool readLine();
+  bool recoverLine(const char* line, std::size_t size);
 
   // ---------
   // parseLine
   // ---------
   /**
    * @brief  This method creates the LaTeX code that displays the extracted line.
+   *
+   * @param line  points to the first character of the extracted line.
+   * @param size  holds the number of characters in the extracted line.
    */
-  bool parseLine();
+  bool parseLine(const char* line, std::size_t size)
+  {
+    // incomplete markup
+    if ( !m_lexer.lex(line, size, m_spans) ) return false;
+
+    // color plain code
+    if (m_highlighter.language() != SyntaxHighlighter::NONE) m_highlighter.highlight(line, m_spans);
+
+    // color listed keywords
+    if (m_keywords != 0)
+    {
+      m_keywords->highlight(line, m_spans, m_matched);
+
+      m_spans.swap(m_matched);
+    }
+
+    emitLine(line, size, m_spans);
+
+    return true;
+  }
+
+  // ------
+  // parsed
+  // ------
+  /**
+   * @brief  This method returns the code created by the recent parseLine().
+   */
+  const std::string& parsed() const
+  {
+    return m_parsed;
+  }
+
+  // --------
+  // emitLine
+  // --------
+  /**
+   * @brief  This method translates the spans of the extracted line.
+   *
+   * @param line   points to the first character of the extracted line.
+   * @param size   holds the number of characters in the extracted line.
+   * @param spans  holds the spans of the extracted line.
+   */
+  void emitLine(const char* line, std::size_t size, const std::vector<SpanLexer::Span>& spans);
+
+  // ---------
+  // emitSpans
+  // ---------
+  /**
+   * @brief  This method translates the spans of a line or of a part of it.
+   *
+   * @param line        points to the first character of the line (or part).
+   * @param spans       holds the spans (see SpanLexer::lexPart()).
+   * @param continued   set true if the first span continues a color name.
+   * @param unfinished  set true if the last span is an unfinished color name.
+   */
+  void emitSpans(const char* line, const std::vector<SpanLexer::Span>& spans, bool continued, bool unfinished);
+
+  // --------
+  // emitText
+  // --------
+  /**
+   * @brief  This method translates a plain or colored span.
+   *
+   * @param first  points to the first character of the span.
+   * @param end    points behind the last character of the span.
+   */
+  void emitText(const char* first, const char* end);
+
+  // ---------
+  // countText
+  // ---------
+  /**
+   * @brief  This method counts the displayed characters of the given spans
+   *         (triggers and color names aren't displayed).
+   *
+   * @param line   points to the first character of the line (or part).
+   * @param spans  holds the spans (see SpanLexer::lexPart()).
+   */
+  void countText(const char* line, const std::vector<SpanLexer::Span>& spans) const;
+
+  // -------------
+  // updateScanner
+  // -------------
+  /**
+   * @brief  This method collects the characters that stop a run of plain code.
+   */
+  void updateScanner();
+
+  // ------------
+  // updateGroups
+  // ------------
+  /**
+   * @brief  This method creates the code that opens and closes a paragraph.
+   */
+  void updateGroups();
 
   // ---------
   // translate
   // ---------
   /**
-   * @brief  This method translates the given character to printable LaTeX code.
+   * @brief  This method appends the printable LaTeX code of the given character.
+   *
+   * @param c    holds the character to translate.
+   * @param out  receives the LaTeX code.
    */
-  std::string translate(char c) const;
+  void translate(char c, std::string& out) const;
+
+  // ---------------
+  // translateSpaces
+  // ---------------
+  /**
+   * @brief  This method translates a run of spaces and tabs.
+   *
+   * @param first  points to the first space or tab of the run.
+   * @param end    points behind the last character of the line.
+   * @param out    receives the LaTeX code.
+   *
+   * @return  the first character behind the run
+   */
+  const char* translateSpaces(const char* first, const char* end, std::string& out) const;
 
 
 private:
 
+  // renders paragraphs on behalf of parseParallel()
+  friend class ParagraphTask;
+
+  // renders the changed blocks only
+  friend class IncrementalRenderer;
+
+  // renders the spans shared with other formats
+  friend class LaTeXEmitter;
+
+  // passes the settings to all formats and the spans of its lines
+  friend class MultiRenderer;
+
   // ---------------------------------------------------------------------------
   // Attributes                                                       Attributes
   // ---------------------------------------------------------------------------
@@ -182,23 +601,65 @@ private:
   /// create complete tex file or not
   bool m_document;
 
+  /// flush output after each paragraph or not
+  bool m_flush;
+
+  /// define colors and paragraph layout only once
+  bool m_compact;
+
+  /// collapse runs of spaces and tabs
+  bool m_spaces;
+
   /// maximum number of lines in the initial paragraph
   unsigned m_maxFirst;
 
   /// maximum number of lines in each paragraph
   unsigned m_maxEach;
 
-  /// the currently extracted line
-  std::string m_line;
+  /// splits each line into spans
+  SpanLexer m_lexer;
+
+  /// the spans of the currently parsed line
+  std::vector<SpanLexer::Span> m_spans;
+
+  /// colors the plain code (if a language is selected)
+  SyntaxHighlighter m_highlighter;
+
+  /// colors the listed keywords (if any)
+  const KeywordMatcher* m_keywords;
+
+  /// the spans of the currently parsed line with the keywords colored
+  std::vector<SpanLexer::Span> m_matched;
+
+  /// finds all characters that need escaping
+  ByteScanner m_special;
 
   /// the currently parsed line
   std::string m_parsed;
 
-  /// the currently extracted character
-  char m_cc;
+  /// the code that opens a paragraph (see updateGroups())
+  std::string m_openGroup;
+
+  /// the code that closes a paragraph
+  std::string m_closeGroup;
+
+  /// the counters (if any)
+  RenderStats* m_stats;
+
+  /// display lines with incomplete markup as plain code
+  bool m_recover;
+
+  /// the number of lines read so far
+  std::size_t m_line;
+
+  /// the rejected lines
+  std::vector<MarkupChecker::Problem> m_problems;
+
+  /// the code of recent lines (if any)
+  LineMemo* m_memo;
 
-  /// the recently extracted character
-  char m_rc;
+  /// receives the spans instead of the LaTeX code (see MultiRenderer)
+  SpanEmitter* m_emitter;
 
 };
 
@@ -0,0 +1,425 @@
+// -----------------------------------------------------------------------------
+// LineMemo.cpp                                                     LineMemo.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref LineMemo class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>  /* memcpy(), memcmp() */
+#include <sstream>
+#include "message.h"
+#include "LineMemo.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the number of buckets of an empty memo
+static const size_t BUCKETS = 1024;
+
+/// the bytes used by an entry apart from its characters
+static const size_t OVERHEAD = 64;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// --------
+// hashLine
+// --------
+/**
+ * @brief  This function returns a 64 bit hash of a line.
+ *
+ * The line is consumed 8 bytes at a time, so hashing costs much less
+ * than generating the code (unlike the bytewise FNV-1a of RenderCache).
+ */
+static uint64_t hashLine(const char* line, size_t size)
+{
+  const uint64_t PRIME = 11400714819323198485UL;
+
+  uint64_t hash = size * PRIME;
+
+  while (size >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, line, 8);
+
+    hash  = (hash ^ word) * PRIME;
+    hash ^= hash >> 29;
+
+    line += 8;
+    size -= 8;
+  }
+
+  // remaining bytes
+  uint64_t word = 0;
+
+  for(size_t i = 0; i < size; i++)
+  {
+    word = (word << 8) | static_cast<unsigned char>(line[i]);
+  }
+
+  hash  = (hash ^ word) * PRIME;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// --------
+// LineMemo
+// --------
+/*
+ *
+ */
+LineMemo::LineMemo(size_t limit)
+{
+  m_limit   = limit;
+  m_used    = 0;
+  m_hand    = 0;
+  m_missed  = 0;
+  m_fresh   = 0;
+  m_hits    = 0;
+  m_misses  = 0;
+  m_stored  = 0;
+  m_evicted = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// ----------
+// setContext
+// ----------
+/*
+ *
+ */
+void LineMemo::setContext(const string& signature)
+{
+  if (signature == m_context) return;
+
+  clear();
+
+  m_context = signature;
+}
+
+// -----
+// clear
+// -----
+/*
+ * The memory is released, so a memo that has done its job costs nothing.
+ */
+void LineMemo::clear()
+{
+  vector<uint32_t>().swap(m_buckets);
+  deque<Entry>().swap(m_entries);
+  vector<uint32_t>().swap(m_free);
+  vector<uint64_t>().swap(m_seen);
+
+  m_used  = 0;
+  m_hand  = 0;
+  m_fresh = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ------
+// recall
+// ------
+/*
+ *
+ */
+bool LineMemo::recall(const char* line, size_t size, string& code, size_t& spans)
+{
+  m_missed = hashLine(line, size);
+
+  uint32_t found = m_buckets.empty() ? 0 : find(line, size, m_missed);
+
+  if (found == 0)
+  {
+    m_misses += 1;
+
+    return false;
+  }
+
+  Entry& entry = m_entries[found - 1];
+
+  entry.referenced = true;
+
+  code.assign(entry.code);
+
+  spans = entry.spans;
+
+  m_hits += 1;
+
+  return true;
+}
+
+// -----
+// store
+// -----
+/*
+ * A line that is stored has just been missed by recall(), so there is
+ * no need to look for it again (nor to hash it).
+ */
+void LineMemo::store(const char* line, size_t size, const string& code, size_t spans)
+{
+  size_t cost = size + code.size() + OVERHEAD;
+
+  if ((size > MAXLINE) || (cost > m_limit)) return;
+
+  uint64_t hash = m_missed;
+
+  // admit lines seen before
+  if ( !seen(hash) ) return;
+
+  // make room
+  while (m_used + cost > m_limit)
+  {
+    m_free.push_back( evict() );
+  }
+
+  if ( m_buckets.empty() ) m_buckets.assign(BUCKETS, 0);
+
+  // reuse a removed entry
+  uint32_t index;
+
+  if ( m_free.empty() )
+  {
+    index = m_entries.size();
+
+    m_entries.push_back( Entry() );
+  }
+
+  else
+  {
+    index = m_free.back();
+
+    m_free.pop_back();
+  }
+
+  Entry& entry = m_entries[index];
+
+  entry.hash = hash;
+  entry.line.assign(line, size);
+  entry.code       = code;
+  entry.spans      = spans;
+  entry.live       = true;
+  entry.referenced = false;
+
+  // prepend to bucket
+  uint32_t& bucket = m_buckets[entry.hash & (m_buckets.size() - 1)];
+
+  entry.next = bucket;
+  bucket     = index + 1;
+
+  m_used   += cost;
+  m_stored += 1;
+
+  // keep the chains short
+  if (m_entries.size() - m_free.size() > m_buckets.size()) rehash();
+}
+
+// -----
+// merge
+// -----
+/*
+ *
+ */
+void LineMemo::merge(const LineMemo& other)
+{
+  m_hits    += other.m_hits;
+  m_misses  += other.m_misses;
+  m_stored  += other.m_stored;
+  m_evicted += other.m_evicted;
+}
+
+// ------
+// report
+// ------
+/*
+ *
+ */
+void LineMemo::report() const
+{
+  uint64_t looked = m_hits + m_misses;
+
+  ostringstream line;
+
+  line << "memo: " << m_hits    << " hits, "
+                   << m_misses  << " misses, "
+                   << m_stored  << " stored, "
+                   << m_evicted << " evicted";
+
+  // the share of lines that weren't generated again
+  if (looked > 0) line << " (" << (100 * m_hits / looked) << "% hit rate)";
+
+  // notify user
+  msg::nfo( line.str() );
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ----
+// find
+// ----
+/*
+ *
+ */
+uint32_t LineMemo::find(const char* line, size_t size, uint64_t hash) const
+{
+  uint32_t next = m_buckets[hash & (m_buckets.size() - 1)];
+
+  while (next != 0)
+  {
+    const Entry& entry = m_entries[next - 1];
+
+    if ((entry.hash == hash) && (entry.line.size() == size) && (memcmp(entry.line.data(), line, size) == 0)) return next;
+
+    next = entry.next;
+  }
+
+  return 0;
+}
+
+// ----
+// seen
+// ----
+/*
+ * A line that shares both bits with others may be taken for one seen
+ * before, which merely stores it early.  Once the filter holds as many
+ * lines as could be stored, it starts over so that it doesn't fill up.
+ */
+bool LineMemo::seen(uint64_t hash)
+{
+  if ( m_seen.empty() )
+  {
+    size_t words = 64;
+
+    while (words * 512 < m_limit) words *= 2;
+
+    m_seen.assign(words, 0);
+  }
+
+  size_t   bits   = 64 * m_seen.size();
+  uint64_t first  = hash & (bits - 1);
+  uint64_t second = (hash >> 32) & (bits - 1);
+  uint64_t one    = 1;
+
+  uint64_t& a = m_seen[first  / 64];
+  uint64_t& b = m_seen[second / 64];
+
+  if ((a & (one << (first % 64))) && (b & (one << (second % 64)))) return true;
+
+  a |= one << (first  % 64);
+  b |= one << (second % 64);
+
+  m_fresh += 1;
+
+  if (m_fresh > bits / 8)
+  {
+    m_seen.assign(m_seen.size(), 0);
+
+    m_fresh = 0;
+  }
+
+  return false;
+}
+
+// -----
+// evict
+// -----
+/*
+ * Each entry hit since the recent sweep gets a second chance, so the
+ * hand passes each entry at most twice.  The caller makes sure that
+ * there is at least one entry.
+ */
+uint32_t LineMemo::evict()
+{
+  while (true)
+  {
+    if (m_hand >= m_entries.size()) m_hand = 0;
+
+    Entry& entry = m_entries[m_hand++];
+
+    if ( !entry.live ) continue;
+
+    if ( entry.referenced )
+    {
+      entry.referenced = false;
+
+      continue;
+    }
+
+    uint32_t index = m_hand - 1;
+
+    // unlink from bucket
+    uint32_t* link = &m_buckets[entry.hash & (m_buckets.size() - 1)];
+
+    while (*link != index + 1) link = &m_entries[*link - 1].next;
+
+    *link = entry.next;
+
+    m_used -= entry.line.size() + entry.code.size() + OVERHEAD;
+
+    // release characters
+    string().swap(entry.line);
+    string().swap(entry.code);
+
+    entry.live = false;
+
+    m_evicted += 1;
+
+    return index;
+  }
+}
+
+// ------
+// rehash
+// ------
+/*
+ *
+ */
+void LineMemo::rehash()
+{
+  m_buckets.assign(2 * m_buckets.size(), 0);
+
+  for(uint32_t i = 0; i < m_entries.size(); i++)
+  {
+    Entry& entry = m_entries[i];
+
+    if ( !entry.live ) continue;
+
+    uint32_t& bucket = m_buckets[entry.hash & (m_buckets.size() - 1)];
+
+    entry.next = bucket;
+    bucket     = i + 1;
+  }
+}
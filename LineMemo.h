@@ -0,0 +1,271 @@
+// -----------------------------------------------------------------------------
+// LineMemo.h                                                         LineMemo.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref LineMemo class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef LINEMEMO_H_INCLUDE_NO1
+#define LINEMEMO_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <stdint.h>  /* uint32_t, uint64_t */
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+// --------
+// LineMemo
+// --------
+/**
+ * @brief  This class remembers the generated code of recent lines.
+ *
+ * Logs and generated code repeat the same lines over and over, so the
+ * code of a line that has been seen before is looked up instead of being
+ * generated again.  The lines are kept in a hash table in memory that
+ * doesn't grow beyond its limit: when a new line doesn't fit, the
+ * entries not hit since the recent sweep are removed (CLOCK eviction).
+ * A line is only stored when it comes up the second time, so lines
+ * that never repeat cost little more than their hash.  The filter that
+ * tells them apart takes 1/64 of the limit.
+ *
+ * The code depends on the generator's settings, so all entries are
+ * forgotten when another signature is set (see setContext()).  A memo
+ * must not be shared by threads; each thread uses its own one and
+ * merge() adds up the counters.
+ */
+class LineMemo
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Settings                                                           Settings
+  // ---------------------------------------------------------------------------
+
+  /// longer lines are never remembered
+  static const std::size_t MAXLINE = 1024;
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // --------
+  // LineMemo
+  // --------
+  /**
+   * @brief  The constructor.
+   *
+   * @param limit  holds the maximum number of bytes used by all entries
+   *               (0 means nothing is remembered).
+   */
+  explicit LineMemo(std::size_t limit = 0);
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ----------
+  // setContext
+  // ----------
+  /**
+   * @brief  This method forgets all lines unless the signature of the
+   *         generator's settings is the recent one.
+   */
+  void setContext(const std::string& signature);
+
+  // -----
+  // clear
+  // -----
+  /**
+   * @brief  This method forgets all lines (the counters are kept).
+   */
+  void clear();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // limit
+  // -----
+  /**
+   * @brief  This method returns the maximum number of bytes used.
+   */
+  std::size_t limit() const
+  {
+    return m_limit;
+  }
+
+  // ------
+  // recall
+  // ------
+  /**
+   * @brief  This method looks up the code of a line.
+   *
+   * @param line   points to the first character of the line.
+   * @param size   holds the number of characters in the line.
+   * @param code   receives the code of the line.
+   * @param spans  receives the number of highlighted sequences.
+   *
+   * @return  false if the line isn't remembered
+   */
+  bool recall(const char* line, std::size_t size, std::string& code, std::size_t& spans);
+
+  // -----
+  // store
+  // -----
+  /**
+   * @brief  This method remembers the code of a line (unless the line is
+   *         too long, the limit too small or the line new).
+   *
+   * The line must be the one just missed by recall().
+   */
+  void store(const char* line, std::size_t size, const std::string& code, std::size_t spans);
+
+  // -----
+  // merge
+  // -----
+  /**
+   * @brief  This method adds the counters of another memo.
+   */
+  void merge(const LineMemo& other);
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method prints the counters via stderr.
+   */
+  void report() const;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // find
+  // ----
+  /**
+   * @brief  This method returns the entry of a line plus one (0 if none).
+   */
+  uint32_t find(const char* line, std::size_t size, uint64_t hash) const;
+
+  // ----
+  // seen
+  // ----
+  /**
+   * @brief  This method tells whether a line has been seen before (and
+   *         marks it as seen).
+   */
+  bool seen(uint64_t hash);
+
+  // -----
+  // evict
+  // -----
+  /**
+   * @brief  This method removes the next entry not hit since the recent
+   *         sweep and returns its index.
+   */
+  uint32_t evict();
+
+  // ------
+  // rehash
+  // ------
+  /**
+   * @brief  This method doubles the number of buckets.
+   */
+  void rehash();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // Entry
+  // -----
+  /**
+   * @brief  A remembered line.
+   */
+  struct Entry
+  {
+    uint64_t    hash;        ///< the hash of the line
+    std::string line;        ///< the characters of the line
+    std::string code;        ///< the generated code
+    std::size_t spans;       ///< the number of highlighted sequences
+    uint32_t    next;        ///< the next entry in the bucket plus one (0 if none)
+    bool        live;        ///< the entry is in use
+    bool        referenced;  ///< the entry has been hit since the recent sweep
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the maximum number of bytes used by all entries
+  std::size_t m_limit;
+
+  /// the number of bytes used by all entries
+  std::size_t m_used;
+
+  /// the signature of the generator's settings
+  std::string m_context;
+
+  /// the first entry of each bucket plus one (0 if none)
+  std::vector<uint32_t> m_buckets;
+
+  /// all entries (removed ones are reused, growing never copies them)
+  std::deque<Entry> m_entries;
+
+  /// the removed entries
+  std::vector<uint32_t> m_free;
+
+  /// the lines seen once (a Bloom filter of two bits per line)
+  std::vector<uint64_t> m_seen;
+
+  /// the number of lines added to the filter since it was empty
+  std::size_t m_fresh;
+
+  /// the next entry looked at by evict()
+  uint32_t m_hand;
+
+  /// the hash of the line recently missed by recall()
+  uint64_t m_missed;
+
+  /// the number of lines found
+  uint64_t m_hits;
+
+  /// the number of lines not found
+  uint64_t m_misses;
+
+  /// the number of lines added
+  uint64_t m_stored;
+
+  /// the number of lines removed
+  uint64_t m_evicted;
+
+};
+
+#endif  /* #ifndef LINEMEMO_H_INCLUDE_NO1 */
@@ -0,0 +1,391 @@
+// -----------------------------------------------------------------------------
+// MarkupChecker.cpp                                           MarkupChecker.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref MarkupChecker class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <sstream>
+#include "message.h"
+#include "MarkupChecker.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+/// the position within a line
+enum State
+{
+  TEXT,     ///< outside of a trigger or a color name
+  PENDING,  ///< right behind a trigger
+  BLANKS,   ///< behind a trigger and some spaces or tabs
+  NAMING    ///< within a color name
+};
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ----------
+// addProblem
+// ----------
+/**
+ * @brief  This function appends a rejected line.
+ */
+static void addProblem(vector<MarkupChecker::Problem>& problems, size_t line, size_t column, MarkupChecker::Reason reason, bool colored, const string& color)
+{
+  MarkupChecker::Problem problem;
+
+  problem.line    = line;
+  problem.column  = column;
+  problem.reason  = reason;
+  problem.colored = colored;
+
+  // the color name of a single trigger in plain code is meaningless
+  if (colored || (reason == MarkupChecker::NAME)) problem.color = color;
+
+  // an unfinished name ends with the line, which loses trailing whitespace
+  if (reason == MarkupChecker::NAME)
+  {
+    string::size_type last = problem.color.find_last_not_of(" \t");
+
+    problem.color.erase((last == string::npos) ? 0 : last + 1);
+  }
+
+  problems.push_back(problem);
+}
+
+// -----------
+// appendColor
+// -----------
+/**
+ * @brief  This function appends characters of a color name (as long as
+ *         it's shorter than MarkupChecker::MAXCOLOR).
+ */
+static inline void appendColor(string& color, const char* first, const char* end)
+{
+  size_t room = MarkupChecker::MAXCOLOR - color.size();
+
+  if (static_cast<size_t>(end - first) > room) end = first + room;
+
+  color.append(first, end);
+}
+
+// ----------
+// finishLine
+// ----------
+/**
+ * @brief  This function rejects the line if the markup is incomplete.
+ *
+ * @param trigger  holds the recent trigger (relative to the line).
+ * @param opened   holds the trigger that opened the recent colored
+ *                 sequence (relative to the line).
+ */
+static inline void finishLine(vector<MarkupChecker::Problem>& problems, State state, bool colored, size_t line, size_t trigger, size_t opened, const string& color)
+{
+  if ((state == PENDING) || (state == BLANKS)) addProblem(problems, line, trigger + 1, MarkupChecker::TRIGGER, colored, color);
+
+  else if (state == NAMING) addProblem(problems, line, opened + 1, MarkupChecker::NAME, false, color);
+
+  else if (colored) addProblem(problems, line, opened + 1, MarkupChecker::SEQUENCE, true, color);
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -------------
+// MarkupChecker
+// -------------
+/*
+ *
+ */
+MarkupChecker::MarkupChecker(char trigger)
+{
+  setTrigger(trigger);
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// ----------
+// setTrigger
+// ----------
+/*
+ *
+ */
+void MarkupChecker::setTrigger(char trigger)
+{
+  m_trigger = trigger;
+
+  m_scanner.clear();
+  m_scanner.add(trigger);
+  m_scanner.add('\r');
+  m_scanner.add('\n');
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// -----
+// check
+// -----
+/*
+ * Every way to break the markup shows at the end of the line, so the
+ * state is checked there only.  Trailing spaces and tabs are removed
+ * before lexing, so a trigger that is followed by nothing else turns
+ * into a trigger at the end of the line.
+ */
+bool MarkupChecker::check(InputReader& reader, vector<Problem>& problems) const
+{
+  problems.clear();
+
+  State state   = TEXT;
+  bool  colored = false;
+
+  // the number of the current line
+  size_t line = 1;
+
+  // absolute offsets of the current line, the recent trigger and the
+  // trigger that opened the recent colored sequence
+  size_t lineStart = 0;
+  size_t trigger   = 0;
+  size_t opened    = 0;
+
+  // the absolute offset of the current block
+  size_t offset = 0;
+
+  // the color name of the recent sequence and its first character
+  string      color;
+  const char* name = 0;
+
+  // the current block
+  const char* data;
+  size_t      size;
+
+  while ( reader.readBlock(data, size) )
+  {
+    const char* pos = data;
+    const char* end = data + size;
+
+    // color name of the previous block
+    name = data;
+
+    while (pos != end)
+    {
+      // skip characters without meaning
+      if ((state == TEXT) || (state == NAMING))
+      {
+        pos = m_scanner.find(pos, end);
+
+        if (pos == end) break;
+      }
+
+      else if (state == BLANKS)
+      {
+        while ((pos != end) && ((*pos == ' ') || (*pos == '\t'))) ++pos;
+
+        if (pos == end) break;
+      }
+
+      char c = *pos;
+
+      // end of line
+      if ((c == '\r') || (c == '\n'))
+      {
+        if (state == NAMING) appendColor(color, name, pos);
+
+        finishLine(problems, state, colored, line, trigger - lineStart, opened - lineStart, color);
+
+        state   = TEXT;
+        colored = false;
+
+        line     += 1;
+        lineStart = offset + (pos - data) + 1;
+
+        ++pos;
+
+        continue;
+      }
+
+      switch (state)
+      {
+        case TEXT:
+
+          // another trigger
+          trigger = offset + (pos - data);
+
+          state = PENDING;
+
+          ++pos;
+
+          break;
+
+        case PENDING:
+
+          // double trigger
+          if (c == m_trigger)
+          {
+            if ( !colored )
+            {
+              opened = trigger;
+
+              color.clear();
+
+              name = pos + 1;
+
+              state = NAMING;
+            }
+
+            else
+            {
+              colored = false;
+
+              state = TEXT;
+            }
+
+            ++pos;
+          }
+
+          // single trigger (unless only whitespace follows)
+          else if ((c == ' ') || (c == '\t'))
+          {
+            state = BLANKS;
+
+            ++pos;
+          }
+
+          // single trigger
+          else
+          {
+            state = TEXT;
+
+            ++pos;
+          }
+
+          break;
+
+        case BLANKS:
+
+          // the trigger was a single one (don't skip the current character)
+          state = TEXT;
+
+          break;
+
+        case NAMING:
+
+          // end of color name
+          appendColor(color, name, pos);
+
+          colored = true;
+
+          state = TEXT;
+
+          ++pos;
+
+          break;
+      }
+    }
+
+    // color name continues in the next block
+    if (state == NAMING) appendColor(color, name, end);
+
+    offset += size;
+  }
+
+  // last line without terminator
+  finishLine(problems, state, colored, line, trigger - lineStart, opened - lineStart, color);
+
+  return problems.empty();
+}
+
+// ---------
+// checkLine
+// ---------
+/*
+ *
+ */
+bool MarkupChecker::checkLine(const char* line, size_t size, Problem& problem) const
+{
+  InputReader reader;
+  reader.open(line, size);
+
+  vector<Problem> problems;
+
+  if ( check(reader, problems) ) return true;
+
+  problem = problems[0];
+
+  return false;
+}
+
+// --------
+// describe
+// --------
+/*
+ *
+ */
+string MarkupChecker::describe(const Problem& problem)
+{
+  ostringstream text;
+
+  text << problem.line << ":" << problem.column << ": ";
+
+  switch (problem.reason)
+  {
+    case TRIGGER:  text << "single trigger at end of line"; break;
+    case NAME:     text << "color name not finished";       break;
+    case SEQUENCE: text << "colored sequence not closed";   break;
+  }
+
+  // the state at the end of the line
+  if (problem.reason == NAME) text << " (state NAME";
+  else if (problem.colored)   text << " (state CODE";
+  else                        text << " (state PLAIN";
+
+  if (problem.colored || (problem.reason == NAME)) text << ", color \"" << problem.color << "\"";
+
+  text << ")";
+
+  return text.str();
+}
+
+// ------
+// report
+// ------
+/*
+ *
+ */
+void MarkupChecker::report(const string& name, const vector<Problem>& problems, bool recovered)
+{
+  string prefix = (name == "stdin") ? string("stdin:") : msg::qcat(name, ":");
+
+  for(vector<Problem>::size_type i = 0; i < problems.size(); i++)
+  {
+    string message = msg::cat(prefix, describe(problems[i]));
+
+    // notify user
+    if (recovered) msg::wrn( msg::cat(message, ", rendered as plain code") );
+    else           msg::err(message);
+  }
+}
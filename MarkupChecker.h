@@ -0,0 +1,176 @@
+// -----------------------------------------------------------------------------
+// MarkupChecker.h                                               MarkupChecker.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref MarkupChecker class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef MARKUPCHECKER_H_INCLUDE_NO1
+#define MARKUPCHECKER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ByteScanner.h"
+#include "InputReader.h"
+
+
+// -------------
+// MarkupChecker
+// -------------
+/**
+ * @brief  This class finds the lines with incomplete !!COLOR!CODE!! markup.
+ *
+ * A line is accepted exactly if SpanLexer::lex() accepts it, but no spans
+ * are collected and nothing is translated.  The input isn't even split
+ * into lines: each block is searched for triggers, CRs and LFs at once
+ * (see @ref ByteScanner), and only those characters drive the state.
+ *
+ * The checker is never changed while checking, so all threads may share
+ * the same one.
+ */
+class MarkupChecker
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the reasons why a line is rejected
+  enum Reason
+  {
+    TRIGGER,   ///< a single trigger ends the line
+    NAME,      ///< the color name isn't finished
+    SEQUENCE   ///< the colored sequence isn't closed
+  };
+
+  // -------
+  // Problem
+  // -------
+  /**
+   * @brief  A rejected line.
+   */
+  struct Problem
+  {
+    std::size_t line;     ///< the number of the line (starting with 1)
+    std::size_t column;   ///< the offending trigger (starting with 1)
+    Reason      reason;   ///< what's wrong
+    bool        colored;  ///< the line ended within a colored sequence
+    std::string color;    ///< the color name of that sequence (shortened)
+  };
+
+  /// the maximum number of characters kept of a color name
+  static const std::size_t MAXCOLOR = 32;
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -------------
+  // MarkupChecker
+  // -------------
+  /**
+   * @brief  The constructor.
+   */
+  explicit MarkupChecker(char trigger = '!');
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ----------
+  // setTrigger
+  // ----------
+  /**
+   * @brief  This method sets ! in the !!COLOR!CODE!! sequence.
+   */
+  void setTrigger(char trigger);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // check
+  // -----
+  /**
+   * @brief  This method checks all remaining lines of the reader.
+   *
+   * @param reader    holds the input (see InputReader::readBlock()).
+   * @param problems  receives one entry per rejected line (previous
+   *                  ones are removed).
+   *
+   * @return  false if at least one line has been rejected
+   */
+  bool check(InputReader& reader, std::vector<Problem>& problems) const;
+
+  // ---------
+  // checkLine
+  // ---------
+  /**
+   * @brief  This method checks a single line (without terminator).
+   *
+   * @param line     points to the first character of the line.
+   * @param size     holds the number of characters in the line.
+   * @param problem  receives the reason if the line is rejected (with
+   *                 the line number 1).
+   *
+   * @return  false if the line has been rejected
+   */
+  bool checkLine(const char* line, std::size_t size, Problem& problem) const;
+
+  // --------
+  // describe
+  // --------
+  /**
+   * @brief  This method returns "LINE:COLUMN: REASON (STATE)" for a problem.
+   *
+   * The state names the kind of span (see SpanLexer::Kind) the line ended
+   * in and the color name of the open sequence.
+   */
+  static std::string describe(const Problem& problem);
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method prints each problem of the given input.
+   *
+   * @param name       names the input (quoted unless it's stdin).
+   * @param problems   holds the problems to print.
+   * @param recovered  set true to print warnings instead of errors.
+   */
+  static void report(const std::string& name, const std::vector<Problem>& problems, bool recovered);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the trigger character
+  char m_trigger;
+
+  /// finds the trigger, CR and LF
+  ByteScanner m_scanner;
+
+};
+
+#endif  /* #ifndef MARKUPCHECKER_H_INCLUDE_NO1 */
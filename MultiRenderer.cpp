@@ -0,0 +1,232 @@
+// -----------------------------------------------------------------------------
+// MultiRenderer.cpp                                           MultiRenderer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref MultiRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include "MultiRenderer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -------------
+// MultiRenderer
+// -------------
+/*
+ *
+ */
+MultiRenderer::MultiRenderer(const LaTeXGenerator& generator)
+: m_generator(generator)
+{
+}
+
+// --------------
+// ~MultiRenderer
+// --------------
+/*
+ *
+ */
+MultiRenderer::~MultiRenderer()
+{
+  for(size_t i = 0; i < m_targets.size(); i++)
+  {
+    delete m_targets[i].buffer;
+    delete m_targets[i].counted;
+    delete m_targets[i].sink;
+    delete m_targets[i].emitter;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                                 Initialization
+// -----------------------------------------------------------------------------
+
+// ---
+// add
+// ---
+/*
+ * The lines are counted by the generator that lexes them, the outputs
+ * only count the bytes they write.
+ */
+bool MultiRenderer::add(const string& format, int fd)
+{
+  RenderStats* stats = m_generator.m_stats;
+
+  SpanEmitter* emitter = 0;
+
+  if (format == "latex")
+  {
+    emitter = new LaTeXEmitter(m_generator);
+  }
+
+  else if (format == "html")
+  {
+    emitter = new HTMLEmitter(m_generator.m_bgcolor, m_generator.m_document, m_generator.m_trigger);
+  }
+
+  else if (format == "ansi")
+  {
+    emitter = new ANSIEmitter(m_generator.m_trigger);
+  }
+
+  // unknown format
+  if (emitter == 0) return false;
+
+  Target target;
+
+  target.emitter = emitter;
+  target.sink    = new FdSink(fd);
+  target.counted = (stats != 0) ? new StatsSink(*target.sink, *stats) : 0;
+
+  if (target.counted != 0) target.buffer = new OutputBuffer(*target.counted);
+  else                     target.buffer = new OutputBuffer(*target.sink);
+
+  m_targets.push_back(target);
+
+  // signalize success
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ------
+// render
+// ------
+/*
+ *
+ */
+bool MultiRenderer::render(int fd)
+{
+  InputReader reader;
+  reader.setStats(m_generator.m_stats);
+  reader.open(fd);
+
+  return render(reader);
+}
+
+// ------
+// render
+// ------
+/*
+ * The generator reads, lexes and recovers the lines just like it does
+ * for its own LaTeX code (long lines are passed part by part), but its
+ * own output stays empty.
+ */
+bool MultiRenderer::render(InputReader& reader)
+{
+  string       unused;
+  OutputBuffer out(unused);
+
+  m_generator.m_emitter = this;
+
+  bool success = m_generator.parse(reader, out, 1);
+
+  m_generator.m_emitter = 0;
+
+  // all data has been written or not
+  for(size_t i = 0; success && (i < m_targets.size()); i++)
+  {
+    if ( !m_targets[i].buffer->good() ) success = false;
+  }
+
+  return success;
+}
+
+// --------
+// problems
+// --------
+/*
+ *
+ */
+const vector<MarkupChecker::Problem>& MultiRenderer::problems() const
+{
+  return m_generator.problems();
+}
+
+
+// -----------------------------------------------------------------------------
+// Emitting                                                             Emitting
+// -----------------------------------------------------------------------------
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void MultiRenderer::open(OutputBuffer&)
+{
+  for(size_t i = 0; i < m_targets.size(); i++)
+  {
+    m_targets[i].emitter->open( *m_targets[i].buffer );
+  }
+}
+
+// --------
+// emitPart
+// --------
+/*
+ *
+ */
+void MultiRenderer::emitPart(const char* part, size_t size, const vector<SpanLexer::Span>& spans,
+                             bool continued, bool unfinished, OutputBuffer&)
+{
+  for(size_t i = 0; i < m_targets.size(); i++)
+  {
+    m_targets[i].emitter->emitPart(part, size, spans, continued, unfinished, *m_targets[i].buffer);
+  }
+}
+
+// -------
+// endLine
+// -------
+/*
+ *
+ */
+void MultiRenderer::endLine(OutputBuffer&)
+{
+  for(size_t i = 0; i < m_targets.size(); i++)
+  {
+    m_targets[i].emitter->endLine( *m_targets[i].buffer );
+
+    // line finished
+    if (m_generator.m_flush) m_targets[i].buffer->flush();
+  }
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void MultiRenderer::close(OutputBuffer&)
+{
+  for(size_t i = 0; i < m_targets.size(); i++)
+  {
+    m_targets[i].emitter->close( *m_targets[i].buffer );
+
+    // write remaining data
+    m_targets[i].buffer->flush();
+  }
+}
@@ -0,0 +1,175 @@
+// -----------------------------------------------------------------------------
+// MultiRenderer.h                                               MultiRenderer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref MultiRenderer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef MULTIRENDERER_H_INCLUDE_NO1
+#define MULTIRENDERER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include "InputReader.h"
+#include "LaTeXGenerator.h"
+#include "OutputBuffer.h"
+#include "RenderStats.h"
+#include "SpanEmitter.h"
+
+
+// -------------
+// MultiRenderer
+// -------------
+/**
+ * @brief  This class renders one input into several formats at once.
+ *
+ * Each line is read and lexed once by the LaTeXGenerator, which passes
+ * its spans (or the spans of each part of a long line) to this class
+ * instead of generating LaTeX code.  They are handed on to the
+ * @ref SpanEmitter of each output.  The lines are rendered on a single
+ * thread.  If a line has invalid markup, no output is finished unless
+ * the settings recover (see LaTeXGenerator::enableRecover()).
+ */
+class MultiRenderer : private SpanEmitter
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -------------
+  // MultiRenderer
+  // -------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param generator  holds the settings used for all formats.
+   */
+  explicit MultiRenderer(const LaTeXGenerator& generator);
+
+  // --------------
+  // ~MultiRenderer
+  // --------------
+  /**
+   * @brief  The destructor.
+   */
+  ~MultiRenderer();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // add
+  // ---
+  /**
+   * @brief  This method adds an output.
+   *
+   * @param format  holds the format (latex, html or ansi).
+   * @param fd      holds the file descriptor (not closed by this class).
+   *
+   * @return  false if the format is unknown
+   */
+  bool add(const std::string& format, int fd);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders the given file descriptor into all outputs.
+   *
+   * The file descriptor is not closed.
+   */
+  bool render(int fd);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method renders all lines of the given reader into all outputs.
+   */
+  bool render(InputReader& reader);
+
+  // --------
+  // problems
+  // --------
+  /**
+   * @brief  This method returns the lines rejected by the recent render().
+   */
+  const std::vector<MarkupChecker::Problem>& problems() const;
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Emitting                                                           Emitting
+  // ---------------------------------------------------------------------------
+
+  /// this method opens all outputs
+  void open(OutputBuffer& out);
+
+  /// this method passes a part of a line to all outputs
+  void emitPart(const char* part, std::size_t size, const std::vector<SpanLexer::Span>& spans,
+                bool continued, bool unfinished, OutputBuffer& out);
+
+  /// this method finishes the line in all outputs
+  void endLine(OutputBuffer& out);
+
+  /// this method closes all outputs
+  void close(OutputBuffer& out);
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  // ------
+  // Target
+  // ------
+  /**
+   * @brief  One output and its format.
+   */
+  struct Target
+  {
+    SpanEmitter*  emitter;  ///< creates the code
+    FdSink*       sink;     ///< writes to the file descriptor
+    StatsSink*    counted;  ///< counts the writes (if counters are attached)
+    OutputBuffer* buffer;   ///< collects the code
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the settings (and the lexer of all lines)
+  LaTeXGenerator m_generator;
+
+  /// all outputs
+  std::vector<Target> m_targets;
+
+  // not copyable (the targets are owned)
+  MultiRenderer(const MultiRenderer&);
+  MultiRenderer& operator=(const MultiRenderer&);
+
+};
+
+#endif  /* #ifndef MULTIRENDERER_H_INCLUDE_NO1 */
@@ -0,0 +1,171 @@
+// -----------------------------------------------------------------------------
+// OutputBuffer.cpp                                             OutputBuffer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref OutputBuffer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include "OutputBuffer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the number of bytes collected before the sink is called
+static const size_t BUFFERSIZE = 256 * 1024;
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// ------------
+// OutputBuffer
+// ------------
+/*
+ *
+ */
+OutputBuffer::OutputBuffer(int fd)
+: m_fdSink(fd),
+  m_buffer(BUFFERSIZE)
+{
+  m_sink   = &m_fdSink;
+  m_target = 0;
+  m_used   = 0;
+  m_failed = false;
+}
+
+// ------------
+// OutputBuffer
+// ------------
+/*
+ *
+ */
+OutputBuffer::OutputBuffer(string& target)
+: m_fdSink(-1)
+{
+  m_sink   = 0;
+  m_target = &target;
+  m_used   = 0;
+  m_failed = false;
+}
+
+// ------------
+// OutputBuffer
+// ------------
+/*
+ *
+ */
+OutputBuffer::OutputBuffer(OutputSink& sink)
+: m_fdSink(-1),
+  m_buffer(BUFFERSIZE)
+{
+  m_sink   = &sink;
+  m_target = 0;
+  m_used   = 0;
+  m_failed = false;
+}
+
+// -------------
+// ~OutputBuffer
+// -------------
+/*
+ *
+ */
+OutputBuffer::~OutputBuffer()
+{
+  flush();
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// -----
+// flush
+// -----
+/*
+ *
+ */
+void OutputBuffer::flush()
+{
+  if (m_used > 0)
+  {
+    drain(&m_buffer[0], m_used);
+
+    m_used = 0;
+  }
+}
+
+// ----
+// good
+// ----
+/*
+ *
+ */
+bool OutputBuffer::good() const
+{
+  return !m_failed;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// --------
+// overflow
+// --------
+/*
+ *
+ */
+void OutputBuffer::overflow(const char* data, size_t size)
+{
+  // make room
+  flush();
+
+  // large chunks bypass the buffer
+  if (size >= m_buffer.size())
+  {
+    drain(data, size);
+  }
+
+  else
+  {
+    memcpy(&m_buffer[0], data, size);
+
+    m_used = size;
+  }
+}
+
+// -----
+// drain
+// -----
+/*
+ *
+ */
+void OutputBuffer::drain(const char* data, size_t size)
+{
+  // drop data after the first failure
+  if (m_failed) return;
+
+  if ( !m_sink->write(data, size) )
+  {
+    m_failed = true;
+  }
+}
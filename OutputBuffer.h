@@ -0,0 +1,216 @@
+// -----------------------------------------------------------------------------
+// OutputBuffer.h                                                 OutputBuffer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref OutputBuffer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef OUTPUTBUFFER_H_INCLUDE_NO1
+#define OUTPUTBUFFER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OutputSink.h"
+
+
+// ------------
+// OutputBuffer
+// ------------
+/**
+ * @brief  This class collects the generated code in a large buffer.
+ *
+ * The buffer is handed to the attached sink when it is full or when
+ * flush() is called explicitly.  An attached string receives all data
+ * directly, so a caller that renders into the same string repeatedly
+ * keeps its capacity and no buffer is allocated at all.
+ */
+class OutputBuffer
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ------------
+  // OutputBuffer
+  // ------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param fd  holds the file descriptor that receives the data.
+   */
+  explicit OutputBuffer(int fd);
+
+  // ------------
+  // OutputBuffer
+  // ------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param target  receives the data (appended).
+   */
+  explicit OutputBuffer(std::string& target);
+
+  // ------------
+  // OutputBuffer
+  // ------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param sink  receives the data (must outlive the buffer).
+   */
+  explicit OutputBuffer(OutputSink& sink);
+
+  // -------------
+  // ~OutputBuffer
+  // -------------
+  /**
+   * @brief  The destructor flushes the buffer.
+   */
+  ~OutputBuffer();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // write
+  // -----
+  /**
+   * @brief  This method appends the given characters.
+   */
+  void write(const char* data, std::size_t size)
+  {
+    // append to string
+    if (m_target != 0)
+    {
+      m_target->append(data, size);
+    }
+
+    // fast path
+    else if (size <= m_buffer.size() - m_used)
+    {
+      std::memcpy(&m_buffer[m_used], data, size);
+
+      m_used += size;
+    }
+
+    else
+    {
+      overflow(data, size);
+    }
+  }
+
+  // ----------
+  // operator<<
+  // ----------
+  /**
+   * @brief  This operator appends a null-terminated string.
+   */
+  OutputBuffer& operator<<(const char* text)
+  {
+    write(text, std::strlen(text));
+
+    return *this;
+  }
+
+  // ----------
+  // operator<<
+  // ----------
+  /**
+   * @brief  This operator appends a string.
+   */
+  OutputBuffer& operator<<(const std::string& text)
+  {
+    write(text.data(), text.size());
+
+    return *this;
+  }
+
+  // -----
+  // flush
+  // -----
+  /**
+   * @brief  This method hands all buffered data to the sink.
+   */
+  void flush();
+
+  // ----
+  // good
+  // ----
+  /**
+   * @brief  This method returns false if some data could not be written.
+   */
+  bool good() const;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // --------
+  // overflow
+  // --------
+  /**
+   * @brief  This method handles data that doesn't fit into the buffer.
+   */
+  void overflow(const char* data, std::size_t size);
+
+  // -----
+  // drain
+  // -----
+  /**
+   * @brief  This method passes the given data to the sink.
+   */
+  void drain(const char* data, std::size_t size);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the sink used for a file descriptor
+  FdSink m_fdSink;
+
+  /// the receiving sink
+  OutputSink* m_sink;
+
+  /// the receiving string (if any)
+  std::string* m_target;
+
+  /// the buffered data
+  std::vector<char> m_buffer;
+
+  /// the number of buffered characters
+  std::size_t m_used;
+
+  /// some data could not be written
+  bool m_failed;
+
+  // not copyable
+  OutputBuffer(const OutputBuffer&);
+  OutputBuffer& operator=(const OutputBuffer&);
+
+};
+
+#endif  /* #ifndef OUTPUTBUFFER_H_INCLUDE_NO1 */
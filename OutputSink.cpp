@@ -0,0 +1,141 @@
+// -----------------------------------------------------------------------------
+// OutputSink.cpp                                                 OutputSink.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref OutputSink class
+ *             and its derived classes.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cerrno>
+#include <unistd.h>  /* write() */
+#include "OutputSink.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// OutputSink                                                         OutputSink
+// -----------------------------------------------------------------------------
+
+// -----------
+// ~OutputSink
+// -----------
+/*
+ *
+ */
+OutputSink::~OutputSink()
+{
+}
+
+
+// -----------------------------------------------------------------------------
+// FdSink                                                                 FdSink
+// -----------------------------------------------------------------------------
+
+// ------
+// FdSink
+// ------
+/*
+ *
+ */
+FdSink::FdSink(int fd)
+{
+  m_fd = fd;
+}
+
+// -----
+// write
+// -----
+/*
+ *
+ */
+bool FdSink::write(const char* data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t done = ::write(m_fd, data, size);
+
+    if (done < 0)
+    {
+      // retry interrupted calls
+      if (errno == EINTR) continue;
+
+      // signalize trouble
+      return false;
+    }
+
+    data += done;
+    size -= done;
+  }
+
+  // signalize success
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// StreamSink                                                         StreamSink
+// -----------------------------------------------------------------------------
+
+// ----------
+// StreamSink
+// ----------
+/*
+ *
+ */
+StreamSink::StreamSink(ostream& stream)
+: m_stream(stream)
+{
+}
+
+// -----
+// write
+// -----
+/*
+ *
+ */
+bool StreamSink::write(const char* data, size_t size)
+{
+  m_stream.write(data, size);
+
+  return m_stream.good();
+}
+
+
+// -----------------------------------------------------------------------------
+// CallbackSink                                                     CallbackSink
+// -----------------------------------------------------------------------------
+
+// ------------
+// CallbackSink
+// ------------
+/*
+ *
+ */
+CallbackSink::CallbackSink(Callback callback, void* context)
+{
+  m_callback = callback;
+  m_context  = context;
+}
+
+// -----
+// write
+// -----
+/*
+ *
+ */
+bool CallbackSink::write(const char* data, size_t size)
+{
+  return m_callback(data, size, m_context);
+}
@@ -0,0 +1,150 @@
+// -----------------------------------------------------------------------------
+// OutputSink.h                                                     OutputSink.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref OutputSink class
+ *             and its derived classes.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef OUTPUTSINK_H_INCLUDE_NO1
+#define OUTPUTSINK_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <ostream>
+
+
+// ----------
+// OutputSink
+// ----------
+/**
+ * @brief  The base class of all receivers of generated code.
+ *
+ * An @ref OutputBuffer hands its data to a sink in large chunks.
+ */
+class OutputSink
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // ~OutputSink
+  // -----------
+  /**
+   * @brief  The destructor.
+   */
+  virtual ~OutputSink();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // write
+  // -----
+  /**
+   * @brief  This method receives the next chunk of data.
+   *
+   * @return  false if the data could not be processed
+   */
+  virtual bool write(const char* data, std::size_t size) = 0;
+
+};
+
+
+// ------
+// FdSink
+// ------
+/**
+ * @brief  This sink passes all data to a file descriptor via write(2).
+ */
+class FdSink : public OutputSink
+{
+
+public:
+
+  /// the constructor (the file descriptor is not closed by the sink)
+  explicit FdSink(int fd);
+
+  /// this method writes the given data completely
+  bool write(const char* data, std::size_t size);
+
+private:
+
+  /// the receiving file descriptor
+  int m_fd;
+
+};
+
+
+// ----------
+// StreamSink
+// ----------
+/**
+ * @brief  This sink passes all data to a std::ostream.
+ */
+class StreamSink : public OutputSink
+{
+
+public:
+
+  /// the constructor (the stream must outlive the sink)
+  explicit StreamSink(std::ostream& stream);
+
+  /// this method writes the given data to the stream
+  bool write(const char* data, std::size_t size);
+
+private:
+
+  /// the receiving stream
+  std::ostream& m_stream;
+
+};
+
+
+// ------------
+// CallbackSink
+// ------------
+/**
+ * @brief  This sink passes all data to a function.
+ */
+class CallbackSink : public OutputSink
+{
+
+public:
+
+  /// the type of the receiving function (returns false on failure)
+  typedef bool (*Callback)(const char* data, std::size_t size, void* context);
+
+  /// the constructor (context is passed to each call)
+  CallbackSink(Callback callback, void* context);
+
+  /// this method passes the given data to the function
+  bool write(const char* data, std::size_t size);
+
+private:
+
+  /// the receiving function
+  Callback m_callback;
+
+  /// passed to each call
+  void* m_context;
+
+};
+
+#endif  /* #ifndef OUTPUTSINK_H_INCLUDE_NO1 */
@@ -0,0 +1,466 @@
+// -----------------------------------------------------------------------------
+// RenderCache.cpp                                               RenderCache.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref RenderCache class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cerrno>
+#include <cstdio>      /* rename() */
+#include <dirent.h>    /* opendir() */
+#include <fcntl.h>     /* open() */
+#include <unistd.h>    /* read(), close(), unlink(), getpid() */
+#include <utime.h>     /* utime() */
+#include <sys/stat.h>  /* stat(), mkdir() */
+#include <algorithm>   /* sort() */
+#include <sstream>
+#include <vector>
+#include "message.h"
+#include "RenderCache.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the number of bytes read at once from an entry
+static const size_t BLOCKSIZE = 256 * 1024;
+
+/// the part of the limit freed by an eviction (so the next scan is far off)
+static const off_t SLACK = 10;
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// -----
+// Entry
+// -----
+/**
+ * @brief  A file found in the cache directory.
+ */
+struct Entry
+{
+  std::string name;  ///< the name of the file
+  off_t       size;  ///< the size of the file
+  time_t      time;  ///< the time of the last use
+};
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -----
+// older
+// -----
+/**
+ * @brief  This function orders entries by increasing time of use.
+ */
+static bool older(const Entry& a, const Entry& b)
+{
+  return (a.time < b.time);
+}
+
+// -------
+// isEntry
+// -------
+/**
+ * @brief  This function checks whether the given name is an entry's name.
+ *
+ * Entries are named by 16 hexadecimal digits, a dash and the input size.
+ */
+static bool isEntry(const char* name)
+{
+  int i = 0;
+
+  for(; i < 16; i++)
+  {
+    char c = name[i];
+
+    if ( !(((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f'))) ) return false;
+  }
+
+  return (name[i] == '-');
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -----------
+// RenderCache
+// -----------
+/*
+ *
+ */
+RenderCache::RenderCache(const string& directory, off_t limit)
+{
+  m_directory   = directory;
+  m_limit       = limit;
+  m_total       = 0;
+  m_hits        = 0;
+  m_misses      = 0;
+  m_stored      = 0;
+  m_evicted     = 0;
+  m_temporaries = 0;
+
+  // create directory (fails silently if it exists)
+  mkdir(m_directory.c_str(), 0777);
+
+  pthread_mutex_init(&m_mutex, 0);
+
+  // initial size (entries of earlier runs)
+  if (m_limit > 0) evict();
+}
+
+// ------------
+// ~RenderCache
+// ------------
+/*
+ *
+ */
+RenderCache::~RenderCache()
+{
+  pthread_mutex_destroy(&m_mutex);
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ----
+// hash
+// ----
+/*
+ *
+ */
+uint64_t RenderCache::hash(const char* data, size_t size, uint64_t hash)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+
+  for(size_t i = 0; i < size; i++)
+  {
+    hash ^= p[i];
+    hash *= static_cast<uint64_t>(1099511628211UL);
+  }
+
+  return hash;
+}
+
+// ---
+// key
+// ---
+/*
+ *
+ */
+string RenderCache::key(const char* data, size_t size, const string& signature)
+{
+  uint64_t hash = RenderCache::hash(signature.data(), signature.size() + 1);
+
+  hash = RenderCache::hash(data, size, hash);
+
+  static const char HEX[] = "0123456789abcdef";
+
+  string name(16, '0');
+
+  for(int i = 15; i >= 0; i--)
+  {
+    name[i] = HEX[hash & 0xF];
+
+    hash >>= 4;
+  }
+
+  ostringstream length;
+  length << size;
+
+  return name + "-" + length.str();
+}
+
+// ------
+// header
+// ------
+/*
+ *
+ */
+string RenderCache::header(size_t size, const string& signature)
+{
+  ostringstream line;
+
+  line << signature << " size=" << size << "\n";
+
+  return line.str();
+}
+
+// -----
+// fetch
+// -----
+/*
+ * Once the first block has been written, the entry can't be rendered
+ * again instead, so any later failure is reported as BROKEN.
+ */
+RenderCache::Fetched RenderCache::fetch(const string& key, const string& header, OutputSink& sink, bool counted)
+{
+  string path = m_directory + "/" + key;
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  // check header (entries of other inputs are missing too)
+  if (fd >= 0)
+  {
+    string stored(header.size(), '\0');
+    size_t have = 0;
+
+    while (have < stored.size())
+    {
+      ssize_t got = read(fd, &stored[have], stored.size() - have);
+
+      // retry interrupted reads
+      if ((got < 0) && (errno == EINTR)) continue;
+
+      if (got <= 0) break;
+
+      have += got;
+    }
+
+    if ((have < stored.size()) || (stored != header))
+    {
+      close(fd);
+
+      fd = -1;
+    }
+  }
+
+  if (counted)
+  {
+    pthread_mutex_lock(&m_mutex);
+    if (fd < 0) m_misses += 1; else m_hits += 1;
+    pthread_mutex_unlock(&m_mutex);
+  }
+
+  if (fd < 0) return MISSING;
+
+  // renew time of use
+  utime(path.c_str(), 0);
+
+  vector<char> block(BLOCKSIZE);
+
+  Fetched result = FETCHED;
+
+  while (true)
+  {
+    ssize_t got = read(fd, &block[0], block.size());
+
+    // retry interrupted reads
+    if ((got < 0) && (errno == EINTR)) continue;
+
+    if (got == 0) break;
+
+    if (got < 0)
+    {
+      // notify user
+      msg::err( msg::catq("cannot read cache entry ", path) );
+
+      result = BROKEN;
+
+      break;
+    }
+
+    if ( !sink.write(&block[0], got) )
+    {
+      result = BROKEN;
+
+      break;
+    }
+  }
+
+  close(fd);
+
+  return result;
+}
+
+// -----
+// store
+// -----
+/*
+ *
+ */
+void RenderCache::store(const string& key, const string& header, const string& data, bool counted)
+{
+  pthread_mutex_lock(&m_mutex);
+  unsigned number = m_temporaries++;
+  pthread_mutex_unlock(&m_mutex);
+
+  // unique among all processes and threads
+  ostringstream temp;
+  temp << m_directory << "/.tmp-" << getpid() << "-" << number;
+
+  int fd = open(temp.str().c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+
+  if (fd < 0) return;
+
+  FdSink sink(fd);
+
+  bool written = sink.write(header.data(), header.size()) && sink.write(data.data(), data.size());
+
+  if (close(fd) != 0) written = false;
+
+  // publish complete entries only
+  string path = m_directory + "/" + key;
+
+  if (!written || (rename(temp.str().c_str(), path.c_str()) != 0))
+  {
+    unlink( temp.str().c_str() );
+
+    return;
+  }
+
+  pthread_mutex_lock(&m_mutex);
+
+  if (counted) m_stored += 1;
+
+  m_total += header.size() + data.size();
+
+  if ((m_limit > 0) && (m_total > m_limit)) evict();
+
+  pthread_mutex_unlock(&m_mutex);
+}
+
+// ------
+// render
+// ------
+/*
+ * Broken code is passed to the sink but never stored.  Neither is
+ * recovered code, so the problems are reported again next time.
+ */
+bool RenderCache::render(LaTeXGenerator& generator, const char* data, size_t size,
+                         OutputSink& sink, bool& written, unsigned threads)
+{
+  string signature = generator.signature();
+  string name      = key(data, size, signature);
+  string head      = header(size, signature);
+
+  // replay stored code
+  Fetched fetched = fetch(name, head, sink);
+
+  if (fetched != MISSING)
+  {
+    written = (fetched == FETCHED);
+
+    return true;
+  }
+
+  string code;
+
+  bool success = generator.render(data, size, code, threads);
+
+  written = sink.write(code.data(), code.size());
+
+  if (success && written && generator.problems().empty()) store(name, head, code);
+
+  return success;
+}
+
+// ------
+// report
+// ------
+/*
+ *
+ */
+void RenderCache::report() const
+{
+  ostringstream line;
+
+  line << "cache: "  << m_hits    << " hits, "
+                     << m_misses  << " misses, "
+                     << m_stored  << " stored, "
+                     << m_evicted << " evicted";
+
+  // notify user
+  msg::nfo( line.str() );
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// -----
+// evict
+// -----
+/*
+ * The caller holds the mutex.  Entries removed by another process
+ * in the meantime are simply skipped.  Once over the limit, entries are
+ * removed until 1/SLACK of the limit is free, so a cache at its limit
+ * isn't scanned again by the very next store.
+ */
+void RenderCache::evict()
+{
+  m_total = 0;
+
+  DIR* dir = opendir( m_directory.c_str() );
+
+  if (dir == 0) return;
+
+  vector<Entry> entries;
+  off_t         total = 0;
+
+  while (dirent* item = readdir(dir))
+  {
+    if ( !isEntry(item->d_name) ) continue;
+
+    struct stat info;
+
+    string path = m_directory + "/" + item->d_name;
+
+    if ((stat(path.c_str(), &info) != 0) || !S_ISREG(info.st_mode)) continue;
+
+    Entry entry;
+
+    entry.name = item->d_name;
+    entry.size = info.st_size;
+    entry.time = info.st_mtime;
+
+    entries.push_back(entry);
+
+    total += entry.size;
+  }
+
+  closedir(dir);
+
+  m_total = total;
+
+  if (total <= m_limit) return;
+
+  // least recently used first
+  sort(entries.begin(), entries.end(), older);
+
+  off_t target = m_limit - m_limit / SLACK;
+
+  for(vector<Entry>::size_type i = 0; (i < entries.size()) && (total > target); i++)
+  {
+    string path = m_directory + "/" + entries[i].name;
+
+    if (unlink(path.c_str()) == 0) m_evicted += 1;
+
+    total -= entries[i].size;
+  }
+
+  m_total = total;
+}
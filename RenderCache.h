@@ -0,0 +1,244 @@
+// -----------------------------------------------------------------------------
+// RenderCache.h                                                   RenderCache.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref RenderCache class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef RENDERCACHE_H_INCLUDE_NO1
+#define RENDERCACHE_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <pthread.h>
+#include <stdint.h>     /* uint64_t */
+#include <sys/types.h>  /* off_t */
+#include <cstddef>
+#include <string>
+#include "OutputSink.h"
+#include "LaTeXGenerator.h"
+
+
+// -----------
+// RenderCache
+// -----------
+/**
+ * @brief  This class stores generated code in a directory.
+ *
+ * Each entry is named after a hash of the input and the generator's
+ * signature.  It starts with a header that repeats the signature and the
+ * size of the input, so inputs of colliding hashes don't share entries.  Entries are written to a temporary file first and then
+ * renamed, so any number of processes may share the same directory.
+ * When the directory grows beyond its limit, the least recently used
+ * entries are removed (each hit renews the modification time).  The size
+ * of the directory is tracked in memory, so it is only scanned when the
+ * stored entries push the total beyond the limit.
+ */
+class RenderCache
+{
+
+public:
+
+  /// the offset basis of FNV-1a
+  static const uint64_t BASIS = 14695981039346656037UL;
+
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the results of fetch()
+  enum Fetched
+  {
+    MISSING,  ///< there is no such entry
+    FETCHED,  ///< the entry has been passed to the sink
+    BROKEN    ///< reading the entry or writing to the sink failed
+  };
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // RenderCache
+  // -----------
+  /**
+   * @brief  The constructor.
+   *
+   * @param directory  holds the cache directory (created if missing).
+   * @param limit      holds the maximum size in bytes (0 means unlimited).
+   */
+  RenderCache(const std::string& directory, off_t limit);
+
+  // ------------
+  // ~RenderCache
+  // ------------
+  /**
+   * @brief  The destructor.
+   */
+  ~RenderCache();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // hash
+  // ----
+  /**
+   * @brief  This method continues a 64 bit FNV-1a hash.
+   *
+   * @param data  points to the bytes to add.
+   * @param size  holds the number of bytes.
+   * @param hash  holds the hash so far (the offset basis to start a new one).
+   */
+  static uint64_t hash(const char* data, std::size_t size, uint64_t hash = BASIS);
+
+  // ---
+  // key
+  // ---
+  /**
+   * @brief  This method returns the key of the given input.
+   *
+   * @param data       points to the input.
+   * @param size       holds the size of the input.
+   * @param signature  describes the generator's settings.
+   */
+  static std::string key(const char* data, std::size_t size, const std::string& signature);
+
+  // ------
+  // header
+  // ------
+  /**
+   * @brief  This method returns the header of the entry of the given input.
+   *
+   * @param size       holds the size of the input.
+   * @param signature  describes the generator's settings.
+   */
+  static std::string header(std::size_t size, const std::string& signature);
+
+  // -----
+  // fetch
+  // -----
+  /**
+   * @brief  This method passes a stored entry to the given sink.
+   *
+   * @param key      holds the key of the entry.
+   * @param header   holds the expected header of the entry (not passed on).
+   * @param sink     receives the stored data.
+   * @param counted  holds false for entries that aren't rendered documents
+   *                 (they are left out of the hits and misses).
+   *
+   * @return  MISSING if there is no such entry (or it has another header),
+   *          BROKEN if the entry has been passed only partly
+   */
+  Fetched fetch(const std::string& key, const std::string& header, OutputSink& sink, bool counted = true);
+
+  // -----
+  // store
+  // -----
+  /**
+   * @brief  This method adds an entry and removes old ones if necessary.
+   *
+   * @param key      holds the key of the entry.
+   * @param header   holds the header of the entry.
+   * @param data     holds the data to store.
+   * @param counted  holds false for entries that aren't rendered documents
+   *                 (they are left out of the stored entries, not the size).
+   */
+  void store(const std::string& key, const std::string& header, const std::string& data, bool counted = true);
+
+  // ------
+  // render
+  // ------
+  /**
+   * @brief  This method replays the stored code of the given input
+   *         or renders the input and stores the generated code.
+   *
+   * @param generator  holds the settings.
+   * @param data       points to the input.
+   * @param size       holds the size of the input.
+   * @param sink       receives the generated code.
+   * @param written    receives false if the sink (or the stored entry) failed.
+   * @param threads    holds the number of threads (see LaTeXGenerator::parse()).
+   *
+   * @return  false if the input could not be rendered
+   */
+  bool render(LaTeXGenerator& generator, const char* data, std::size_t size,
+              OutputSink& sink, bool& written, unsigned threads = 1);
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method prints the counters via stderr.
+   */
+  void report() const;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // evict
+  // -----
+  /**
+   * @brief  This method scans the directory, removes the oldest entries
+   *         beyond the limit and recounts the total size.
+   */
+  void evict();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the cache directory
+  std::string m_directory;
+
+  /// the maximum size of all entries (0 means unlimited)
+  off_t m_limit;
+
+  /// the size of all entries as of the last scan plus the entries stored since
+  off_t m_total;
+
+  /// the number of entries found
+  unsigned m_hits;
+
+  /// the number of entries not found
+  unsigned m_misses;
+
+  /// the number of entries added
+  unsigned m_stored;
+
+  /// the number of entries removed
+  unsigned m_evicted;
+
+  /// the number of temporary files created
+  unsigned m_temporaries;
+
+  /// protects all counters and the eviction
+  pthread_mutex_t m_mutex;
+
+  // not copyable
+  RenderCache(const RenderCache&);
+  RenderCache& operator=(const RenderCache&);
+
+};
+
+#endif  /* #ifndef RENDERCACHE_H_INCLUDE_NO1 */
@@ -0,0 +1,141 @@
+// -----------------------------------------------------------------------------
+// RenderClient.cpp                                             RenderClient.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref RenderClient class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>
+#include <unistd.h>    /* close() */
+#include <sys/socket.h>
+#include <sys/un.h>    /* sockaddr_un */
+#include "RenderClient.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// ------------
+// RenderClient
+// ------------
+/*
+ *
+ */
+RenderClient::RenderClient()
+{
+  m_fd = -1;
+}
+
+// -------------
+// ~RenderClient
+// -------------
+/*
+ *
+ */
+RenderClient::~RenderClient()
+{
+  close();
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// -------
+// connect
+// -------
+/*
+ *
+ */
+bool RenderClient::connect(const string& path)
+{
+  // drop recent connection
+  close();
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+
+  address.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(address.sun_path)) return false;
+
+  strcpy(address.sun_path, path.c_str());
+
+  m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (m_fd < 0) return false;
+
+  if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    close();
+
+    // signalize trouble
+    return false;
+  }
+
+  // signalize success
+  return true;
+}
+
+// -------
+// request
+// -------
+/*
+ *
+ */
+bool RenderClient::request(const RenderServer::Request& request, const char* body, size_t size,
+                           RenderServer::Status& status, string& reply)
+{
+  if (m_fd < 0) return false;
+
+  RenderServer::encode(request, body, size, m_frame);
+
+  if ( !RenderServer::writeFully(m_fd, m_frame.data(), m_frame.size()) ) return false;
+
+  // status and length
+  unsigned char header[5];
+
+  if ( !RenderServer::readFully(m_fd, reinterpret_cast<char*>(header), sizeof(header)) ) return false;
+
+  status = static_cast<RenderServer::Status>(header[0]);
+
+  size_t length = (static_cast<size_t>(header[1]) << 24)
+                | (static_cast<size_t>(header[2]) << 16)
+                | (static_cast<size_t>(header[3]) <<  8)
+                |  static_cast<size_t>(header[4]);
+
+  reply.resize(length);
+
+  return (length == 0) || RenderServer::readFully(m_fd, &reply[0], length);
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void RenderClient::close()
+{
+  if (m_fd >= 0)
+  {
+    ::close(m_fd);
+  }
+
+  m_fd = -1;
+}
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// RenderClient.h                                                 RenderClient.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref RenderClient class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef RENDERCLIENT_H_INCLUDE_NO1
+#define RENDERCLIENT_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include "RenderServer.h"
+
+
+// ------------
+// RenderClient
+// ------------
+/**
+ * @brief  This class sends render requests to a @ref RenderServer.
+ */
+class RenderClient
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ------------
+  // RenderClient
+  // ------------
+  /**
+   * @brief  The standard-constructor.
+   */
+  RenderClient();
+
+  // -------------
+  // ~RenderClient
+  // -------------
+  /**
+   * @brief  The destructor closes the connection.
+   */
+  ~RenderClient();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -------
+  // connect
+  // -------
+  /**
+   * @brief  This method connects to the server listening on the given socket.
+   */
+  bool connect(const std::string& path);
+
+  // -------
+  // request
+  // -------
+  /**
+   * @brief  This method renders the given code on the server.
+   *
+   * @param request  holds the settings.
+   * @param body     points to the code to render.
+   * @param size     holds the number of characters to render.
+   * @param status   receives the status of the response.
+   * @param reply    receives the LaTeX code (or the reason of failure).
+   *
+   * @return  false if the server could not be reached
+   */
+  bool request(const RenderServer::Request& request, const char* body, std::size_t size,
+               RenderServer::Status& status, std::string& reply);
+
+  // -----
+  // close
+  // -----
+  /**
+   * @brief  This method closes the connection.
+   */
+  void close();
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the connected socket
+  int m_fd;
+
+  /// the current request
+  std::string m_frame;
+
+  // not copyable
+  RenderClient(const RenderClient&);
+  RenderClient& operator=(const RenderClient&);
+
+};
+
+#endif  /* #ifndef RENDERCLIENT_H_INCLUDE_NO1 */
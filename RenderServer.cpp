@@ -0,0 +1,757 @@
+// -----------------------------------------------------------------------------
+// RenderServer.cpp                                             RenderServer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref RenderServer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>       /* clock_gettime() */
+#include <fcntl.h>     /* fcntl() */
+#include <poll.h>      /* poll() */
+#include <unistd.h>    /* pipe(), read(), write(), close(), unlink() */
+#include <sys/socket.h>
+#include <sys/stat.h>  /* stat() */
+#include <sys/time.h>  /* timeval */
+#include <sys/un.h>    /* sockaddr_un */
+#include <algorithm>   /* sort() */
+#include <sstream>
+#include "message.h"
+#include "LaTeXGenerator.h"
+#include "RenderServer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the largest accepted request
+static const size_t MAXREQUEST = 64 * 1024 * 1024;
+
+/// the number of bytes in front of the code of a request
+static const size_t SETTINGSIZE = 10;
+
+
+// -----------------------------------------------------------------------------
+// Signals                                                               Signals
+// -----------------------------------------------------------------------------
+
+/// set by SIGINT and SIGTERM
+static volatile sig_atomic_t s_stop = 0;
+
+/// the writing end of the running server's wake-up pipe
+static int s_wake = -1;
+
+// --------
+// onSignal
+// --------
+/**
+ * @brief  This function stops the running server.
+ */
+extern "C" void onSignal(int)
+{
+  s_stop = 1;
+
+  if (s_wake >= 0)
+  {
+    char c = 0;
+
+    // wake up poll()
+    ssize_t done = write(s_wake, &c, 1);
+
+    (void) done;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -----
+// put32
+// -----
+/**
+ * @brief  This function appends an integer in network byte order.
+ */
+static void put32(string& frame, unsigned value)
+{
+  frame += static_cast<char>((value >> 24) & 0xFF);
+  frame += static_cast<char>((value >> 16) & 0xFF);
+  frame += static_cast<char>((value >>  8) & 0xFF);
+  frame += static_cast<char>( value        & 0xFF);
+}
+
+// -----
+// get32
+// -----
+/**
+ * @brief  This function extracts an integer in network byte order.
+ */
+static unsigned get32(const char* data)
+{
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(data);
+
+  return (static_cast<unsigned>(u[0]) << 24)
+       | (static_cast<unsigned>(u[1]) << 16)
+       | (static_cast<unsigned>(u[2]) <<  8)
+       |  static_cast<unsigned>(u[3]);
+}
+
+// ------------
+// microseconds
+// ------------
+/**
+ * @brief  This function returns the microseconds elapsed since start.
+ */
+static unsigned microseconds(const timespec& start)
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  long sec  = now.tv_sec  - start.tv_sec;
+  long nsec = now.tv_nsec - start.tv_nsec;
+
+  return static_cast<unsigned>(sec * 1000000 + nsec / 1000);
+}
+
+
+// -----------------------------------------------------------------------------
+// Tasks                                                                   Tasks
+// -----------------------------------------------------------------------------
+
+// ----------
+// Connection
+// ----------
+/**
+ * @brief  This task answers the next request of a single connection.
+ *
+ * The same task is submitted again for each request, so its buffers
+ * are reused for the whole lifetime of the connection.
+ */
+class Connection : public WorkerPool::Task
+{
+
+public:
+
+  /// the constructor
+  Connection(RenderServer& server, int fd)
+  : m_server(&server), m_fd(fd), m_open(true)
+  {
+  }
+
+  /// the destructor closes the connection
+  ~Connection()
+  {
+    close(m_fd);
+  }
+
+  /// this method answers one request
+  void run()
+  {
+    m_open = m_server->respond(m_fd, m_payload, m_reply);
+
+    m_server->handBack(this);
+  }
+
+  /// the connected socket
+  int fd() const
+  {
+    return m_fd;
+  }
+
+  /// the connection may carry further requests
+  bool isOpen() const
+  {
+    return m_open;
+  }
+
+private:
+
+  /// the server that accepted the connection
+  RenderServer* m_server;
+
+  /// the connected socket
+  int m_fd;
+
+  /// the connection may carry further requests
+  bool m_open;
+
+  /// the current request
+  string m_payload;
+
+  /// the current response
+  string m_reply;
+
+};
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// ------------
+// RenderServer
+// ------------
+/*
+ *
+ */
+RenderServer::RenderServer(unsigned threads, unsigned timeout)
+: m_pool(threads), m_timeout(timeout)
+{
+  m_wake[0] = -1;
+  m_wake[1] = -1;
+
+  pthread_mutex_init(&m_mutex, 0);
+}
+
+// -------------
+// ~RenderServer
+// -------------
+/*
+ *
+ */
+RenderServer::~RenderServer()
+{
+  pthread_mutex_destroy(&m_mutex);
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// -----
+// serve
+// -----
+/*
+ *
+ */
+bool RenderServer::serve(const string& path)
+{
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+
+  address.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    // notify user
+    msg::err( msg::catq("socket path too long: ", path) );
+
+    // signalize trouble
+    return false;
+  }
+
+  strcpy(address.sun_path, path.c_str());
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (listener < 0)
+  {
+    // notify user
+    msg::err("cannot create socket");
+
+    // signalize trouble
+    return false;
+  }
+
+  // remove stale socket (nobody accepts connections on it)
+  struct stat info;
+
+  if ((stat(path.c_str(), &info) == 0) && S_ISSOCK(info.st_mode))
+  {
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    int state = (probe < 0) ? -1 : connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    int error = errno;
+
+    if (probe >= 0) close(probe);
+
+    if ((state != 0) && (error == ECONNREFUSED))
+    {
+      unlink( path.c_str() );
+    }
+
+    else
+    {
+      // notify user
+      if (state == 0) msg::err( msg::catq("socket in use by another server: ", path) );
+      else            msg::err( msg::catq("cannot check socket: ", path) );
+
+      close(listener);
+
+      // signalize trouble
+      return false;
+    }
+  }
+
+  if ((bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) || (listen(listener, SOMAXCONN) != 0))
+  {
+    // notify user
+    msg::err( msg::catq("cannot listen on socket: ", path) );
+
+    close(listener);
+
+    // signalize trouble
+    return false;
+  }
+
+  // wake-up pipe (never blocks)
+  if (pipe(m_wake) != 0)
+  {
+    // notify user
+    msg::err("cannot create pipe");
+
+    close(listener);
+    unlink( path.c_str() );
+
+    // signalize trouble
+    return false;
+  }
+
+  fcntl(m_wake[0], F_SETFL, O_NONBLOCK);
+  fcntl(m_wake[1], F_SETFL, O_NONBLOCK);
+
+  // stop on SIGINT and SIGTERM
+  struct sigaction action;
+  struct sigaction oldInt;
+  struct sigaction oldTerm;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = onSignal;
+  sigemptyset(&action.sa_mask);
+
+  s_stop = 0;
+  s_wake = m_wake[1];
+
+  sigaction(SIGINT,  &action, &oldInt);
+  sigaction(SIGTERM, &action, &oldTerm);
+
+  // notify user
+  msg::nfo( msg::catq("listening on ", path) );
+
+  // connections waiting for their next request
+  vector<Connection*> idle;
+
+  vector<pollfd> fds;
+
+  while ( !s_stop )
+  {
+    fds.clear();
+
+    pollfd entry;
+    entry.events  = POLLIN;
+    entry.revents = 0;
+
+    entry.fd = listener;
+    fds.push_back(entry);
+
+    entry.fd = m_wake[0];
+    fds.push_back(entry);
+
+    for(vector<Connection*>::size_type i = 0; i < idle.size(); i++)
+    {
+      entry.fd = idle[i]->fd();
+      fds.push_back(entry);
+    }
+
+    if (poll(&fds[0], fds.size(), -1) < 0)
+    {
+      // interrupted by a signal
+      if (errno == EINTR) continue;
+
+      // notify user
+      msg::err("cannot wait for connections");
+
+      break;
+    }
+
+    // hand readable connections to the workers
+    vector<Connection*> waiting;
+
+    for(vector<Connection*>::size_type i = 0; i < idle.size(); i++)
+    {
+      if (fds[i + 2].revents != 0)
+      {
+        m_pool.submit(idle[i]);
+      }
+
+      else
+      {
+        waiting.push_back(idle[i]);
+      }
+    }
+
+    idle.swap(waiting);
+
+    // take back answered connections
+    if (fds[1].revents != 0)
+    {
+      char drain[64];
+
+      while (read(m_wake[0], drain, sizeof(drain)) > 0);
+
+      vector<Connection*> answered;
+
+      pthread_mutex_lock(&m_mutex);
+      answered.swap(m_returned);
+      pthread_mutex_unlock(&m_mutex);
+
+      for(vector<Connection*>::size_type i = 0; i < answered.size(); i++)
+      {
+        // the pool may still be busy with the task
+        m_pool.wait(answered[i]);
+
+        if ( answered[i]->isOpen() )
+        {
+          idle.push_back(answered[i]);
+        }
+
+        else
+        {
+          delete answered[i];
+        }
+      }
+    }
+
+    // accept new connection
+    if (fds[0].revents != 0)
+    {
+      int fd = accept(listener, 0, 0);
+
+      if (fd >= 0)
+      {
+        // don't let slow clients block a worker forever (neither
+        // while reading their request nor while writing the reply)
+        timeval timeout;
+        timeout.tv_sec  = m_timeout;
+        timeout.tv_usec = 0;
+
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        idle.push_back( new Connection(*this, fd) );
+      }
+    }
+  }
+
+  // stop accepting
+  close(listener);
+  unlink( path.c_str() );
+
+  // finish current requests
+  m_pool.wait();
+
+  pthread_mutex_lock(&m_mutex);
+  idle.insert(idle.end(), m_returned.begin(), m_returned.end());
+  m_returned.clear();
+  pthread_mutex_unlock(&m_mutex);
+
+  for(vector<Connection*>::size_type i = 0; i < idle.size(); i++)
+  {
+    delete idle[i];
+  }
+
+  // restore signal handling
+  sigaction(SIGINT,  &oldInt,  0);
+  sigaction(SIGTERM, &oldTerm, 0);
+
+  s_wake = -1;
+
+  close(m_wake[0]);
+  close(m_wake[1]);
+
+  m_wake[0] = -1;
+  m_wake[1] = -1;
+
+  report();
+
+  // signalize success
+  return true;
+}
+
+// ------
+// encode
+// ------
+/*
+ *
+ */
+void RenderServer::encode(const Request& request, const char* body, size_t size, string& frame)
+{
+  frame.clear();
+  frame.reserve(4 + SETTINGSIZE + size);
+
+  put32(frame, SETTINGSIZE + size);
+
+  frame += static_cast<char>( (request.blank         ? 1 : 0)
+                            | (request.document      ? 2 : 0)
+                            | (request.compact       ? 4 : 0)
+                            | (request.compactSpaces ? 8 : 0) );
+  frame += request.synchar;
+
+  put32(frame, request.maxLinesFirst);
+  put32(frame, request.maxLinesEach);
+
+  frame.append(body, size);
+}
+
+// ------
+// decode
+// ------
+/*
+ *
+ */
+bool RenderServer::decode(const string& payload, Request& request, size_t& body)
+{
+  if (payload.size() < SETTINGSIZE) return false;
+
+  const char* data = payload.data();
+
+  request.blank         = ((data[0] & 1) != 0);
+  request.document      = ((data[0] & 2) != 0);
+  request.compact       = ((data[0] & 4) != 0);
+  request.compactSpaces = ((data[0] & 8) != 0);
+  request.synchar       = data[1];
+  request.maxLinesFirst = get32(data + 2);
+  request.maxLinesEach  = get32(data + 6);
+
+  body = SETTINGSIZE;
+
+  // signalize success
+  return true;
+}
+
+// ---------
+// readFully
+// ---------
+/*
+ *
+ */
+bool RenderServer::readFully(int fd, char* data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t done = read(fd, data, size);
+
+    if (done < 0)
+    {
+      // retry interrupted calls
+      if (errno == EINTR) continue;
+
+      // signalize trouble
+      return false;
+    }
+
+    // connection closed
+    if (done == 0) return false;
+
+    data += done;
+    size -= done;
+  }
+
+  // signalize success
+  return true;
+}
+
+// ----------
+// writeFully
+// ----------
+/*
+ *
+ */
+bool RenderServer::writeFully(int fd, const char* data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t done = send(fd, data, size, MSG_NOSIGNAL);
+
+    if (done < 0)
+    {
+      // retry interrupted calls
+      if (errno == EINTR) continue;
+
+      // the client doesn't take the reply (send timeout), drop it
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) return false;
+
+      // signalize trouble
+      return false;
+    }
+
+    data += done;
+    size -= done;
+  }
+
+  // signalize success
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// -------
+// respond
+// -------
+/*
+ *
+ */
+bool RenderServer::respond(int fd, string& payload, string& reply)
+{
+  char length[4];
+
+  // connection closed by the client
+  if ( !readFully(fd, length, sizeof(length)) ) return false;
+
+  timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  size_t size = get32(length);
+
+  if (size > MAXREQUEST)
+  {
+    RenderServer::reply(fd, BAD_REQUEST, "request too large");
+
+    return false;
+  }
+
+  payload.resize(size);
+
+  if ((size > 0) && !readFully(fd, &payload[0], size)) return false;
+
+  Request request;
+  size_t  body;
+
+  if ( !decode(payload, request, body) )
+  {
+    RenderServer::reply(fd, BAD_REQUEST, "request too short");
+
+    return false;
+  }
+
+  LaTeXGenerator generator;
+
+  // initialize generator
+  generator.setSyntaxCharacter(request.synchar);
+  generator.enableBackgroundColor(!request.blank);
+  generator.enableDocument(request.document);
+  generator.enableCompact(request.compact);
+  generator.enableCompactSpaces(request.compactSpaces);
+  generator.setMaxLinesFirst(request.maxLinesFirst);
+  generator.setMaxLinesEach(request.maxLinesEach);
+
+  bool sent;
+
+  if ( generator.render(payload.data() + body, payload.size() - body, reply) )
+  {
+    sent = RenderServer::reply(fd, OK, reply);
+  }
+
+  else
+  {
+    string reason = "invalid markup";
+
+    // the line that stopped the parser
+    if ( !generator.problems().empty() ) reason = msg::cat("invalid markup at ", MarkupChecker::describe(generator.problems()[0]));
+
+    sent = RenderServer::reply(fd, INVALID_MARKUP, reason);
+  }
+
+  unsigned elapsed = microseconds(start);
+
+  pthread_mutex_lock(&m_mutex);
+  m_latency.push_back(elapsed);
+  pthread_mutex_unlock(&m_mutex);
+
+  return sent;
+}
+
+// -----
+// reply
+// -----
+/*
+ *
+ */
+bool RenderServer::reply(int fd, Status status, const string& body)
+{
+  string header;
+
+  header += static_cast<char>(status);
+
+  put32(header, body.size());
+
+  return writeFully(fd, header.data(), header.size()) && writeFully(fd, body.data(), body.size());
+}
+
+// --------
+// handBack
+// --------
+/*
+ *
+ */
+void RenderServer::handBack(Connection* connection)
+{
+  pthread_mutex_lock(&m_mutex);
+  m_returned.push_back(connection);
+  pthread_mutex_unlock(&m_mutex);
+
+  char c = 0;
+
+  // wake up the accepting thread
+  ssize_t done = write(m_wake[1], &c, 1);
+
+  (void) done;
+}
+
+// ------
+// report
+// ------
+/*
+ * The percentiles use the nearest-rank method.
+ */
+void RenderServer::report() const
+{
+  if ( m_latency.empty() )
+  {
+    // notify user
+    msg::nfo("no requests answered");
+
+    return;
+  }
+
+  vector<unsigned> sorted(m_latency);
+  sort(sorted.begin(), sorted.end());
+
+  static const unsigned percent[] = { 50, 90, 99 };
+
+  ostringstream line;
+  line << "latency (us):";
+
+  for(unsigned i = 0; i < sizeof(percent) / sizeof(percent[0]); i++)
+  {
+    size_t rank = (percent[i] * sorted.size() + 99) / 100;
+
+    line << " p" << percent[i] << " " << sorted[rank - 1] << ",";
+  }
+
+  line << " max " << sorted.back();
+
+  // notify user
+  msg::nfo( msg::cat("requests answered: ", msg::str(static_cast<unsigned>(sorted.size()))) );
+  msg::nfo( line.str() );
+}
@@ -0,0 +1,265 @@
+// -----------------------------------------------------------------------------
+// RenderServer.h                                                 RenderServer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref RenderServer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef RENDERSERVER_H_INCLUDE_NO1
+#define RENDERSERVER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <pthread.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "WorkerPool.h"
+
+
+// -----------------------------------------------------------------------------
+// Declarations                                                     Declarations
+// -----------------------------------------------------------------------------
+class Connection;
+
+
+// ------------
+// RenderServer
+// ------------
+/**
+ * @brief  This class answers render requests on a Unix domain socket.
+ *
+ * Each request and each response is a frame that starts with a length.
+ * All integers are sent as 4 bytes in network byte order.
+ *
+ * Request  | Size | Meaning
+ * :------- | ---: | :------
+ * length   |    4 | the number of bytes that follow
+ * flags    |    1 | 1 = no background color, 2 = complete document,
+ *          |      | 4 = compact mode, 8 = collapse spaces
+ * synchar  |    1 | the syntactic character
+ * initial  |    4 | the maximum number of lines in the first paragraph
+ * each     |    4 | the maximum number of lines in each paragraph
+ * body     |    * | the code to render
+ *
+ * Response | Size | Meaning
+ * :------- | ---: | :------
+ * status   |    1 | see @ref Status
+ * length   |    4 | the number of bytes that follow
+ * body     |    * | the LaTeX code (or the reason of failure)
+ *
+ * A connection may carry any number of requests.  Idle connections are
+ * watched by the accepting thread, so a worker is only busy while it
+ * reads, renders and answers a single request.  A client that stalls
+ * while sending its request or taking its reply is dropped after the
+ * timeout, so it can't keep a worker busy.
+ */
+class RenderServer
+{
+
+public:
+
+  /// the default number of seconds a worker waits for a client
+  static const unsigned TIMEOUT = 10;
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the status byte of each response
+  enum Status
+  {
+    OK             = 0,  ///< the body holds the LaTeX code
+    BAD_REQUEST    = 1,  ///< the request could not be decoded
+    INVALID_MARKUP = 2   ///< the code could not be rendered
+  };
+
+  // -------
+  // Request
+  // -------
+  /**
+   * @brief  The settings of a single request.
+   */
+  struct Request
+  {
+    bool     blank;         ///< no background color
+    bool     document;      ///< full LaTeX document
+    bool     compact;       ///< define colors and layout only once
+    bool     compactSpaces; ///< collapse runs of spaces and tabs
+    char     synchar;       ///< syntactical character
+    unsigned maxLinesFirst; ///< maximum number of lines in the first paragraph
+    unsigned maxLinesEach;  ///< maximum number of lines in each paragraph
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ------------
+  // RenderServer
+  // ------------
+  /**
+   * @brief  The constructor.
+   *
+   * @param threads  holds the number of worker threads (0 means automatic).
+   * @param timeout  holds the number of seconds a worker waits for the
+   *                 rest of a request or for the client to take its reply.
+   */
+  explicit RenderServer(unsigned threads, unsigned timeout = TIMEOUT);
+
+  // -------------
+  // ~RenderServer
+  // -------------
+  /**
+   * @brief  The destructor.
+   */
+  ~RenderServer();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // -----
+  // serve
+  // -----
+  /**
+   * @brief  This method answers requests until SIGINT or SIGTERM arrives.
+   *
+   * @param path  holds the path of the socket (removed on return).
+   *
+   * An existing socket at the path is only replaced if it is stale (the
+   * connection is refused); if a server still answers on it, serve fails.
+   *
+   * The latency percentiles of all requests are reported on return.
+   */
+  bool serve(const std::string& path);
+
+  // ------
+  // encode
+  // ------
+  /**
+   * @brief  This method creates the frame of the given request.
+   */
+  static void encode(const Request& request, const char* body, std::size_t size, std::string& frame);
+
+  // ------
+  // decode
+  // ------
+  /**
+   * @brief  This method extracts the settings from the given payload.
+   *
+   * @param payload  holds the request without its length.
+   * @param request  receives the settings.
+   * @param body     receives the offset of the code within the payload.
+   *
+   * @return  false if the payload is too short
+   */
+  static bool decode(const std::string& payload, Request& request, std::size_t& body);
+
+  // ---------
+  // readFully
+  // ---------
+  /**
+   * @brief  This method reads exactly the given number of bytes
+   *         from a socket.
+   */
+  static bool readFully(int fd, char* data, std::size_t size);
+
+  // ----------
+  // writeFully
+  // ----------
+  /**
+   * @brief  This method writes exactly the given number of bytes
+   *         to a socket (without raising SIGPIPE).
+   *
+   * @return  false if the connection failed or the send timeout expired
+   */
+  static bool writeFully(int fd, const char* data, std::size_t size);
+
+
+protected:
+
+  // connections are handed back by the workers
+  friend class Connection;
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // -------
+  // respond
+  // -------
+  /**
+   * @brief  This method answers the next request of the given connection.
+   *
+   * @return  false if the connection should be closed
+   */
+  bool respond(int fd, std::string& payload, std::string& reply);
+
+  // -----
+  // reply
+  // -----
+  /**
+   * @brief  This method sends a response.
+   */
+  static bool reply(int fd, Status status, const std::string& body);
+
+  // --------
+  // handBack
+  // --------
+  /**
+   * @brief  This method returns a connection to the accepting thread.
+   */
+  void handBack(Connection* connection);
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method reports the latency percentiles.
+   */
+  void report() const;
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// renders the requests
+  WorkerPool m_pool;
+
+  /// the number of seconds a worker waits for a client
+  unsigned m_timeout;
+
+  /// wakes up the accepting thread
+  int m_wake[2];
+
+  /// connections that have been answered
+  std::vector<Connection*> m_returned;
+
+  /// the latency of each request (in microseconds)
+  std::vector<unsigned> m_latency;
+
+  /// protects both vectors above
+  pthread_mutex_t m_mutex;
+
+  // not copyable
+  RenderServer(const RenderServer&);
+  RenderServer& operator=(const RenderServer&);
+
+};
+
+#endif  /* #ifndef RENDERSERVER_H_INCLUDE_NO1 */
@@ -0,0 +1,307 @@
+// -----------------------------------------------------------------------------
+// RenderStats.cpp                                               RenderStats.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref RenderStats class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <ctime>     /* clock_gettime() */
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "message.h"
+#include "RenderStats.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+// table entries
+#define BS  RenderStats::BACKSLASH
+#define BR  RenderStats::BRACE
+#define CT  RenderStats::CONTROL
+#define SP  RenderStats::SPACE
+#define SC  RenderStats::SPECIAL
+#define LG  RenderStats::LIGATURE
+#define NO  RenderStats::ESCAPES
+
+/// the escape class of all 256 characters (ESCAPES if not escaped)
+static const unsigned char CLASS[256] =
+{
+  /*   0 */ CT, CT, CT, CT, CT, CT, CT, CT, CT, SP, CT, CT, CT, CT, CT, CT,
+  /*  16 */ CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT, CT,
+  /*  32 */ SP, NO, LG, SC, SC, SC, SC, NO, NO, NO, NO, NO, NO, LG, NO, NO,
+  /*  48 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, LG, NO, LG, NO,
+  /*  64 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /*  80 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, BS, NO, SC, SC,
+  /*  96 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 112 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, BR, NO, BR, SC, NO,
+  /* 128 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 144 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 160 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 176 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 192 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 208 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 224 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO,
+  /* 240 */ NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO
+};
+
+#undef NO
+#undef LG
+#undef SC
+#undef SP
+#undef CT
+#undef BR
+#undef BS
+
+/// the names of the escape classes (in the order of RenderStats::Escape)
+static const char* const ESCAPENAMES[RenderStats::ESCAPES] =
+{
+  "backslash", "brace", "control", "space", "special", "ligature"
+};
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -----------
+// RenderStats
+// -----------
+/*
+ *
+ */
+RenderStats::RenderStats()
+{
+  bytesRead    = 0;
+  bytesWritten = 0;
+  lines        = 0;
+  paragraphs   = 0;
+  spans        = 0;
+  longestLine  = 0;
+  readSeconds  = 0;
+  parseSeconds = 0;
+  writeSeconds = 0;
+  wallSeconds  = 0;
+  m_started    = 0;
+
+  for(int i = 0; i < ESCAPES; i++)
+  {
+    escapes[i] = 0;
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ---
+// now
+// ---
+/*
+ *
+ */
+double RenderStats::now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// -----
+// start
+// -----
+/*
+ *
+ */
+void RenderStats::start()
+{
+  m_started = now();
+}
+
+// ----
+// stop
+// ----
+/*
+ *
+ */
+void RenderStats::stop()
+{
+  wallSeconds = now() - m_started;
+}
+
+// ---------
+// countLine
+// ---------
+/*
+ *
+ */
+void RenderStats::countLine(size_t size, bool paragraph)
+{
+  lines += 1;
+
+  if (paragraph) paragraphs += 1;
+
+  if (size > longestLine) longestLine = size;
+}
+
+// ----------
+// countChars
+// ----------
+/*
+ * The classes follow the escape table of the LaTeXGenerator.  Local
+ * counters keep the loop free of stores to the members.
+ */
+void RenderStats::countChars(const char* data, size_t size)
+{
+  // one more slot for characters that aren't escaped
+  uint64_t count[ESCAPES + 1] = { 0 };
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+
+  for(size_t i = 0; i < size; i++)
+  {
+    count[ CLASS[p[i]] ] += 1;
+  }
+
+  for(int i = 0; i < ESCAPES; i++)
+  {
+    escapes[i] += count[i];
+  }
+}
+
+// -----
+// merge
+// -----
+/*
+ * The wall clock is left alone.
+ */
+void RenderStats::merge(const RenderStats& other)
+{
+  bytesRead    += other.bytesRead;
+  bytesWritten += other.bytesWritten;
+  lines        += other.lines;
+  paragraphs   += other.paragraphs;
+  spans        += other.spans;
+  readSeconds  += other.readSeconds;
+  parseSeconds += other.parseSeconds;
+  writeSeconds += other.writeSeconds;
+
+  if (other.longestLine > longestLine) longestLine = other.longestLine;
+
+  for(int i = 0; i < ESCAPES; i++)
+  {
+    escapes[i] += other.escapes[i];
+  }
+}
+
+// ------
+// report
+// ------
+/*
+ *
+ */
+void RenderStats::report(bool json) const
+{
+  ostringstream line;
+
+  line << fixed << setprecision(6);
+
+  if (json)
+  {
+    line << "{\"bytes_read\": "    << bytesRead
+         << ", \"bytes_written\": " << bytesWritten
+         << ", \"lines\": "         << lines
+         << ", \"paragraphs\": "    << paragraphs
+         << ", \"spans\": "         << spans
+         << ", \"longest_line\": "  << longestLine
+         << ", \"escapes\": {";
+
+    for(int i = 0; i < ESCAPES; i++)
+    {
+      line << ((i > 0) ? ", " : "") << "\"" << ESCAPENAMES[i] << "\": " << escapes[i];
+    }
+
+    line << "}, \"seconds\": {\"read\": " << readSeconds
+         << ", \"parse\": "               << parseSeconds
+         << ", \"write\": "               << writeSeconds
+         << ", \"wall\": "                << wallSeconds
+         << "}}";
+
+    // a single untagged line
+    cerr << line.str() << endl;
+
+    return;
+  }
+
+  line << "stats: " << bytesRead    << " bytes read, "
+                    << bytesWritten << " bytes written, "
+                    << lines        << " lines, "
+                    << paragraphs   << " paragraphs, "
+                    << spans        << " spans, longest line "
+                    << longestLine  << " bytes, escaped";
+
+  for(int i = 0; i < ESCAPES; i++)
+  {
+    line << " " << escapes[i] << " " << ESCAPENAMES[i];
+  }
+
+  line << setprecision(3)
+       << ", " << readSeconds  << " s reading"
+       << ", " << parseSeconds << " s parsing"
+       << ", " << writeSeconds << " s writing"
+       << ", " << wallSeconds  << " s wall";
+
+  // notify user
+  msg::nfo( line.str() );
+}
+
+
+// -----------------------------------------------------------------------------
+// StatsSink                                                           StatsSink
+// -----------------------------------------------------------------------------
+
+// ---------
+// StatsSink
+// ---------
+/*
+ *
+ */
+StatsSink::StatsSink(OutputSink& target, RenderStats& stats)
+: m_target(target), m_stats(stats)
+{
+}
+
+// -----
+// write
+// -----
+/*
+ *
+ */
+bool StatsSink::write(const char* data, size_t size)
+{
+  double started = RenderStats::now();
+
+  bool success = m_target.write(data, size);
+
+  m_stats.writeSeconds += RenderStats::now() - started;
+  m_stats.bytesWritten += size;
+
+  return success;
+}
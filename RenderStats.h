@@ -0,0 +1,201 @@
+// -----------------------------------------------------------------------------
+// RenderStats.h                                                   RenderStats.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref RenderStats class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef RENDERSTATS_H_INCLUDE_NO1
+#define RENDERSTATS_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <stdint.h>  /* uint64_t */
+#include <cstddef>
+#include "OutputSink.h"
+
+
+// -----------
+// RenderStats
+// -----------
+/**
+ * @brief  This class collects the counters and timings of --stats.
+ *
+ * Nothing is counted unless an object is attached to the classes that
+ * take part in rendering, and each of them only checks the attachment
+ * once per line or block.  An object must not be shared by threads;
+ * each thread collects its own counters and merge() adds them up.
+ *
+ * The parsing time is the time spent in LaTeXGenerator::parse() apart
+ * from reading and writing, so it includes waiting for worker threads.
+ */
+class RenderStats
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the classes of escaped characters
+  enum Escape
+  {
+    BACKSLASH,  ///< the backslash
+    BRACE,      ///< curly braces
+    CONTROL,    ///< control characters (shown as [CTRL])
+    SPACE,      ///< spaces and tabs
+    SPECIAL,    ///< # $ % & ^ _ ~
+    LIGATURE,   ///< " < > - (which would form ligatures otherwise)
+    ESCAPES     ///< the number of classes
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Counters                                                           Counters
+  // ---------------------------------------------------------------------------
+
+  uint64_t bytesRead;         ///< bytes read from the input
+  uint64_t bytesWritten;      ///< bytes passed to the output
+  uint64_t lines;             ///< rendered lines
+  uint64_t paragraphs;        ///< rendered paragraphs
+  uint64_t spans;             ///< highlighted sequences
+  uint64_t longestLine;       ///< the number of bytes in the longest line
+  uint64_t escapes[ESCAPES];  ///< escaped characters by class
+  double   readSeconds;       ///< time spent reading the input
+  double   parseSeconds;      ///< time spent parsing and translating
+  double   writeSeconds;      ///< time spent writing the output
+  double   wallSeconds;       ///< time between start() and stop()
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // RenderStats
+  // -----------
+  /**
+   * @brief  The standard-constructor (all counters are zero).
+   */
+  RenderStats();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // now
+  // ---
+  /**
+   * @brief  This method returns the seconds of a monotonic clock.
+   */
+  static double now();
+
+  // -----
+  // start
+  // -----
+  /**
+   * @brief  This method starts the wall clock.
+   */
+  void start();
+
+  // ----
+  // stop
+  // ----
+  /**
+   * @brief  This method stops the wall clock.
+   */
+  void stop();
+
+  // ---------
+  // countLine
+  // ---------
+  /**
+   * @brief  This method counts a rendered line (its characters are
+   *         counted by countChars()).
+   *
+   * @param size       holds the number of characters in the line.
+   * @param paragraph  is true if the line starts a paragraph.
+   */
+  void countLine(std::size_t size, bool paragraph);
+
+  // ----------
+  // countChars
+  // ----------
+  /**
+   * @brief  This method counts the escaped characters of displayed code
+   *         (the contents of a span, not the markup around it).
+   */
+  void countChars(const char* data, std::size_t size);
+
+  // -----
+  // merge
+  // -----
+  /**
+   * @brief  This method adds the counters of another object.
+   */
+  void merge(const RenderStats& other);
+
+  // ------
+  // report
+  // ------
+  /**
+   * @brief  This method prints all counters via stderr.
+   *
+   * @param json  set true to print a single JSON object instead of a
+   *              tagged summary
+   */
+  void report(bool json) const;
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the time of start()
+  double m_started;
+
+};
+
+
+// ---------
+// StatsSink
+// ---------
+/**
+ * @brief  This sink counts and times the data passed to another sink.
+ */
+class StatsSink : public OutputSink
+{
+
+public:
+
+  /// the constructor (both objects must outlive the sink)
+  StatsSink(OutputSink& target, RenderStats& stats);
+
+  /// this method passes the given data to the target
+  bool write(const char* data, std::size_t size);
+
+private:
+
+  /// the receiving sink
+  OutputSink& m_target;
+
+  /// the counters
+  RenderStats& m_stats;
+
+};
+
+#endif  /* #ifndef RENDERSTATS_H_INCLUDE_NO1 */
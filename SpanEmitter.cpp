@@ -0,0 +1,634 @@
+// -----------------------------------------------------------------------------
+// SpanEmitter.cpp                                               SpanEmitter.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref SpanEmitter class
+ *             and its derived classes.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>    /* strlen() */
+#include <algorithm>  /* min() */
+#include "SpanEmitter.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Escape tables                                                   Escape tables
+// -----------------------------------------------------------------------------
+
+/// each character mapped to itself
+const char IDENTITY[] =
+  "\000\001\002\003\004\005\006\007\010\011\012\013\014\015\016\017"
+  "\020\021\022\023\024\025\026\027\030\031\032\033\034\035\036\037"
+  "\040\041\042\043\044\045\046\047\050\051\052\053\054\055\056\057"
+  "\060\061\062\063\064\065\066\067\070\071\072\073\074\075\076\077"
+  "\100\101\102\103\104\105\106\107\110\111\112\113\114\115\116\117"
+  "\120\121\122\123\124\125\126\127\130\131\132\133\134\135\136\137"
+  "\140\141\142\143\144\145\146\147\150\151\152\153\154\155\156\157"
+  "\160\161\162\163\164\165\166\167\170\171\172\173\174\175\176\177"
+  "\200\201\202\203\204\205\206\207\210\211\212\213\214\215\216\217"
+  "\220\221\222\223\224\225\226\227\230\231\232\233\234\235\236\237"
+  "\240\241\242\243\244\245\246\247\250\251\252\253\254\255\256\257"
+  "\260\261\262\263\264\265\266\267\270\271\272\273\274\275\276\277"
+  "\300\301\302\303\304\305\306\307\310\311\312\313\314\315\316\317"
+  "\320\321\322\323\324\325\326\327\330\331\332\333\334\335\336\337"
+  "\340\341\342\343\344\345\346\347\350\351\352\353\354\355\356\357"
+  "\360\361\362\363\364\365\366\367\370\371\372\373\374\375\376\377";
+
+// table entries
+#define ESC(s)   { s, sizeof(s) - 1 }
+#define SELF(c)  { IDENTITY + c, 1 }
+#define CTRL     ESC("[CTRL]")
+
+/// the HTML code of all 256 characters (indexed by unsigned char)
+static const Escape HTMLESCAPE[256] =
+{
+  /*   0 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*   8 */ CTRL, ESC("  "), CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  16 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  24 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  32 */ SELF(32), SELF(33), ESC("&quot;"), SELF(35), SELF(36), SELF(37), ESC("&amp;"), SELF(39),
+  /*  40 */ SELF(40), SELF(41), SELF(42), SELF(43), SELF(44), SELF(45), SELF(46), SELF(47),
+  /*  48 */ SELF(48), SELF(49), SELF(50), SELF(51), SELF(52), SELF(53), SELF(54), SELF(55),
+  /*  56 */ SELF(56), SELF(57), SELF(58), SELF(59), ESC("&lt;"), SELF(61), ESC("&gt;"), SELF(63),
+  /*  64 */ SELF(64), SELF(65), SELF(66), SELF(67), SELF(68), SELF(69), SELF(70), SELF(71),
+  /*  72 */ SELF(72), SELF(73), SELF(74), SELF(75), SELF(76), SELF(77), SELF(78), SELF(79),
+  /*  80 */ SELF(80), SELF(81), SELF(82), SELF(83), SELF(84), SELF(85), SELF(86), SELF(87),
+  /*  88 */ SELF(88), SELF(89), SELF(90), SELF(91), SELF(92), SELF(93), SELF(94), SELF(95),
+  /*  96 */ SELF(96), SELF(97), SELF(98), SELF(99), SELF(100), SELF(101), SELF(102), SELF(103),
+  /* 104 */ SELF(104), SELF(105), SELF(106), SELF(107), SELF(108), SELF(109), SELF(110), SELF(111),
+  /* 112 */ SELF(112), SELF(113), SELF(114), SELF(115), SELF(116), SELF(117), SELF(118), SELF(119),
+  /* 120 */ SELF(120), SELF(121), SELF(122), SELF(123), SELF(124), SELF(125), SELF(126), SELF(127),
+  /* 128 */ SELF(128), SELF(129), SELF(130), SELF(131), SELF(132), SELF(133), SELF(134), SELF(135),
+  /* 136 */ SELF(136), SELF(137), SELF(138), SELF(139), SELF(140), SELF(141), SELF(142), SELF(143),
+  /* 144 */ SELF(144), SELF(145), SELF(146), SELF(147), SELF(148), SELF(149), SELF(150), SELF(151),
+  /* 152 */ SELF(152), SELF(153), SELF(154), SELF(155), SELF(156), SELF(157), SELF(158), SELF(159),
+  /* 160 */ SELF(160), SELF(161), SELF(162), SELF(163), SELF(164), SELF(165), SELF(166), SELF(167),
+  /* 168 */ SELF(168), SELF(169), SELF(170), SELF(171), SELF(172), SELF(173), SELF(174), SELF(175),
+  /* 176 */ SELF(176), SELF(177), SELF(178), SELF(179), SELF(180), SELF(181), SELF(182), SELF(183),
+  /* 184 */ SELF(184), SELF(185), SELF(186), SELF(187), SELF(188), SELF(189), SELF(190), SELF(191),
+  /* 192 */ SELF(192), SELF(193), SELF(194), SELF(195), SELF(196), SELF(197), SELF(198), SELF(199),
+  /* 200 */ SELF(200), SELF(201), SELF(202), SELF(203), SELF(204), SELF(205), SELF(206), SELF(207),
+  /* 208 */ SELF(208), SELF(209), SELF(210), SELF(211), SELF(212), SELF(213), SELF(214), SELF(215),
+  /* 216 */ SELF(216), SELF(217), SELF(218), SELF(219), SELF(220), SELF(221), SELF(222), SELF(223),
+  /* 224 */ SELF(224), SELF(225), SELF(226), SELF(227), SELF(228), SELF(229), SELF(230), SELF(231),
+  /* 232 */ SELF(232), SELF(233), SELF(234), SELF(235), SELF(236), SELF(237), SELF(238), SELF(239),
+  /* 240 */ SELF(240), SELF(241), SELF(242), SELF(243), SELF(244), SELF(245), SELF(246), SELF(247),
+  /* 248 */ SELF(248), SELF(249), SELF(250), SELF(251), SELF(252), SELF(253), SELF(254), SELF(255)
+};
+
+/// the terminal text of all 256 characters (indexed by unsigned char)
+static const Escape ANSIESCAPE[256] =
+{
+  /*   0 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*   8 */ CTRL, ESC("  "), CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  16 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  24 */ CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL, CTRL,
+  /*  32 */ SELF(32), SELF(33), SELF(34), SELF(35), SELF(36), SELF(37), SELF(38), SELF(39),
+  /*  40 */ SELF(40), SELF(41), SELF(42), SELF(43), SELF(44), SELF(45), SELF(46), SELF(47),
+  /*  48 */ SELF(48), SELF(49), SELF(50), SELF(51), SELF(52), SELF(53), SELF(54), SELF(55),
+  /*  56 */ SELF(56), SELF(57), SELF(58), SELF(59), SELF(60), SELF(61), SELF(62), SELF(63),
+  /*  64 */ SELF(64), SELF(65), SELF(66), SELF(67), SELF(68), SELF(69), SELF(70), SELF(71),
+  /*  72 */ SELF(72), SELF(73), SELF(74), SELF(75), SELF(76), SELF(77), SELF(78), SELF(79),
+  /*  80 */ SELF(80), SELF(81), SELF(82), SELF(83), SELF(84), SELF(85), SELF(86), SELF(87),
+  /*  88 */ SELF(88), SELF(89), SELF(90), SELF(91), SELF(92), SELF(93), SELF(94), SELF(95),
+  /*  96 */ SELF(96), SELF(97), SELF(98), SELF(99), SELF(100), SELF(101), SELF(102), SELF(103),
+  /* 104 */ SELF(104), SELF(105), SELF(106), SELF(107), SELF(108), SELF(109), SELF(110), SELF(111),
+  /* 112 */ SELF(112), SELF(113), SELF(114), SELF(115), SELF(116), SELF(117), SELF(118), SELF(119),
+  /* 120 */ SELF(120), SELF(121), SELF(122), SELF(123), SELF(124), SELF(125), SELF(126), SELF(127),
+  /* 128 */ SELF(128), SELF(129), SELF(130), SELF(131), SELF(132), SELF(133), SELF(134), SELF(135),
+  /* 136 */ SELF(136), SELF(137), SELF(138), SELF(139), SELF(140), SELF(141), SELF(142), SELF(143),
+  /* 144 */ SELF(144), SELF(145), SELF(146), SELF(147), SELF(148), SELF(149), SELF(150), SELF(151),
+  /* 152 */ SELF(152), SELF(153), SELF(154), SELF(155), SELF(156), SELF(157), SELF(158), SELF(159),
+  /* 160 */ SELF(160), SELF(161), SELF(162), SELF(163), SELF(164), SELF(165), SELF(166), SELF(167),
+  /* 168 */ SELF(168), SELF(169), SELF(170), SELF(171), SELF(172), SELF(173), SELF(174), SELF(175),
+  /* 176 */ SELF(176), SELF(177), SELF(178), SELF(179), SELF(180), SELF(181), SELF(182), SELF(183),
+  /* 184 */ SELF(184), SELF(185), SELF(186), SELF(187), SELF(188), SELF(189), SELF(190), SELF(191),
+  /* 192 */ SELF(192), SELF(193), SELF(194), SELF(195), SELF(196), SELF(197), SELF(198), SELF(199),
+  /* 200 */ SELF(200), SELF(201), SELF(202), SELF(203), SELF(204), SELF(205), SELF(206), SELF(207),
+  /* 208 */ SELF(208), SELF(209), SELF(210), SELF(211), SELF(212), SELF(213), SELF(214), SELF(215),
+  /* 216 */ SELF(216), SELF(217), SELF(218), SELF(219), SELF(220), SELF(221), SELF(222), SELF(223),
+  /* 224 */ SELF(224), SELF(225), SELF(226), SELF(227), SELF(228), SELF(229), SELF(230), SELF(231),
+  /* 232 */ SELF(232), SELF(233), SELF(234), SELF(235), SELF(236), SELF(237), SELF(238), SELF(239),
+  /* 240 */ SELF(240), SELF(241), SELF(242), SELF(243), SELF(244), SELF(245), SELF(246), SELF(247),
+  /* 248 */ SELF(248), SELF(249), SELF(250), SELF(251), SELF(252), SELF(253), SELF(254), SELF(255)
+};
+
+#undef CTRL
+#undef SELF
+#undef ESC
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+// -----
+// Color
+// -----
+/**
+ * @brief  A color defined by the LaTeX code.
+ */
+struct Color
+{
+  char        name;  ///< the name used in the markup
+  const char* rgb;   ///< the CSS value of the dvips color
+  const char* sgr;   ///< the SGR parameter of the terminal color
+};
+
+/// the colors defined by LaTeXGenerator::openGroup()
+static const Color COLORS[] =
+{
+  { 'R', "#ED1B23", "31" },  // Red
+  { 'G', "#009B55", "32" },  // ForestGreen
+  { 'B', "#00A2E3", "34" },  // Cerulean
+  { 'C', "#00AEEF", "36" },  // Cyan
+  { 'M', "#EC008C", "35" },  // Magenta
+  { 'Y', "#FAA21A", "33" }   // YellowOrange
+};
+
+/// the background color of the LaTeX code (rgb 0.82,0.82,0.92)
+static const char* const BACKGROUND = "#D1D1EB";
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ---------
+// findColor
+// ---------
+/**
+ * @brief  This function returns the predefined color of the given name
+ *         (or 0 if there is none).
+ */
+static const Color* findColor(const char* name, size_t size)
+{
+  if (size != 1) return 0;
+
+  for(size_t i = 0; i < sizeof(COLORS) / sizeof(COLORS[0]); i++)
+  {
+    if (COLORS[i].name == *name) return COLORS + i;
+  }
+
+  return 0;
+}
+
+// ---------
+// openColor
+// ---------
+/**
+ * @brief  This function opens a bold HTML span of the given color.
+ *
+ * Names other than the predefined ones are passed to CSS if they consist
+ * of letters, digits and '#' only (like "navy" or "#FF8000").  Anything
+ * else could close the attribute, so the color is dropped (so is a name
+ * cut by SpanEmitter::addName()).
+ */
+static void openColor(const char* name, size_t size, OutputBuffer& out)
+{
+  const Color* color = findColor(name, size);
+
+  out << "<span style=\"";
+
+  if (color != 0)
+  {
+    out << "color:" << color->rgb << ";";
+  }
+
+  else
+  {
+    bool safe = (size > 0) && (size <= SpanEmitter::MAXNAME);
+
+    for(size_t i = 0; safe && (i < size); i++)
+    {
+      char c = name[i];
+
+      safe = ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '#');
+    }
+
+    if (safe)
+    {
+      out << "color:";
+      out.write(name, size);
+      out << ";";
+    }
+  }
+
+  out << "font-weight:bold\">";
+}
+
+
+// -----------------------------------------------------------------------------
+// SpanEmitter                                                       SpanEmitter
+// -----------------------------------------------------------------------------
+
+// -----------
+// SpanEmitter
+// -----------
+/*
+ * All tables escape the control characters.
+ */
+SpanEmitter::SpanEmitter(const Escape* escape, char trigger)
+{
+  m_escape  = escape;
+  m_trigger = trigger;
+
+  if (m_escape == 0) return;
+
+  m_special.addBelow(32);
+
+  // all other characters that aren't mapped to themselves
+  for(unsigned i = 32; i < 256; i++)
+  {
+    if (m_escape[i].text != IDENTITY + i) m_special.add(static_cast<char>(i));
+  }
+}
+
+// ------------
+// ~SpanEmitter
+// ------------
+/*
+ *
+ */
+SpanEmitter::~SpanEmitter()
+{
+}
+
+// ---------
+// translate
+// ---------
+/*
+ *
+ */
+void SpanEmitter::translate(const char* first, const char* end, OutputBuffer& out) const
+{
+  while (first != end)
+  {
+    // copy plain characters in one go
+    const char* stop = m_special.find(first, end);
+
+    out.write(first, stop - first);
+
+    if (stop == end) break;
+
+    translate(*stop, out);
+
+    first = stop + 1;
+  }
+}
+
+// -------
+// addName
+// -------
+/*
+ * One character beyond MAXNAME is kept, so a cut name is still too long
+ * to be taken for a color.
+ */
+const string& SpanEmitter::addName(const char* first, size_t size, bool continued)
+{
+  if ( !continued ) m_name.clear();
+
+  if (m_name.size() <= MAXNAME) m_name.append(first, min(size, MAXNAME + 1 - m_name.size()));
+
+  return m_name;
+}
+
+
+// -----------------------------------------------------------------------------
+// LaTeXEmitter                                                     LaTeXEmitter
+// -----------------------------------------------------------------------------
+
+// ------------
+// LaTeXEmitter
+// ------------
+/*
+ *
+ */
+LaTeXEmitter::LaTeXEmitter(const LaTeXGenerator& generator)
+: m_generator(generator), m_lpp(0), m_initial(true), m_started(false), m_visible(false)
+{
+  // the lines are counted by the generator that passes the spans
+  m_generator.setStats(0);
+
+  m_generator.m_emitter = 0;
+}
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void LaTeXEmitter::open(OutputBuffer& out)
+{
+  m_generator.openOutput(out);
+
+  m_lpp     = 0;
+  m_initial = true;
+  m_started = false;
+}
+
+// --------
+// emitPart
+// --------
+/*
+ * Just like LaTeXGenerator::parseLongLine(), the paragraph is checked
+ * in front of the first part.
+ */
+void LaTeXEmitter::emitPart(const char* part, size_t, const vector<SpanLexer::Span>& spans,
+                            bool continued, bool unfinished, OutputBuffer& out)
+{
+  if ( !m_started )
+  {
+    m_generator.startLine(m_lpp, m_initial, out);
+
+    m_started = true;
+    m_visible = false;
+  }
+
+  if ( !spans.empty() ) m_visible = true;
+
+  m_generator.m_parsed.clear();
+
+  m_generator.emitSpans(part, spans, continued, unfinished);
+
+  out << m_generator.m_parsed;
+}
+
+// -------
+// endLine
+// -------
+/*
+ * An empty line (or one with nothing but escape sequences) gets the
+ * same rule as in LaTeXGenerator::emitLine().
+ */
+void LaTeXEmitter::endLine(OutputBuffer& out)
+{
+  if ( !m_started ) m_generator.startLine(m_lpp, m_initial, out);
+
+  if (!m_started || !m_visible) out << "\\rule{0pt}{\\dimen100}";
+
+  m_started = false;
+
+  m_lpp += 1;
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void LaTeXEmitter::close(OutputBuffer& out)
+{
+  m_generator.closeOutput(m_lpp, out);
+}
+
+
+// -----------------------------------------------------------------------------
+// HTMLEmitter                                                       HTMLEmitter
+// -----------------------------------------------------------------------------
+
+// -----------
+// HTMLEmitter
+// -----------
+/*
+ *
+ */
+HTMLEmitter::HTMLEmitter(bool background, bool document, char trigger)
+: SpanEmitter(HTMLESCAPE, trigger), m_background(background), m_document(document)
+{
+}
+
+// ----
+// open
+// ----
+/*
+ * A line break right behind <pre> is ignored by browsers.
+ */
+void HTMLEmitter::open(OutputBuffer& out)
+{
+  if (m_document)
+  {
+    out << "<!DOCTYPE html>\n";
+    out << "<html>\n";
+    out << "<head>\n";
+    out << "<meta charset=\"utf-8\">\n";
+    out << "<title>parcolor</title>\n";
+    out << "</head>\n";
+    out << "<body>\n";
+  }
+
+  if (m_background)
+  {
+    out << "<pre style=\"background-color:" << BACKGROUND << "\">\n";
+  }
+
+  else
+  {
+    out << "<pre>\n";
+  }
+}
+
+// --------
+// emitPart
+// --------
+/*
+ * The color of a sequence is known once its name is complete.
+ */
+void HTMLEmitter::emitPart(const char* part, size_t, const vector<SpanLexer::Span>& spans,
+                           bool continued, bool unfinished, OutputBuffer& out)
+{
+  for(size_t i = 0; i < spans.size(); i++)
+  {
+    const SpanLexer::Span& span = spans[i];
+
+    const char* first = part + span.offset;
+
+    switch (span.kind)
+    {
+      case SpanLexer::PLAIN:
+      case SpanLexer::CODE:
+        translate(first, first + span.length, out);
+        break;
+
+      case SpanLexer::NAME:
+      {
+        const string& name = addName(first, span.length, continued && (i == 0));
+
+        // color name finished
+        if (!unfinished || (i + 1 < spans.size())) openColor(name.data(), name.size(), out);
+        break;
+      }
+
+      case SpanLexer::STRAY:
+        translateStray(first, span.length, out);
+        break;
+
+      case SpanLexer::END:
+        out << "</span>";
+        break;
+
+      case SpanLexer::AUTO:
+        openColor(span.color, strlen(span.color), out);
+        translate(first, first + span.length, out);
+        out << "</span>";
+        break;
+    }
+  }
+}
+
+// -------
+// endLine
+// -------
+/*
+ *
+ */
+void HTMLEmitter::endLine(OutputBuffer& out)
+{
+  out << "\n";
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void HTMLEmitter::close(OutputBuffer& out)
+{
+  out << "</pre>\n";
+
+  if (m_document)
+  {
+    out << "</body>\n";
+    out << "</html>\n";
+  }
+}
+
+
+// -----------------------------------------------------------------------------
+// ANSIEmitter                                                       ANSIEmitter
+// -----------------------------------------------------------------------------
+
+// -----------
+// ANSIEmitter
+// -----------
+/*
+ *
+ */
+ANSIEmitter::ANSIEmitter(char trigger)
+: SpanEmitter(ANSIESCAPE, trigger)
+{
+}
+
+// ----
+// open
+// ----
+/*
+ *
+ */
+void ANSIEmitter::open(OutputBuffer&)
+{
+}
+
+// --------
+// emitPart
+// --------
+/*
+ * Each colored sequence ends with a reset, so no attribute survives the
+ * end of the line.
+ */
+void ANSIEmitter::emitPart(const char* part, size_t, const vector<SpanLexer::Span>& spans,
+                           bool continued, bool unfinished, OutputBuffer& out)
+{
+  for(size_t i = 0; i < spans.size(); i++)
+  {
+    const SpanLexer::Span& span = spans[i];
+
+    const char* first = part + span.offset;
+
+    switch (span.kind)
+    {
+      case SpanLexer::PLAIN:
+      case SpanLexer::CODE:
+        translate(first, first + span.length, out);
+        break;
+
+      case SpanLexer::NAME:
+      {
+        const string& name = addName(first, span.length, continued && (i == 0));
+
+        // color name unfinished
+        if (unfinished && (i + 1 == spans.size())) break;
+
+        const Color* color = findColor(name.data(), name.size());
+
+        // bold (and colored)
+        out << "\033[1";
+
+        if (color != 0) out << ";" << color->sgr;
+
+        out << "m";
+        break;
+      }
+
+      case SpanLexer::STRAY:
+        translateStray(first, span.length, out);
+        break;
+
+      case SpanLexer::END:
+        out << "\033[0m";
+        break;
+
+      case SpanLexer::AUTO:
+      {
+        const Color* color = findColor(span.color, strlen(span.color));
+
+        // bold (and colored)
+        out << "\033[1";
+
+        if (color != 0) out << ";" << color->sgr;
+
+        out << "m";
+        translate(first, first + span.length, out);
+        out << "\033[0m";
+        break;
+      }
+    }
+  }
+}
+
+// -------
+// endLine
+// -------
+/*
+ *
+ */
+void ANSIEmitter::endLine(OutputBuffer& out)
+{
+  out << "\n";
+}
+
+// -----
+// close
+// -----
+/*
+ *
+ */
+void ANSIEmitter::close(OutputBuffer&)
+{
+}
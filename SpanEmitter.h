@@ -0,0 +1,344 @@
+// -----------------------------------------------------------------------------
+// SpanEmitter.h                                                   SpanEmitter.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref SpanEmitter class
+ *             and its derived classes.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef SPANEMITTER_H_INCLUDE_NO1
+#define SPANEMITTER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ByteScanner.h"
+#include "LaTeXGenerator.h"
+#include "OutputBuffer.h"
+#include "SpanLexer.h"
+
+
+// ------
+// Escape
+// ------
+/**
+ * @brief  The code that displays a single character.
+ */
+struct Escape
+{
+  const char* text;  ///< the code (not null-terminated)
+  unsigned    size;  ///< the number of characters in text
+};
+
+/// each character mapped to itself (the base of all escape tables)
+extern const char IDENTITY[];
+
+
+// -----------
+// SpanEmitter
+// -----------
+/**
+ * @brief  The base class of all output formats.
+ *
+ * An emitter receives the spans of each line from a @ref SpanLexer, so
+ * a single lex of the input can be rendered into several formats.  The
+ * lexer has already checked the markup, so emitting never fails.  A long
+ * line arrives in several parts (see SpanLexer::lexPart()), so the code
+ * written for a line doesn't grow with the length of the line.
+ */
+class SpanEmitter
+{
+
+public:
+
+  /// the longest color name passed on (longer names aren't colors)
+  static const std::size_t MAXNAME = 32;
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ------------
+  // ~SpanEmitter
+  // ------------
+  /**
+   * @brief  The destructor.
+   */
+  virtual ~SpanEmitter();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // open
+  // ----
+  /**
+   * @brief  This method writes everything in front of the first line.
+   */
+  virtual void open(OutputBuffer& out) = 0;
+
+  // --------
+  // emitPart
+  // --------
+  /**
+   * @brief  This method writes the code of a line or of a part of it.
+   *
+   * @param part        points to the first character of the part.
+   * @param size        holds the number of characters in the part.
+   * @param spans       holds the spans of the part.
+   * @param continued   set true if the first span continues a color name.
+   * @param unfinished  set true if the last span is an unfinished color name.
+   * @param out         receives the code.
+   */
+  virtual void emitPart(const char* part, std::size_t size, const std::vector<SpanLexer::Span>& spans,
+                        bool continued, bool unfinished, OutputBuffer& out) = 0;
+
+  // -------
+  // endLine
+  // -------
+  /**
+   * @brief  This method finishes the line of the recent parts.
+   */
+  virtual void endLine(OutputBuffer& out) = 0;
+
+  // -----
+  // close
+  // -----
+  /**
+   * @brief  This method writes everything behind the last line.
+   */
+  virtual void close(OutputBuffer& out) = 0;
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // SpanEmitter
+  // -----------
+  /**
+   * @brief  The constructor.
+   *
+   * @param escape   holds the code of all 256 characters (0 if translate()
+   *                 isn't used).
+   * @param trigger  holds the trigger character (see translateStray()).
+   */
+  explicit SpanEmitter(const Escape* escape = 0, char trigger = '!');
+
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ---------
+  // translate
+  // ---------
+  /**
+   * @brief  This method appends the code of all characters in [first, end).
+   */
+  void translate(const char* first, const char* end, OutputBuffer& out) const;
+
+  // ---------
+  // translate
+  // ---------
+  /**
+   * @brief  This method appends the code of a single character.
+   */
+  void translate(char c, OutputBuffer& out) const
+  {
+    const Escape& e = m_escape[static_cast<unsigned char>(c)];
+
+    out.write(e.text, e.size);
+  }
+
+  // --------------
+  // translateStray
+  // --------------
+  /**
+   * @brief  This method appends the code of a STRAY span (the trigger may
+   *         have ended the previous part).
+   */
+  void translateStray(const char* first, std::size_t size, OutputBuffer& out) const
+  {
+    translate(m_trigger, out);
+    translate(first[size - 1], out);
+  }
+
+  // -------
+  // addName
+  // -------
+  /**
+   * @brief  This method collects a color name, which may be split across
+   *         the parts of a line.
+   *
+   * @param first      points to the characters of a NAME span.
+   * @param size       holds the number of characters.
+   * @param continued  set true if they continue the recent name.
+   *
+   * @return  the name so far (cut behind MAXNAME + 1 characters)
+   */
+  const std::string& addName(const char* first, std::size_t size, bool continued);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the escape table
+  const Escape* m_escape;
+
+  /// finds all characters that aren't mapped to themselves
+  ByteScanner m_special;
+
+  /// the trigger character
+  char m_trigger;
+
+  /// the recent color name
+  std::string m_name;
+
+};
+
+
+// ------------
+// LaTeXEmitter
+// ------------
+/**
+ * @brief  This emitter writes the same code as LaTeXGenerator::render().
+ */
+class LaTeXEmitter : public SpanEmitter
+{
+
+public:
+
+  /// the constructor (the settings are copied)
+  explicit LaTeXEmitter(const LaTeXGenerator& generator);
+
+  /// this method opens the document and the initial paragraph
+  void open(OutputBuffer& out);
+
+  /// this method writes a part and starts a new paragraph if necessary
+  void emitPart(const char* part, std::size_t size, const std::vector<SpanLexer::Span>& spans,
+                bool continued, bool unfinished, OutputBuffer& out);
+
+  /// this method finishes the line (an empty one is displayed by a rule)
+  void endLine(OutputBuffer& out);
+
+  /// this method closes the recent paragraph and the document
+  void close(OutputBuffer& out);
+
+private:
+
+  /// a private copy of the settings (without counters)
+  LaTeXGenerator m_generator;
+
+  /// lines per paragraph
+  unsigned m_lpp;
+
+  /// initial paragraph
+  bool m_initial;
+
+  /// some parts of the recent line have been written
+  bool m_started;
+
+  /// the recent line has spans
+  bool m_visible;
+
+};
+
+
+// -----------
+// HTMLEmitter
+// -----------
+/**
+ * @brief  This emitter writes a \<pre\> element.
+ *
+ * The colors of the LaTeX code are mapped to their RGB values, other
+ * color names are passed to CSS if they are made of letters, digits and
+ * '#' (and dropped otherwise, just like names longer than MAXNAME).
+ * Paragraphs aren't split, because the element is never broken across
+ * pages.
+ */
+class HTMLEmitter : public SpanEmitter
+{
+
+public:
+
+  /// the constructor
+  HTMLEmitter(bool background, bool document, char trigger);
+
+  /// this method opens the document and the \<pre\> element
+  void open(OutputBuffer& out);
+
+  /// this method writes a part of a line
+  void emitPart(const char* part, std::size_t size, const std::vector<SpanLexer::Span>& spans,
+                bool continued, bool unfinished, OutputBuffer& out);
+
+  /// this method finishes the line
+  void endLine(OutputBuffer& out);
+
+  /// this method closes the \<pre\> element and the document
+  void close(OutputBuffer& out);
+
+private:
+
+  /// use background color or not
+  bool m_background;
+
+  /// create complete HTML file or not
+  bool m_document;
+
+};
+
+
+// -----------
+// ANSIEmitter
+// -----------
+/**
+ * @brief  This emitter writes text with SGR sequences for terminals.
+ *
+ * Each highlighted sequence is bold and, if it uses one of the colors
+ * of the LaTeX code, colored.  Control characters of the input are
+ * shown as [CTRL], so they can't change the state of the terminal.
+ */
+class ANSIEmitter : public SpanEmitter
+{
+
+public:
+
+  /// the constructor
+  explicit ANSIEmitter(char trigger);
+
+  /// this method writes nothing
+  void open(OutputBuffer& out);
+
+  /// this method writes a part of a line
+  void emitPart(const char* part, std::size_t size, const std::vector<SpanLexer::Span>& spans,
+                bool continued, bool unfinished, OutputBuffer& out);
+
+  /// this method finishes the line
+  void endLine(OutputBuffer& out);
+
+  /// this method writes nothing
+  void close(OutputBuffer& out);
+
+};
+
+#endif  /* #ifndef SPANEMITTER_H_INCLUDE_NO1 */
@@ -0,0 +1,297 @@
+// -----------------------------------------------------------------------------
+// SpanLexer.cpp                                                   SpanLexer.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref SpanLexer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>  /* memchr() */
+#include "SpanLexer.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -------
+// addSpan
+// -------
+/**
+ * @brief  This function appends a span.
+ */
+static inline void addSpan(vector<SpanLexer::Span>& spans, size_t offset, size_t length, SpanLexer::Kind kind)
+{
+  SpanLexer::Span span;
+
+  span.offset = offset;
+  span.length = length;
+  span.kind   = kind;
+  span.color  = 0;
+
+  spans.push_back(span);
+}
+
+// -----------
+// findTrigger
+// -----------
+/**
+ * @brief  This function returns the first trigger in [begin, end)
+ *         (or end if there is none).
+ */
+static inline const char* findTrigger(const char* begin, const char* end, char trigger)
+{
+  const void* found = memchr(begin, trigger, end - begin);
+
+  return (found != 0) ? static_cast<const char*>(found) : end;
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// ---------
+// SpanLexer
+// ---------
+/*
+ *
+ */
+SpanLexer::SpanLexer(char trigger)
+{
+  setTrigger(trigger);
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                               Initialization
+// -----------------------------------------------------------------------------
+
+// ----------
+// setTrigger
+// ----------
+/*
+ *
+ */
+void SpanLexer::setTrigger(char trigger)
+{
+  m_trigger = trigger;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ---
+// lex
+// ---
+/*
+ * Only triggers need a closer look, so the line is searched for them
+ * with memchr() and everything in between becomes a single span.
+ */
+bool SpanLexer::lex(const char* line, size_t size, vector<Span>& spans) const
+{
+  // keep capacity
+  spans.clear();
+
+  // behind the last character
+  const char* end = line + size;
+
+  // the first character that hasn't been assigned to a span
+  const char* pos = line;
+
+  // within a colored sequence
+  bool colored = false;
+
+  while (pos != end)
+  {
+    const char* found = findTrigger(pos, end, m_trigger);
+
+    // characters in front of the trigger
+    if (found != pos)
+    {
+      addSpan(spans, pos - line, found - pos, colored ? CODE : PLAIN);
+    }
+
+    if (found == end) break;
+
+    // a trigger at the end of the line is never complete
+    if (found + 1 == end) return false;
+
+    // single trigger
+    if (found[1] != m_trigger)
+    {
+      addSpan(spans, found - line, 2, STRAY);
+
+      pos = found + 2;
+    }
+
+    // close colored sequence
+    else if (colored)
+    {
+      addSpan(spans, found + 2 - line, 0, END);
+
+      colored = false;
+
+      pos = found + 2;
+    }
+
+    // open colored sequence
+    else
+    {
+      const char* name = found + 2;
+      const char* stop = findTrigger(name, end, m_trigger);
+
+      // color name not completed
+      if (stop == end) return false;
+
+      addSpan(spans, name - line, stop - name, NAME);
+
+      colored = true;
+
+      pos = stop + 1;
+    }
+  }
+
+  // check final state
+  return !colored;
+}
+
+// -------
+// lexPart
+// -------
+/*
+ * The same rules as lex(), but a trigger or a color name at the end
+ * of an unfinished part is left open instead of being rejected.
+ */
+bool SpanLexer::lexPart(const char* part, size_t size, bool complete, Progress& progress, vector<Span>& spans) const
+{
+  // keep capacity
+  spans.clear();
+
+  // behind the last character
+  const char* end = part + size;
+
+  // the first character that hasn't been assigned to a span
+  const char* pos = part;
+
+  // trigger of the previous part
+  if (progress.trigger && (pos != end))
+  {
+    progress.trigger = false;
+
+    // single trigger
+    if (*pos != m_trigger)
+    {
+      addSpan(spans, 0, 1, STRAY);
+    }
+
+    // close colored sequence
+    else if (progress.colored)
+    {
+      addSpan(spans, 1, 0, END);
+
+      progress.colored = false;
+    }
+
+    // open colored sequence
+    else
+    {
+      progress.naming = true;
+    }
+
+    pos += 1;
+  }
+
+  // color name of the previous part
+  if (progress.naming)
+  {
+    const char* stop = findTrigger(pos, end, m_trigger);
+
+    addSpan(spans, pos - part, stop - pos, NAME);
+
+    // color name continues
+    if (stop == end) return !complete;
+
+    progress.naming  = false;
+    progress.colored = true;
+
+    pos = stop + 1;
+  }
+
+  while (pos != end)
+  {
+    const char* found = findTrigger(pos, end, m_trigger);
+
+    // characters in front of the trigger
+    if (found != pos)
+    {
+      addSpan(spans, pos - part, found - pos, progress.colored ? CODE : PLAIN);
+    }
+
+    if (found == end) break;
+
+    // a trigger at the end of the part depends on the next part
+    if (found + 1 == end)
+    {
+      progress.trigger = true;
+
+      break;
+    }
+
+    // single trigger
+    if (found[1] != m_trigger)
+    {
+      addSpan(spans, found - part, 2, STRAY);
+
+      pos = found + 2;
+    }
+
+    // close colored sequence
+    else if (progress.colored)
+    {
+      addSpan(spans, found + 2 - part, 0, END);
+
+      progress.colored = false;
+
+      pos = found + 2;
+    }
+
+    // open colored sequence
+    else
+    {
+      const char* name = found + 2;
+      const char* stop = findTrigger(name, end, m_trigger);
+
+      addSpan(spans, name - part, stop - name, NAME);
+
+      // color name continues
+      if (stop == end)
+      {
+        progress.naming = true;
+
+        return !complete;
+      }
+
+      progress.colored = true;
+
+      pos = stop + 1;
+    }
+  }
+
+  // check final state
+  return !complete || (!progress.colored && !progress.trigger);
+}
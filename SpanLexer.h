@@ -0,0 +1,175 @@
+// -----------------------------------------------------------------------------
+// SpanLexer.h                                                       SpanLexer.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref SpanLexer class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef SPANLEXER_H_INCLUDE_NO1
+#define SPANLEXER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+
+// ---------
+// SpanLexer
+// ---------
+/**
+ * @brief  This class splits a line into spans of the !!COLOR!CODE!! markup.
+ *
+ * The spans point into the line, so no characters are copied.  A line
+ * like <tt>a!b !!R!c!!</tt> yields these spans:
+ *
+ * Kind  | Characters
+ * :---- | :---------
+ * PLAIN | <tt>a</tt>
+ * STRAY | <tt>!b</tt>
+ * PLAIN | <tt> </tt>
+ * NAME  | <tt>R</tt>
+ * CODE  | <tt>c</tt>
+ * END   | (none)
+ *
+ * A single trigger doesn't start markup, so it's displayed together with
+ * the following character (which is never part of a run of spaces).
+ * An empty line yields no spans, any other line at least one.
+ */
+class SpanLexer
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the kinds of spans
+  enum Kind
+  {
+    PLAIN,  ///< code outside of markup
+    NAME,   ///< the color name (starts a colored sequence)
+    CODE,   ///< code inside of markup
+    STRAY,  ///< a single trigger and the following character (see lexPart())
+    END,    ///< the end of a colored sequence (no characters)
+    AUTO    ///< code colored automatically (see Span::color)
+  };
+
+  // ----
+  // Span
+  // ----
+  /**
+   * @brief  A run of characters of the same kind.
+   */
+  struct Span
+  {
+    std::size_t offset;  ///< the first character (relative to the line)
+    std::size_t length;  ///< the number of characters
+    Kind        kind;    ///< the meaning of the characters
+    const char* color;   ///< the color name of an AUTO span (0 otherwise)
+  };
+
+  // --------
+  // Progress
+  // --------
+  /**
+   * @brief  The markup state between the parts of a line (see lexPart()).
+   */
+  struct Progress
+  {
+    bool colored;  ///< within a colored sequence
+    bool naming;   ///< within a color name (the NAME span continues)
+    bool trigger;  ///< the previous part ended with a trigger
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ---------
+  // SpanLexer
+  // ---------
+  /**
+   * @brief  The constructor.
+   */
+  explicit SpanLexer(char trigger = '!');
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // ----------
+  // setTrigger
+  // ----------
+  /**
+   * @brief  This method sets ! in the !!COLOR!CODE!! sequence.
+   */
+  void setTrigger(char trigger);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ---
+  // lex
+  // ---
+  /**
+   * @brief  This method splits the given line into spans.
+   *
+   * @param line   points to the first character of the line.
+   * @param size   holds the number of characters in the line.
+   * @param spans  receives the spans (previous ones are removed).
+   *
+   * @return  false if the markup is incomplete
+   */
+  bool lex(const char* line, std::size_t size, std::vector<Span>& spans) const;
+
+  // -------
+  // lexPart
+  // -------
+  /**
+   * @brief  This method splits a part of a line into spans.
+   *
+   * A line lexed in several parts yields the same spans as lex(), apart
+   * from two differences: a color name may be split into several NAME
+   * spans (the last one of a part continues if progress.naming is set),
+   * and a STRAY span holds only the following character if the trigger
+   * ended the previous part.
+   *
+   * @param part      points to the first character of the part.
+   * @param size      holds the number of characters in the part.
+   * @param complete  set true if the part finishes the line.
+   * @param progress  holds the state behind the previous part (all false
+   *                  for the first part) and receives the new one.
+   * @param spans     receives the spans (relative to the part).
+   *
+   * @return  false if the markup is incomplete
+   */
+  bool lexPart(const char* part, std::size_t size, bool complete, Progress& progress, std::vector<Span>& spans) const;
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the trigger character
+  char m_trigger;
+
+};
+
+#endif  /* #ifndef SPANLEXER_H_INCLUDE_NO1 */
@@ -0,0 +1,1153 @@
+// -----------------------------------------------------------------------------
+// SyntaxHighlighter.cpp                                   SyntaxHighlighter.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref SyntaxHighlighter class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstring>  /* memchr(), memcmp(), memcpy(), memset() */
+#include "ByteScanner.h"
+#include "SyntaxHighlighter.h"
+#include "SyntaxKeywords.h"
+
+// vector extensions (x86 only)
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define SYNTAXHIGHLIGHTER_X86 1
+#include <emmintrin.h>
+#endif
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the character classes
+enum Class
+{
+  OTHER,      ///< no special meaning
+  SPACE,      ///< space or tab
+  WORD,       ///< starts an identifier
+  DIGIT,      ///< starts a number
+  QUOTE,      ///< starts a string
+  SLASH,      ///< may start a comment (C)
+  HASH,       ///< starts a comment or a directive
+  DOLLAR,     ///< starts a variable (shell) or math (LaTeX)
+  BACKSLASH,  ///< starts a command (LaTeX)
+  PERCENT     ///< starts a comment (LaTeX)
+};
+
+/// the colors of comments, strings, keywords and LaTeX commands, numbers
+/// and LaTeX math, C preprocessor directives and shell variables
+static const char COMMENT[]   = "G";
+static const char STRING[]    = "R";
+static const char KEYWORD[]   = "B";
+static const char NUMBER[]    = "M";
+static const char DIRECTIVE[] = "C";
+static const char VARIABLE[]  = "Y";
+
+/// the number of characters looked at in one go by scanWords()
+static const size_t CHUNK = 32;
+
+/// the characters that start and end escape sequences of terminal output
+static const char ESC = '\033';
+static const char BEL = '\007';
+
+/// the colors of the eight terminal colors (black and white stay plain)
+static const char* const TERMINAL[8] =
+{
+  0, "R", "G", "Y", "B", "M", "C", 0
+};
+
+/// the names of the languages (indexed by SyntaxHighlighter::Language)
+static const char* const NAMES[] =
+{
+  "none", "c", "sh", "latex", "python", "ansi"
+};
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// --------
+// isLetter
+// --------
+/**
+ * @brief  This function checks whether the given character is an ASCII letter.
+ */
+static inline bool isLetter(char c)
+{
+  return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+}
+
+// ------------
+// isIdentifier
+// ------------
+/**
+ * @brief  This function checks whether the given class continues an identifier.
+ */
+static inline bool isIdentifier(unsigned char c)
+{
+  return static_cast<unsigned char>(c - WORD) <= (DIGIT - WORD);
+}
+
+#ifdef SYNTAXHIGHLIGHTER_X86
+// ---------
+// loadShort
+// ---------
+/**
+ * @brief  This function loads 4 to 15 bytes into the top lanes of a vector
+ *         (the lanes in front of them are zero).
+ *
+ * Two loads of 8 (or 4) bytes overlap in the middle, so nothing behind
+ * the bytes is read.
+ */
+static inline __m128i loadShort(const char* p, size_t size)
+{
+  if (size >= 8)
+  {
+    __m128i first = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    __m128i last  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + size - 8));
+
+    // the bytes shifted out are loaded by last (a shift by 64 clears all)
+    first = _mm_sll_epi64(first, _mm_cvtsi32_si128(static_cast<int>(8 * (16 - size))));
+
+    return _mm_unpacklo_epi64(first, last);
+  }
+
+  int first;
+  int last;
+
+  memcpy(&first, p, 4);
+  memcpy(&last, p + size - 4, 4);
+
+  __m128i top = _mm_or_si128(_mm_sll_epi64(_mm_cvtsi32_si128(first), _mm_cvtsi32_si128(static_cast<int>(8 * (8 - size)))),
+                             _mm_slli_epi64(_mm_cvtsi32_si128(last), 32));
+
+  return _mm_slli_si128(top, 8);
+}
+#endif
+
+// ---------
+// lowestBit
+// ---------
+/**
+ * @brief  This function returns the index of the lowest bit set (mask != 0).
+ */
+static inline unsigned lowestBit(unsigned mask)
+{
+#ifdef __GNUC__
+  return __builtin_ctz(mask);
+#else
+  unsigned index = 0;
+
+  while ((mask & 1) == 0)
+  {
+    mask >>= 1;
+    index += 1;
+  }
+
+  return index;
+#endif
+}
+
+// --------
+// rgbColor
+// --------
+/**
+ * @brief  This function returns the terminal color closest to the given
+ *         24 bit color (each channel is either on or off).
+ */
+static const char* rgbColor(unsigned red, unsigned green, unsigned blue)
+{
+  return TERMINAL[((red >= 128) ? 1 : 0) + ((green >= 128) ? 2 : 0) + ((blue >= 128) ? 4 : 0)];
+}
+
+// ------------
+// paletteColor
+// ------------
+/**
+ * @brief  This function returns the terminal color closest to the given
+ *         color of the 256 color palette.
+ */
+static const char* paletteColor(unsigned index)
+{
+  // the eight colors and their bright variants
+  if (index < 16) return TERMINAL[index % 8];
+
+  // grays
+  if (index >= 232) return 0;
+
+  // 6x6x6 cube (the levels are 0, 95, 135, 175, 215 and 255)
+  static const unsigned LEVELS[6] = { 0, 95, 135, 175, 215, 255 };
+
+  index -= 16;
+
+  return rgbColor(LEVELS[index / 36], LEVELS[(index / 6) % 6], LEVELS[index % 6]);
+}
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// -----------------
+// SyntaxHighlighter
+// -----------------
+/*
+ *
+ */
+SyntaxHighlighter::SyntaxHighlighter()
+{
+  setLanguage(NONE);
+}
+
+
+// -----------------------------------------------------------------------------
+// Initialization                                               Initialization
+// -----------------------------------------------------------------------------
+
+// -----------
+// setLanguage
+// -----------
+/*
+ *
+ */
+void SyntaxHighlighter::setLanguage(Language language)
+{
+  m_language = language;
+
+  for(unsigned i = 0; i < 256; i++)
+  {
+    m_class[i] = OTHER;
+  }
+
+  m_class[static_cast<unsigned char>(' ')]  = SPACE;
+  m_class[static_cast<unsigned char>('\t')] = SPACE;
+  m_class[static_cast<unsigned char>('_')]  = WORD;
+
+  for(char c = 'a'; c <= 'z'; c++) m_class[static_cast<unsigned char>(c)] = WORD;
+  for(char c = 'A'; c <= 'Z'; c++) m_class[static_cast<unsigned char>(c)] = WORD;
+  for(char c = '0'; c <= '9'; c++) m_class[static_cast<unsigned char>(c)] = DIGIT;
+
+  switch (m_language)
+  {
+    case C:
+      m_class[static_cast<unsigned char>('"')]  = QUOTE;
+      m_class[static_cast<unsigned char>('\'')] = QUOTE;
+      m_class[static_cast<unsigned char>('/')]  = SLASH;
+      m_class[static_cast<unsigned char>('#')]  = HASH;
+      break;
+
+    case SHELL:
+      m_class[static_cast<unsigned char>('"')]  = QUOTE;
+      m_class[static_cast<unsigned char>('\'')] = QUOTE;
+      m_class[static_cast<unsigned char>('#')]  = HASH;
+      m_class[static_cast<unsigned char>('$')]  = DOLLAR;
+      break;
+
+    case LATEX:
+      // no identifiers apart from commands
+      for(unsigned i = 0; i < 256; i++)
+      {
+        if (m_class[i] == WORD) m_class[i] = OTHER;
+      }
+
+      m_class[static_cast<unsigned char>('\\')] = BACKSLASH;
+      m_class[static_cast<unsigned char>('%')]  = PERCENT;
+      m_class[static_cast<unsigned char>('$')]  = DOLLAR;
+      break;
+
+    case PYTHON:
+      m_class[static_cast<unsigned char>('"')]  = QUOTE;
+      m_class[static_cast<unsigned char>('\'')] = QUOTE;
+      m_class[static_cast<unsigned char>('#')]  = HASH;
+      break;
+
+    default:
+      break;
+  }
+
+  // the characters that don't belong to words, numbers or spaces
+  unsigned count = 0;
+
+  memset(m_specials, 0, sizeof(m_specials));
+
+  for(unsigned i = 0; i < 256; i++)
+  {
+    if (m_class[i] >= QUOTE) memset(m_specials[count++], static_cast<char>(i), 16);
+  }
+
+  // unused slots repeat the first special character (without any, a NUL
+  // only ends the run of scanWords() early)
+  for(unsigned i = count; i < MAXSPECIALS; i++)
+  {
+    memcpy(m_specials[i], m_specials[0], 16);
+  }
+
+  m_keywords = &KEYWORD_TABLES[m_language];
+
+  reset();
+}
+
+// -----------
+// setLanguage
+// -----------
+/*
+ *
+ */
+bool SyntaxHighlighter::setLanguage(const string& name)
+{
+  if      (name == "none")                         setLanguage(NONE);
+  else if ((name == "c") || (name == "cpp"))       setLanguage(C);
+  else if ((name == "sh") || (name == "bash"))     setLanguage(SHELL);
+  else if ((name == "latex") || (name == "tex"))   setLanguage(LATEX);
+  else if ((name == "python") || (name == "py"))   setLanguage(PYTHON);
+  else if (name == "ansi")                         setLanguage(ANSI);
+  else return false;
+
+  // signalize success
+  return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ----
+// name
+// ----
+/*
+ *
+ */
+const char* SyntaxHighlighter::name() const
+{
+  return NAMES[m_language];
+}
+
+// -----
+// reset
+// -----
+/*
+ *
+ */
+void SyntaxHighlighter::reset()
+{
+  m_state     = CODE;
+  m_quote     = 0;
+  m_comment   = false;
+  m_lineStart = true;
+  m_colored   = false;
+  m_escape    = TEXT;
+  m_params    = 0;
+  m_sgr       = 0;
+}
+
+// ---------
+// highlight
+// ---------
+/*
+ * The plain characters in front of and behind a single trigger are
+ * scanned in one go, so a string like "a!b" isn't torn apart.
+ */
+void SyntaxHighlighter::highlight(const char* line, vector<SpanLexer::Span>& spans, bool continued)
+{
+  m_result.clear();
+
+  // strings, line comments and escape sequences end with the line
+  if ( !continued )
+  {
+    m_quote     = 0;
+    m_comment   = false;
+    m_lineStart = true;
+    m_colored   = false;
+    m_escape    = TEXT;
+  }
+
+  size_t i = 0;
+
+  while (i < spans.size())
+  {
+    const SpanLexer::Span& span = spans[i];
+
+    bool plain = (span.kind == SpanLexer::PLAIN) || (span.kind == SpanLexer::STRAY);
+
+    // the trigger ended the previous part (see SpanLexer::lexPart())
+    if (continued && (i == 0) && (span.kind == SpanLexer::STRAY) && (span.length == 1)) plain = false;
+
+    // keep manual markup
+    if (m_colored || !plain)
+    {
+      if (span.kind == SpanLexer::NAME) m_colored = true;
+      if (span.kind == SpanLexer::END)  m_colored = false;
+
+      m_result.push_back(span);
+
+      m_lineStart = false;
+
+      i += 1;
+
+      continue;
+    }
+
+    // join plain characters and single triggers
+    const char* first = line + span.offset;
+    const char* end   = first + span.length;
+
+    for(i += 1; i < spans.size(); i++)
+    {
+      if ((spans[i].kind != SpanLexer::PLAIN) && (spans[i].kind != SpanLexer::STRAY)) break;
+
+      end = line + spans[i].offset + spans[i].length;
+    }
+
+    if (m_language == ANSI) decode(line, first, end);
+    else                    scan(line, first, end);
+  }
+
+  // keep capacity of both vectors
+  spans.swap(m_result);
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ---------
+// isKeyword
+// ---------
+/*
+ * Empty slots have size 0, which no identifier has.  Identifiers longer
+ * than all keywords aren't hashed at all, and memcmp() is only called if
+ * the first characters match.
+ */
+inline bool SyntaxHighlighter::isKeyword(const char* word, size_t size) const
+{
+  if (size > m_keywords->longest) return false;
+
+  const KeywordSlot& slot = m_keywords->slots[ keywordSlot(word, size, m_keywords->factor, m_keywords->mask) ];
+
+  return (slot.size == size) && (slot.word[0] == word[0]) && (memcmp(slot.word, word, size) == 0);
+}
+
+// --------
+// addPlain
+// --------
+/*
+ *
+ */
+inline void SyntaxHighlighter::addPlain(const char* line, const char* first, const char* end)
+{
+  if (first == end) return;
+
+  size_t offset = first - line;
+
+  // extend recent plain span
+  if (!m_result.empty() && (m_result.back().kind == SpanLexer::PLAIN) &&
+      (m_result.back().offset + m_result.back().length == offset))
+  {
+    m_result.back().length += end - first;
+
+    return;
+  }
+
+  SpanLexer::Span span;
+
+  span.offset = offset;
+  span.length = end - first;
+  span.kind   = SpanLexer::PLAIN;
+  span.color  = 0;
+
+  m_result.push_back(span);
+}
+
+// -------
+// addAuto
+// -------
+/*
+ *
+ */
+inline void SyntaxHighlighter::addAuto(const char* line, const char* first, const char* end, const char* color)
+{
+  if (first == end) return;
+
+  size_t offset = first - line;
+
+  // extend recent span of the same color
+  if (!m_result.empty() && (m_result.back().kind == SpanLexer::AUTO) && (m_result.back().color == color) &&
+      (m_result.back().offset + m_result.back().length == offset))
+  {
+    m_result.back().length += end - first;
+
+    return;
+  }
+
+  SpanLexer::Span span;
+
+  span.offset = offset;
+  span.length = end - first;
+  span.kind   = SpanLexer::AUTO;
+  span.color  = color;
+
+  m_result.push_back(span);
+}
+
+// --------
+// addToken
+// --------
+/*
+ *
+ */
+inline void SyntaxHighlighter::addToken(const char* line, const char*& plain, const char* first, const char* end, const char* color)
+{
+  addPlain(line, plain, first);
+  addAuto(line, first, end, color);
+
+  plain = end;
+}
+
+// --------
+// classify
+// --------
+/*
+ * With SSE2, the letters, digits and underscores are compared 16 at a
+ * time, just like the special characters.  The letters and the underscore
+ * only count where they have the class WORD (not in LaTeX).  The last
+ * bytes of a chunk are loaded together with the bytes in front of them,
+ * so nothing behind the chunk is read.  A line shorter than 16 bytes is
+ * loaded in two overlapping parts (see loadShort()), one shorter than 4
+ * bytes is looked up byte by byte.
+ */
+inline unsigned SyntaxHighlighter::classify(const char* line, const char* chunk, size_t size, bool vector, unsigned& special) const
+{
+  unsigned mask  = 0;
+  unsigned other = 0;
+  size_t   i     = 0;
+
+#ifdef SYNTAXHIGHLIGHTER_X86
+  if ( vector )
+  {
+    const __m128i letter = _mm_set1_epi8((m_class[static_cast<unsigned char>('a')] == WORD) ? static_cast<char>(0xFF) : 0);
+
+    for(; i < size; i += 16)
+    {
+      size_t shift = ((size - i) < 16) ? 16 - (size - i) : 0;
+
+      __m128i x;
+
+      if (static_cast<size_t>(chunk + i - line) >= shift)
+      {
+        x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk + i - shift));
+      }
+
+      // nothing in front to load with the bytes
+      else if ((size - i) >= 4)
+      {
+        x = loadShort(chunk + i, size - i);
+      }
+
+      else break;
+
+      // c - low <= high - low  <=>  min(c - low, high - low) == c - low
+      const __m128i lower = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+      const __m128i digit = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+
+      __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(lower, _mm_set1_epi8('z' - 'a')), lower),
+                                 _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+
+      hit = _mm_or_si128(_mm_and_si128(hit, letter), _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit));
+
+      __m128i found = _mm_cmpeq_epi8(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_specials[0])));
+
+      for(unsigned k = 1; k < MAXSPECIALS; k++)
+      {
+        found = _mm_or_si128(found, _mm_cmpeq_epi8(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_specials[k]))));
+      }
+
+      mask  |= (static_cast<unsigned>(_mm_movemask_epi8(hit))   >> shift) << i;
+      other |= (static_cast<unsigned>(_mm_movemask_epi8(found)) >> shift) << i;
+    }
+  }
+#endif
+
+  // remaining bytes
+  for(; i < size; i++)
+  {
+    unsigned char c = m_class[static_cast<unsigned char>(chunk[i])];
+
+    mask  |= static_cast<unsigned>(isIdentifier(c)) << i;
+    other |= static_cast<unsigned>(c >= QUOTE)      << i;
+  }
+
+  special = other;
+
+  return mask;
+}
+
+// ----
+// scan
+// ----
+/*
+ * The text in front of the next special character is left to
+ * scanWords().  Each special character selects the rule that finds the
+ * end of its token.  Plain tokens aren't added one by one: the characters
+ * from plain up to the next colored token are added in one go.
+ */
+void SyntaxHighlighter::scan(const char* line, const char* first, const char* end)
+{
+  const char* plain = first;
+
+  while (first != end)
+  {
+    // rest of the line
+    if (m_comment)
+    {
+      addToken(line, plain, first, end, COMMENT);
+
+      return;
+    }
+
+    // continued block comment
+    if (m_state == BLOCKCOMMENT)
+    {
+      const char* stop = first;
+
+      while (((end - stop) >= 2) && !((stop[0] == '*') && (stop[1] == '/'))) ++stop;
+
+      if ((end - stop) < 2)
+      {
+        addToken(line, plain, first, end, COMMENT);
+
+        return;
+      }
+
+      addToken(line, plain, first, stop + 2, COMMENT);
+
+      m_state = CODE;
+
+      first = stop + 2;
+
+      continue;
+    }
+
+    // continued string
+    if ((m_state != CODE) || (m_quote != 0))
+    {
+      const char* stop = endOfString(first, end);
+
+      addToken(line, plain, first, stop, STRING);
+
+      first = stop;
+
+      continue;
+    }
+
+    // words, numbers and plain characters up to the next special character
+    first = scanWords(line, plain, first, end);
+
+    if (first == end) break;
+
+    const char* stop = first + 1;
+
+    switch (m_class[static_cast<unsigned char>(*first)])
+    {
+      case QUOTE:
+
+        // triple-quoted string
+        if ((m_language == PYTHON) && ((end - first) >= 3) && (first[1] == *first) && (first[2] == *first))
+        {
+          m_state = (*first == '\'') ? TRIPLESINGLE : TRIPLEDOUBLE;
+
+          stop = endOfString(first + 3, end);
+        }
+
+        else
+        {
+          m_quote = *first;
+
+          stop = endOfString(first + 1, end);
+        }
+
+        addToken(line, plain, first, stop, STRING);
+
+        break;
+
+      case SLASH:
+
+        // line comment
+        if ((stop != end) && (*stop == '/'))
+        {
+          m_comment = true;
+
+          continue;
+        }
+
+        // block comment
+        if ((stop != end) && (*stop == '*'))
+        {
+          addToken(line, plain, first, stop + 1, COMMENT);
+
+          m_state = BLOCKCOMMENT;
+
+          first = stop + 1;
+
+          continue;
+        }
+
+        break;
+
+      case HASH:
+
+        // preprocessor directive
+        if (m_language == C)
+        {
+          if (m_lineStart)
+          {
+            while ((stop != end) && (m_class[static_cast<unsigned char>(*stop)] == SPACE)) ++stop;
+            while ((stop != end) && (m_class[static_cast<unsigned char>(*stop)] == WORD))  ++stop;
+
+            addToken(line, plain, first, stop, DIRECTIVE);
+          }
+
+          break;
+        }
+
+        // the shell only starts comments at the start of a word
+        if ((m_language == PYTHON) || (first == line) || (m_class[static_cast<unsigned char>(first[-1])] == SPACE))
+        {
+          m_comment = true;
+
+          continue;
+        }
+
+        break;
+
+      case DOLLAR:
+
+        // inline math
+        if (m_language == LATEX)
+        {
+          while ((stop != end) && (*stop != '$')) ++stop;
+
+          if (stop != end) ++stop;
+
+          addToken(line, plain, first, stop, NUMBER);
+
+          break;
+        }
+
+        // shell variable
+        if (stop != end)
+        {
+          if (*stop == '{')
+          {
+            while ((stop != end) && (*stop != '}')) ++stop;
+
+            if (stop != end) ++stop;
+          }
+
+          else if (m_class[static_cast<unsigned char>(*stop)] == WORD)
+          {
+            while ((stop != end) && isIdentifier(m_class[static_cast<unsigned char>(*stop)])) ++stop;
+          }
+
+          // positional and special parameters
+          else if ((m_class[static_cast<unsigned char>(*stop)] == DIGIT) || (memchr("?#@*$!-", *stop, 7) != 0))
+          {
+            ++stop;
+          }
+        }
+
+        if ((stop - first) > 1) addToken(line, plain, first, stop, VARIABLE);
+
+        break;
+
+      case BACKSLASH:
+
+        // command name or a single character
+        if (stop != end)
+        {
+          if ( isLetter(*stop) )
+          {
+            while ((stop != end) && isLetter(*stop)) ++stop;
+          }
+
+          else
+          {
+            ++stop;
+          }
+        }
+
+        addToken(line, plain, first, stop, KEYWORD);
+
+        break;
+
+      case PERCENT:
+
+        m_comment = true;
+
+        continue;
+
+      default:
+        break;
+    }
+
+    m_lineStart = false;
+
+    first = stop;
+  }
+
+  addPlain(line, plain, end);
+}
+
+// ---------
+// scanWords
+// ---------
+/*
+ * Each character of a chunk has a bit in two masks (see classify()): a
+ * word starts at each identifier bit whose predecessor isn't set and ends
+ * at the next clear bit, so the characters are classified without a
+ * branch per character.  A number may go on behind a dot, the words found
+ * within it are passed.
+ */
+const char* SyntaxHighlighter::scanWords(const char* line, const char*& plain, const char* first, const char* end)
+{
+  const bool vector = (ByteScanner::getLevel() != ByteScanner::SCALAR);
+
+  // behind the recent number
+  const char* passed = first;
+
+  // a word continued from the previous chunk doesn't start again
+  unsigned carry = 0;
+
+  for(const char* chunk = first; chunk < end; chunk += CHUNK)
+  {
+    size_t size = ((end - chunk) < static_cast<ptrdiff_t>(CHUNK)) ? (end - chunk) : CHUNK;
+
+    unsigned special = 0;
+    unsigned mask    = classify(line, chunk, size, vector, special);
+
+    // the run ends in front of the first special character
+    if (special != 0)
+    {
+      size = lowestBit(special);
+
+      mask &= (1u << size) - 1;
+    }
+
+    // a directive (C) must be the first token
+    if (m_lineStart && (mask != 0)) m_lineStart = false;
+
+    if (m_lineStart)
+    {
+      size_t i = 0;
+
+      while ((i < size) && (m_class[static_cast<unsigned char>(chunk[i])] == SPACE)) i++;
+
+      if (i < size) m_lineStart = false;
+    }
+
+    unsigned starts = mask & ~((mask << 1) | carry);
+
+    while (starts != 0)
+    {
+      unsigned index = lowestBit(starts);
+
+      starts &= starts - 1;
+
+      const char* word = chunk + index;
+
+      if (word < passed) continue;
+
+      // the clear bits shifted in at the top end the word within the chunk
+      const char* stop = word + lowestBit(~(mask >> index));
+
+      // continued in the next chunk
+      if (stop == chunk + CHUNK)
+      {
+        while ((stop != end) && isIdentifier(m_class[static_cast<unsigned char>(*stop)])) ++stop;
+      }
+
+      // number (which goes on behind a dot)
+      if (m_class[static_cast<unsigned char>(*word)] == DIGIT)
+      {
+        while ((stop != end) && ((*stop == '.') || isIdentifier(m_class[static_cast<unsigned char>(*stop)]))) ++stop;
+
+        addToken(line, plain, word, stop, NUMBER);
+
+        passed = stop;
+
+        continue;
+      }
+
+      if ( isKeyword(word, stop - word) ) addToken(line, plain, word, stop, KEYWORD);
+    }
+
+    if (special != 0) return chunk + size;
+
+    carry = mask >> (CHUNK - 1);
+  }
+
+  return end;
+}
+
+// ------
+// decode
+// ------
+/*
+ * The text between the escape sequences is found by memchr(), so only
+ * the sequences themselves are looked at character by character.  A
+ * sequence broken by an unexpected character ends in front of it.
+ */
+void SyntaxHighlighter::decode(const char* line, const char* first, const char* end)
+{
+  while (first != end)
+  {
+    // text up to the next escape sequence
+    if (m_escape == TEXT)
+    {
+      const char* stop = static_cast<const char*>(memchr(first, ESC, end - first));
+
+      if (stop == 0) stop = end;
+
+      if (m_sgr != 0) addAuto(line, first, stop, m_sgr);
+      else            addPlain(line, first, stop);
+
+      if (stop == end) return;
+
+      m_escape = ESCAPE;
+
+      first = stop + 1;
+
+      continue;
+    }
+
+    unsigned char c = *first++;
+
+    switch (m_escape)
+    {
+      case ESCAPE:
+
+        // control sequence
+        if (c == '[')
+        {
+          m_escape   = CONTROL;
+          m_params   = 0;
+          m_param[0] = 0;
+        }
+
+        // command string (OSC, DCS, SOS, PM or APC)
+        else if (memchr("]PX^_", c, 5) != 0) m_escape = COMMAND;
+
+        // intermediate character
+        else if ((c >= 0x20) && (c <= 0x2F)) m_escape = FUNCTION;
+
+        // two characters (like ESC 7)
+        else if ((c >= 0x30) && (c <= 0x7E)) m_escape = TEXT;
+
+        // broken sequence
+        else if (c != static_cast<unsigned char>(ESC))
+        {
+          m_escape = TEXT;
+
+          --first;
+        }
+
+        break;
+
+      case FUNCTION:
+
+        if ((c >= 0x20) && (c <= 0x2F)) break;
+
+        m_escape = TEXT;
+
+        // broken sequence
+        if ((c < 0x30) || (c > 0x7E)) --first;
+
+        break;
+
+      case CONTROL:
+      case IGNORED:
+
+        if ((c >= '0') && (c <= '9'))
+        {
+          unsigned* param = m_param + m_params;
+
+          // larger numbers don't mean anything
+          if ((m_params < MAXPARAMS) && (*param < 10000)) *param = 10 * *param + (c - '0');
+        }
+
+        // next parameter
+        else if ((c == ';') || (c == ':'))
+        {
+          if (m_params < MAXPARAMS) m_params += 1;
+
+          if (m_params < MAXPARAMS) m_param[m_params] = 0;
+        }
+
+        // private parameters and intermediate characters aren't used by SGR
+        else if (((c >= 0x3C) && (c <= 0x3F)) || ((c >= 0x20) && (c <= 0x2F))) m_escape = IGNORED;
+
+        // final character
+        else if ((c >= 0x40) && (c <= 0x7E))
+        {
+          if ((c == 'm') && (m_escape == CONTROL)) applyColors();
+
+          m_escape = TEXT;
+        }
+
+        // broken sequence
+        else
+        {
+          m_escape = TEXT;
+
+          --first;
+        }
+
+        break;
+
+      case COMMAND:
+
+        if      (c == static_cast<unsigned char>(BEL)) m_escape = TEXT;
+        else if (c == static_cast<unsigned char>(ESC)) m_escape = COMMANDESC;
+
+        break;
+
+      case COMMANDESC:
+
+        // ESC \ ends the string, any other ESC starts a new sequence
+        if (c == '\\')
+        {
+          m_escape = TEXT;
+        }
+
+        else
+        {
+          m_escape = ESCAPE;
+
+          --first;
+        }
+
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+// -----------
+// applyColors
+// -----------
+/*
+ * Only the foreground color is used.  Attributes like bold and the
+ * background color are ignored, just like the parameters of extended
+ * colors in front of a color they don't belong to.
+ */
+void SyntaxHighlighter::applyColors()
+{
+  unsigned count = (m_params < MAXPARAMS) ? m_params + 1 : MAXPARAMS;
+
+  for(unsigned i = 0; i < count; i++)
+  {
+    unsigned param = m_param[i];
+
+    // reset or default color
+    if ((param == 0) || (param == 39))
+    {
+      m_sgr = 0;
+    }
+
+    // the eight colors and their bright variants
+    else if (((param >= 30) && (param <= 37)) || ((param >= 90) && (param <= 97)))
+    {
+      m_sgr = TERMINAL[param % 10];
+    }
+
+    // extended foreground and background colors
+    else if ((param == 38) || (param == 48))
+    {
+      const char* color = m_sgr;
+
+      if ((i + 2 < count) && (m_param[i + 1] == 5))
+      {
+        color = paletteColor(m_param[i + 2]);
+
+        i += 2;
+      }
+
+      else if ((i + 4 < count) && (m_param[i + 1] == 2))
+      {
+        color = rgbColor(m_param[i + 2], m_param[i + 3], m_param[i + 4]);
+
+        i += 4;
+      }
+
+      if (param == 38) m_sgr = color;
+    }
+  }
+}
+
+// -----------
+// endOfString
+// -----------
+/*
+ * A backslash escapes the next character, except within single quotes
+ * of the shell.
+ */
+const char* SyntaxHighlighter::endOfString(const char* first, const char* end)
+{
+  char quote  = m_quote;
+  bool triple = (m_state != CODE);
+
+  if (m_state == TRIPLESINGLE) quote = '\'';
+  if (m_state == TRIPLEDOUBLE) quote = '"';
+
+  bool escapes = !((m_language == SHELL) && (quote == '\''));
+
+  while (first != end)
+  {
+    if (escapes && (*first == '\\'))
+    {
+      first += ((end - first) > 1) ? 2 : 1;
+
+      continue;
+    }
+
+    if (*first == quote)
+    {
+      if ( !triple )
+      {
+        m_quote = 0;
+
+        return first + 1;
+      }
+
+      if (((end - first) >= 3) && (first[1] == quote) && (first[2] == quote))
+      {
+        m_state = CODE;
+
+        return first + 3;
+      }
+    }
+
+    ++first;
+  }
+
+  return end;
+}
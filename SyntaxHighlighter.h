@@ -0,0 +1,390 @@
+// -----------------------------------------------------------------------------
+// SyntaxHighlighter.h                                       SyntaxHighlighter.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref SyntaxHighlighter class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef SYNTAXHIGHLIGHTER_H_INCLUDE_NO1
+#define SYNTAXHIGHLIGHTER_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "SpanLexer.h"
+
+
+// -----------------------------------------------------------------------------
+// Declarations                                                     Declarations
+// -----------------------------------------------------------------------------
+struct KeywordTable;
+
+
+// -----------------
+// SyntaxHighlighter
+// -----------------
+/**
+ * @brief  This class colors the plain code of a few languages.
+ *
+ * The plain spans of each line are split into tokens by a character
+ * class table that is built for the language.  Comments become green,
+ * strings red, keywords blue, numbers magenta, preprocessor directives
+ * cyan and shell variables yellow (the colors of openGroup()).  Keywords
+ * are looked up in a perfect hash table, so each identifier is compared
+ * with a single keyword at most.  The tables are static data generated
+ * by bench/keywords.cpp (see SyntaxKeywords.h), so selecting a language
+ * doesn't search anything.
+ *
+ * Manual markup is left alone, and a single trigger is treated like any
+ * other plain character.  Block comments and triple-quoted strings are
+ * continued on the next line, so the lines must be passed in order.
+ *
+ * The ANSI "language" colors terminal output instead: the foreground
+ * colors of SGR sequences (like ESC [ 1 ; 31 m) select the closest color
+ * of openGroup(), and all escape sequences are dropped.  They aren't
+ * covered by any span, so the line isn't copied.  The color lasts until
+ * the next SGR sequence, even across lines.  An escape sequence may be
+ * split across the parts of a line (see SpanLexer::lexPart()), so long
+ * lines don't have to be read as a whole.
+ */
+class SyntaxHighlighter
+{
+
+public:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// the supported languages
+  enum Language
+  {
+    NONE,    ///< no highlighting
+    C,       ///< C and C++
+    SHELL,   ///< POSIX shell and bash
+    LATEX,   ///< LaTeX
+    PYTHON,  ///< Python
+    ANSI     ///< ANSI escape sequences of terminal output
+  };
+
+  /// the parameters of an escape sequence beyond are ignored
+  static const unsigned MAXPARAMS = 16;
+
+  /// the number of characters that start comments, strings and the like
+  static const unsigned MAXSPECIALS = 4;
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // -----------------
+  // SyntaxHighlighter
+  // -----------------
+  /**
+   * @brief  The standard-constructor (no highlighting).
+   */
+  SyntaxHighlighter();
+
+
+  // ---------------------------------------------------------------------------
+  // Initialization                                               Initialization
+  // ---------------------------------------------------------------------------
+
+  // -----------
+  // setLanguage
+  // -----------
+  /**
+   * @brief  This method selects the language and forgets the recent state.
+   */
+  void setLanguage(Language language);
+
+  // -----------
+  // setLanguage
+  // -----------
+  /**
+   * @brief  This method selects the language by its name
+   *         (none, c, cpp, sh, bash, latex, tex, python or ansi).
+   *
+   * @return  false if the name is unknown
+   */
+  bool setLanguage(const std::string& name);
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // --------
+  // language
+  // --------
+  /**
+   * @brief  This method returns the selected language.
+   */
+  Language language() const
+  {
+    return m_language;
+  }
+
+  // ----------
+  // wholeLines
+  // ----------
+  /**
+   * @brief  This method tells whether the language needs whole lines
+   *         (all but NONE and ANSI).
+   */
+  bool wholeLines() const
+  {
+    return (m_language != NONE) && (m_language != ANSI);
+  }
+
+  // ----
+  // name
+  // ----
+  /**
+   * @brief  This method returns the name of the selected language.
+   */
+  const char* name() const;
+
+  // -----
+  // reset
+  // -----
+  /**
+   * @brief  This method forgets comments, strings and the terminal color
+   *         of the previous lines.
+   */
+  void reset();
+
+  // ---------
+  // highlight
+  // ---------
+  /**
+   * @brief  This method replaces the plain spans of a line by colored ones.
+   *
+   * @param line       points to the first character of the line (or part).
+   * @param spans      holds the spans of the line (see SpanLexer::lex()).
+   * @param continued  set true if the spans belong to a further part of
+   *                   the line (see SpanLexer::lexPart(), ANSI only).
+   */
+  void highlight(const char* line, std::vector<SpanLexer::Span>& spans, bool continued = false);
+
+  // -----------
+  // keywordSlot
+  // -----------
+  /**
+   * @brief  This method returns the slot of an identifier in a keyword table:
+   *
+   *   (size * f[0] + first * f[1] + last * f[2] + middle * f[3]) & mask
+   */
+  static unsigned keywordSlot(const char* word, std::size_t size, const unsigned* factor, unsigned mask)
+  {
+    const unsigned char* w = reinterpret_cast<const unsigned char*>(word);
+
+    return (static_cast<unsigned>(size) * factor[0] + w[0] * factor[1] + w[size - 1] * factor[2] + w[size / 2] * factor[3]) & mask;
+  }
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // scan
+  // ----
+  /**
+   * @brief  This method splits a run of plain characters into tokens.
+   *
+   * @param line   points to the first character of the line.
+   * @param first  points to the first character of the run.
+   * @param end    points behind the last character of the run.
+   */
+  void scan(const char* line, const char* first, const char* end);
+
+  // ---------
+  // scanWords
+  // ---------
+  /**
+   * @brief  This method colors the numbers and keywords in front of the
+   *         next special character (see m_specials).
+   *
+   * @param line   points to the first character of the line.
+   * @param plain  points to the first plain character not appended yet.
+   * @param first  points to the first character of the run.
+   * @param end    points behind the last character of the run.
+   *
+   * @return  the special character (or end)
+   */
+  const char* scanWords(const char* line, const char*& plain, const char* first, const char* end);
+
+  // --------
+  // classify
+  // --------
+  /**
+   * @brief  This method returns a mask with bit i set if chunk[i] may be
+   *         part of an identifier or a number (size <= 32).
+   *
+   * @param vector   set true to use SSE2 (if compiled in).
+   * @param special  receives a mask with bit i set if chunk[i] is special.
+   */
+  unsigned classify(const char* line, const char* chunk, std::size_t size, bool vector, unsigned& special) const;
+
+  // ------
+  // decode
+  // ------
+  /**
+   * @brief  This method splits a run of plain characters into the text
+   *         and the escape sequences of terminal output (ANSI).
+   *
+   * @param line   points to the first character of the line.
+   * @param first  points to the first character of the run.
+   * @param end    points behind the last character of the run.
+   */
+  void decode(const char* line, const char* first, const char* end);
+
+  // -----------
+  // applyColors
+  // -----------
+  /**
+   * @brief  This method selects the color of the recent SGR sequence.
+   */
+  void applyColors();
+
+  // ---------
+  // isKeyword
+  // ---------
+  /**
+   * @brief  This method looks up an identifier in the keyword table.
+   */
+  bool isKeyword(const char* word, std::size_t size) const;
+
+  // -----------
+  // endOfString
+  // -----------
+  /**
+   * @brief  This method returns the character behind the closing quote
+   *         (or end) and updates the state.
+   */
+  const char* endOfString(const char* first, const char* end);
+
+  // --------
+  // addPlain
+  // --------
+  /**
+   * @brief  This method appends plain characters (merged with plain
+   *         characters right in front of them).
+   */
+  void addPlain(const char* line, const char* first, const char* end);
+
+  // -------
+  // addAuto
+  // -------
+  /**
+   * @brief  This method appends colored characters (merged with characters
+   *         of the same color right in front of them).
+   */
+  void addAuto(const char* line, const char* first, const char* end, const char* color);
+
+  // --------
+  // addToken
+  // --------
+  /**
+   * @brief  This method appends the plain characters in front of a colored
+   *         token and the token itself (see scan()).
+   *
+   * @param plain  points to the first plain character not appended yet
+   *               and is moved behind the token.
+   */
+  void addToken(const char* line, const char*& plain, const char* first, const char* end, const char* color);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Types                                                                 Types
+  // ---------------------------------------------------------------------------
+
+  /// constructs that are continued on the next line
+  enum State
+  {
+    CODE,          ///< nothing continued
+    BLOCKCOMMENT,  ///< within /* */
+    TRIPLESINGLE,  ///< within '''
+    TRIPLEDOUBLE   ///< within """
+  };
+
+  /// the parts of an escape sequence (ANSI)
+  enum Escape
+  {
+    TEXT,      ///< outside of escape sequences
+    ESCAPE,    ///< behind ESC
+    FUNCTION,  ///< behind ESC and intermediate characters (like ESC ( B)
+    CONTROL,   ///< within the parameters of a control sequence (ESC [)
+    IGNORED,   ///< within a control sequence other than SGR
+    COMMAND,   ///< within a command string (up to BEL or ESC \\)
+    COMMANDESC ///< behind ESC within a command string
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the selected language
+  Language m_language;
+
+  /// the class of each character (built by setLanguage())
+  unsigned char m_class[256];
+
+  /// the characters that start neither words nor numbers nor spaces (each
+  /// one repeated 16 times, so SSE2 loads it as it is)
+  char m_specials[MAXSPECIALS][16];
+
+  /// the keyword table of the selected language (see SyntaxKeywords.h)
+  const KeywordTable* m_keywords;
+
+  /// the construct continued from the previous line
+  State m_state;
+
+  /// the quote of the recent string (0 outside of strings)
+  char m_quote;
+
+  /// the rest of the line is a comment
+  bool m_comment;
+
+  /// no characters apart from spaces and tabs so far
+  bool m_lineStart;
+
+  /// within manual markup (kept between the parts of a line)
+  bool m_colored;
+
+  /// the part of the recent escape sequence
+  Escape m_escape;
+
+  /// the parameters of the recent control sequence
+  unsigned m_param[MAXPARAMS];
+
+  /// the parameter being read (MAXPARAMS if there are too many)
+  unsigned m_params;
+
+  /// the color of the recent SGR sequence (0 for the default color)
+  const char* m_sgr;
+
+  /// the spans of the recent line
+  std::vector<SpanLexer::Span> m_result;
+
+};
+
+#endif  /* #ifndef SYNTAXHIGHLIGHTER_H_INCLUDE_NO1 */
@@ -0,0 +1,283 @@
+// -----------------------------------------------------------------------------
+// SyntaxKeywords.h                                             SyntaxKeywords.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the keyword tables of the @ref SyntaxHighlighter class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ *
+ * This file is generated by bench/keywords.cpp ('make keywords'), so the
+ * keywords are changed there.  Each keyword lies in the slot given by
+ * SyntaxHighlighter::keywordSlot(), and no two keywords share a slot.
+ * It is included by SyntaxHighlighter.cpp only.
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef SYNTAXKEYWORDS_H_INCLUDE_NO1
+#define SYNTAXKEYWORDS_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstddef>
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// -----------
+// KeywordSlot
+// -----------
+/**
+ * @brief  A slot of a keyword table.
+ */
+struct KeywordSlot
+{
+  const char* word;  ///< the keyword (0 if the slot is empty)
+  std::size_t size;  ///< the number of characters (0 if the slot is empty)
+};
+
+// ------------
+// KeywordTable
+// ------------
+/**
+ * @brief  The keyword table of a language.
+ */
+struct KeywordTable
+{
+  const KeywordSlot* slots;      ///< the slots (0 if the language has no keywords)
+  unsigned           mask;       ///< the number of slots minus one
+  unsigned           factor[4];  ///< the factors of the hash function
+  std::size_t        longest;    ///< the number of characters of the longest keyword
+};
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the keywords of "c" (indexed by SyntaxHighlighter::keywordSlot())
+static const KeywordSlot C_SLOTS[256] =
+{
+  { 0, 0 },                      { "auto", 4 },
+  { "const", 5 },                { "this", 4 },
+  { "nullptr", 7 },              { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "enum", 4 },
+  { 0, 0 },                      { "template", 8 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "signed", 6 },               { "case", 4 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "alignof", 7 },              { 0, 0 },
+  { "operator", 8 },             { "long", 4 },
+  { "struct", 6 },               { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "else", 4 },
+  { "dynamic_cast", 12 },        { "throw", 5 },
+  { 0, 0 },                      { 0, 0 },
+  { "export", 6 },               { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "int", 3 },                  { 0, 0 },
+  { "float", 5 },                { "goto", 4 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "typename", 8 },
+  { 0, 0 },                      { 0, 0 },
+  { "if", 2 },                   { "decltype", 8 },
+  { "protected", 9 },            { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "continue", 8 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "alignas", 7 },
+  { 0, 0 },                      { 0, 0 },
+  { "static_assert", 13 },       { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "try", 3 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "bool", 4 },                 { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "constexpr", 9 },            { 0, 0 },
+  { "final", 5 },                { 0, 0 },
+  { 0, 0 },                      { "break", 5 },
+  { 0, 0 },                      { "override", 8 },
+  { 0, 0 },                      { 0, 0 },
+  { "virtual", 7 },              { 0, 0 },
+  { 0, 0 },                      { "inline", 6 },
+  { "noexcept", 8 },             { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "catch", 5 },                { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "namespace", 9 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "sizeof", 6 },               { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "static", 6 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "typedef", 7 },              { 0, 0 },
+  { "wchar_t", 7 },              { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "return", 6 },               { 0, 0 },
+  { "unsigned", 8 },             { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "false", 5 },
+  { "thread_local", 12 },        { 0, 0 },
+  { "short", 5 },                { 0, 0 },
+  { "union", 5 },                { 0, 0 },
+  { "static_cast", 11 },         { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "do", 2 },
+  { 0, 0 },                      { 0, 0 },
+  { "explicit", 8 },             { "double", 6 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "char", 4 },                 { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "public", 6 },
+  { "void", 4 },                 { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "register", 8 },             { 0, 0 },
+  { "const_cast", 10 },          { 0, 0 },
+  { "extern", 6 },               { "private", 7 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "true", 4 },
+  { "char16_t", 8 },             { "volatile", 8 },
+  { 0, 0 },                      { "class", 5 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "new", 3 },
+  { 0, 0 },                      { 0, 0 },
+  { "restrict", 8 },             { 0, 0 },
+  { 0, 0 },                      { "while", 5 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "mutable", 7 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "friend", 6 },               { 0, 0 },
+  { "reinterpret_cast", 16 },    { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "delete", 6 },
+  { 0, 0 },                      { 0, 0 },
+  { "default", 7 },              { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "switch", 6 },               { 0, 0 },
+  { "char32_t", 8 },             { 0, 0 },
+  { 0, 0 },                      { "using", 5 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "for", 3 },                  { 0, 0 }
+};
+
+/// the keywords of "sh" (indexed by SyntaxHighlighter::keywordSlot())
+static const KeywordSlot SHELL_SLOTS[64] =
+{
+  { 0, 0 },                      { 0, 0 },
+  { "then", 4 },                 { "else", 4 },
+  { "while", 5 },                { "echo", 4 },
+  { 0, 0 },                      { "time", 4 },
+  { "in", 2 },                   { "fi", 2 },
+  { 0, 0 },                      { "do", 2 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "set", 3 },
+  { "if", 2 },                   { 0, 0 },
+  { "select", 6 },               { 0, 0 },
+  { 0, 0 },                      { "esac", 4 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "done", 4 },
+  { 0, 0 },                      { "for", 3 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "shift", 5 },
+  { "export", 6 },               { 0, 0 },
+  { 0, 0 },                      { "exec", 4 },
+  { 0, 0 },                      { "readonly", 8 },
+  { "exit", 4 },                 { "source", 6 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "until", 5 },
+  { 0, 0 },                      { 0, 0 },
+  { "eval", 4 },                 { "unset", 5 },
+  { "break", 5 },                { 0, 0 },
+  { 0, 0 },                      { "local", 5 },
+  { "declare", 7 },              { "continue", 8 },
+  { "trap", 4 },                 { 0, 0 },
+  { "function", 8 },             { "case", 4 },
+  { "return", 6 },               { 0, 0 },
+  { "elif", 4 },                 { 0, 0 }
+};
+
+/// the keywords of "python" (indexed by SyntaxHighlighter::keywordSlot())
+static const KeywordSlot PYTHON_SLOTS[64] =
+{
+  { 0, 0 },                      { "finally", 7 },
+  { 0, 0 },                      { "del", 3 },
+  { 0, 0 },                      { 0, 0 },
+  { "return", 6 },               { "break", 5 },
+  { 0, 0 },                      { "False", 5 },
+  { "and", 3 },                  { 0, 0 },
+  { "while", 5 },                { "assert", 6 },
+  { "None", 4 },                 { "raise", 5 },
+  { 0, 0 },                      { "not", 3 },
+  { "lambda", 6 },               { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { "async", 5 },                { "else", 4 },
+  { "class", 5 },                { "for", 3 },
+  { 0, 0 },                      { "elif", 4 },
+  { 0, 0 },                      { "global", 6 },
+  { "yield", 5 },                { 0, 0 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "with", 4 },
+  { 0, 0 },                      { "try", 3 },
+  { 0, 0 },                      { 0, 0 },
+  { "from", 4 },                 { "import", 6 },
+  { 0, 0 },                      { "if", 2 },
+  { 0, 0 },                      { "continue", 8 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "except", 6 },
+  { "True", 4 },                 { "def", 3 },
+  { "nonlocal", 8 },             { "as", 2 },
+  { 0, 0 },                      { 0, 0 },
+  { 0, 0 },                      { "or", 2 },
+  { "pass", 4 },                 { "in", 2 },
+  { 0, 0 },                      { "is", 2 },
+  { "await", 5 },                { 0, 0 }
+};
+
+/// the keyword tables (indexed by SyntaxHighlighter::Language)
+static const KeywordTable KEYWORD_TABLES[] =
+{
+  { 0,               0, {  0,  0,  0,  0 },  0 },  // none
+  { C_SLOTS,       255, {  2,  8, 23, 22 }, 16 },  // c
+  { SHELL_SLOTS,    63, {  1,  4,  3, 20 },  8 },  // sh
+  { 0,               0, {  0,  0,  0,  0 },  0 },  // latex
+  { PYTHON_SLOTS,   63, {  7, 25, 24,  2 },  8 },  // python
+  { 0,               0, {  0,  0,  0,  0 },  0 }   // ansi
+};
+
+#endif  /* #ifndef SYNTAXKEYWORDS_H_INCLUDE_NO1 */
@@ -0,0 +1,230 @@
+// -----------------------------------------------------------------------------
+// WorkerPool.cpp                                                 WorkerPool.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the implementation of the @ref WorkerPool class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <unistd.h>  /* sysconf() */
+#include "WorkerPool.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Construction                                                     Construction
+// -----------------------------------------------------------------------------
+
+// ----------
+// WorkerPool
+// ----------
+/*
+ *
+ */
+WorkerPool::WorkerPool(unsigned threads)
+{
+  m_busy    = 0;
+  m_stop    = false;
+  m_started = 0;
+
+  pthread_mutex_init(&m_mutex, 0);
+  pthread_cond_init(&m_wake, 0);
+  pthread_cond_init(&m_done, 0);
+
+  // one thread per processor
+  if (threads == 0) threads = processors();
+
+  for(unsigned i = 0; i < threads; i++)
+  {
+    pthread_t thread;
+
+    if (pthread_create(&thread, 0, &WorkerPool::work, this) == 0)
+    {
+      m_threads.push_back(thread);
+    }
+  }
+}
+
+// -----------
+// ~WorkerPool
+// -----------
+/*
+ *
+ */
+WorkerPool::~WorkerPool()
+{
+  // finish all tasks
+  wait();
+
+  pthread_mutex_lock(&m_mutex);
+  m_stop = true;
+  pthread_cond_broadcast(&m_wake);
+  pthread_mutex_unlock(&m_mutex);
+
+  for(vector<pthread_t>::size_type i = 0; i < m_threads.size(); i++)
+  {
+    pthread_join(m_threads[i], 0);
+  }
+
+  pthread_cond_destroy(&m_done);
+  pthread_cond_destroy(&m_wake);
+  pthread_mutex_destroy(&m_mutex);
+}
+
+
+// -----------------------------------------------------------------------------
+// Handling                                                             Handling
+// -----------------------------------------------------------------------------
+
+// ------
+// submit
+// ------
+/*
+ * Without any worker thread the task runs immediately (as worker 0).
+ */
+void WorkerPool::submit(Task* task)
+{
+  if ( m_threads.empty() )
+  {
+    task->m_worker = 0;
+
+    task->run();
+
+    task->m_finished = true;
+
+    return;
+  }
+
+  pthread_mutex_lock(&m_mutex);
+  task->m_finished = false;
+  m_queue.push_back(task);
+  pthread_cond_signal(&m_wake);
+  pthread_mutex_unlock(&m_mutex);
+}
+
+// ----
+// wait
+// ----
+/*
+ *
+ */
+void WorkerPool::wait()
+{
+  pthread_mutex_lock(&m_mutex);
+
+  while (!m_queue.empty() || (m_busy > 0))
+  {
+    pthread_cond_wait(&m_done, &m_mutex);
+  }
+
+  pthread_mutex_unlock(&m_mutex);
+}
+
+// ----
+// wait
+// ----
+/*
+ *
+ */
+void WorkerPool::wait(Task* task)
+{
+  pthread_mutex_lock(&m_mutex);
+
+  while ( !task->m_finished )
+  {
+    pthread_cond_wait(&m_done, &m_mutex);
+  }
+
+  pthread_mutex_unlock(&m_mutex);
+}
+
+// ----
+// size
+// ----
+/*
+ *
+ */
+unsigned WorkerPool::size() const
+{
+  return m_threads.size();
+}
+
+// ----------
+// processors
+// ----------
+/*
+ *
+ */
+unsigned WorkerPool::processors()
+{
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (count > 0) ? static_cast<unsigned>(count) : 1;
+}
+
+
+// -----------------------------------------------------------------------------
+// Internal methods                                             Internal methods
+// -----------------------------------------------------------------------------
+
+// ----
+// work
+// ----
+/*
+ * The threads are numbered in the order they start.
+ */
+void* WorkerPool::work(void* pool)
+{
+  WorkerPool& self = *static_cast<WorkerPool*>(pool);
+
+  pthread_mutex_lock(&self.m_mutex);
+
+  unsigned worker = self.m_started++;
+
+  while (true)
+  {
+    // wait for next task
+    while (self.m_queue.empty() && !self.m_stop)
+    {
+      pthread_cond_wait(&self.m_wake, &self.m_mutex);
+    }
+
+    if ( self.m_queue.empty() ) break;
+
+    Task* task = self.m_queue.front();
+
+    self.m_queue.pop_front();
+
+    self.m_busy += 1;
+
+    task->m_worker = worker;
+
+    // run task without holding the lock
+    pthread_mutex_unlock(&self.m_mutex);
+
+    task->run();
+
+    pthread_mutex_lock(&self.m_mutex);
+
+    self.m_busy -= 1;
+
+    task->m_finished = true;
+
+    pthread_cond_broadcast(&self.m_done);
+  }
+
+  pthread_mutex_unlock(&self.m_mutex);
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+// -----------------------------------------------------------------------------
+// WorkerPool.h                                                     WorkerPool.h
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the definition of the @ref WorkerPool class.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ */
+
+// -----------------------------------------------------------------------------
+// One-Definition-Rule                                       One-Definition-Rule
+// -----------------------------------------------------------------------------
+#ifndef WORKERPOOL_H_INCLUDE_NO1
+#define WORKERPOOL_H_INCLUDE_NO1
+
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+
+// ----------
+// WorkerPool
+// ----------
+/**
+ * @brief  This class runs tasks on a fixed number of threads.
+ *
+ * Tasks are started in the order they have been submitted.
+ * The pool never takes ownership of a task.  Each task knows the
+ * thread it runs on, so tasks may keep data per thread (see
+ * Task::worker()).
+ */
+class WorkerPool
+{
+
+public:
+
+  // ----
+  // Task
+  // ----
+  /**
+   * @brief  The base class of all tasks.
+   */
+  class Task
+  {
+
+  public:
+
+    /// the constructor
+    Task() : m_finished(false), m_worker(0) {}
+
+    /// the destructor
+    virtual ~Task() {}
+
+    /// this method is called by one of the worker threads
+    virtual void run() = 0;
+
+    /// the number of the thread that runs the task (0 to size() - 1)
+    unsigned worker() const
+    {
+      return m_worker;
+    }
+
+  private:
+
+    /// run() has returned (protected by the pool's mutex)
+    bool m_finished;
+
+    /// the number of the thread that runs the task
+    unsigned m_worker;
+
+    friend class WorkerPool;
+
+  };
+
+
+  // ---------------------------------------------------------------------------
+  // Construction                                                   Construction
+  // ---------------------------------------------------------------------------
+
+  // ----------
+  // WorkerPool
+  // ----------
+  /**
+   * @brief  The constructor starts the worker threads.
+   *
+   * @param threads  holds the number of threads (0 means one per processor).
+   */
+  explicit WorkerPool(unsigned threads);
+
+  // -----------
+  // ~WorkerPool
+  // -----------
+  /**
+   * @brief  The destructor waits for all tasks and stops the threads.
+   */
+  ~WorkerPool();
+
+
+  // ---------------------------------------------------------------------------
+  // Handling                                                           Handling
+  // ---------------------------------------------------------------------------
+
+  // ------
+  // submit
+  // ------
+  /**
+   * @brief  This method queues the given task.
+   */
+  void submit(Task* task);
+
+  // ----
+  // wait
+  // ----
+  /**
+   * @brief  This method blocks until all submitted tasks have finished.
+   */
+  void wait();
+
+  // ----
+  // wait
+  // ----
+  /**
+   * @brief  This method blocks until the given task has finished.
+   */
+  void wait(Task* task);
+
+  // ----
+  // size
+  // ----
+  /**
+   * @brief  This method returns the number of worker threads.
+   */
+  unsigned size() const;
+
+  // ----------
+  // processors
+  // ----------
+  /**
+   * @brief  This method returns the number of online processors.
+   */
+  static unsigned processors();
+
+
+protected:
+
+  // ---------------------------------------------------------------------------
+  // Internal methods                                           Internal methods
+  // ---------------------------------------------------------------------------
+
+  // ----
+  // work
+  // ----
+  /**
+   * @brief  This method is the main loop of each worker thread.
+   */
+  static void* work(void* pool);
+
+
+private:
+
+  // ---------------------------------------------------------------------------
+  // Attributes                                                       Attributes
+  // ---------------------------------------------------------------------------
+
+  /// the worker threads
+  std::vector<pthread_t> m_threads;
+
+  /// the tasks that haven't been started yet
+  std::deque<Task*> m_queue;
+
+  /// the number of tasks that are currently running
+  unsigned m_busy;
+
+  /// the number of threads that have been started
+  unsigned m_started;
+
+  /// stop all threads
+  bool m_stop;
+
+  /// protects all attributes above
+  pthread_mutex_t m_mutex;
+
+  /// signalizes new tasks
+  pthread_cond_t m_wake;
+
+  /// signalizes finished tasks
+  pthread_cond_t m_done;
+
+  // not copyable
+  WorkerPool(const WorkerPool&);
+  WorkerPool& operator=(const WorkerPool&);
+
+};
+
+#endif  /* #ifndef WORKERPOOL_H_INCLUDE_NO1 */
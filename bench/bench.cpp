@@ -0,0 +1,586 @@
+// -----------------------------------------------------------------------------
+// bench.cpp                                                           bench.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the benchmark harness run by 'make bench'.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ *
+ * Usage: parcolor-bench [JSON-FILE] [MIB-PER-CORPUS]
+ *
+ * Each generated corpus is passed through InputReader::readLine(),
+ * SpanLexer::lex(), SyntaxHighlighter::highlight() (C rules),
+ * LaTeXGenerator::parseLine(), LaTeXGenerator::translate() and the
+ * complete LaTeXGenerator::render().  The best of several runs is
+ * reported on stdout and written to the JSON file, along with the heap
+ * allocations per input byte of the last run (operator new is counted).
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>     /* clock_gettime() */
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>       /* bad_alloc */
+#include <sstream>
+#include <string>
+#include <vector>
+#include "InputReader.h"
+#include "LaTeXGenerator.h"
+#include "LineMemo.h"
+#include "MarkupChecker.h"
+#include "SpanLexer.h"
+#include "SyntaxHighlighter.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the number of runs of each stage (the fastest one counts)
+static const int RUNS = 5;
+
+/// characters that need escaping (the trigger excluded)
+static const char ESCAPED[] = "\\{}$&#^_%~\"<>-";
+
+/// the number of heap allocations so far (all stages run on one thread)
+static size_t s_allocations = 0;
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// ------
+// Corpus
+// ------
+/**
+ * @brief  The properties of a generated corpus.
+ */
+struct Corpus
+{
+  const char* name;       ///< the name used in the report
+  unsigned    lineLength; ///< the average number of characters per line
+  unsigned    markup;     ///< highlight sequences per 1000 words
+  unsigned    escapes;    ///< escaped characters per 1000 characters
+  unsigned    indent;     ///< the average indentation (in characters)
+  bool        tabs;       ///< indent with tabs instead of spaces
+  bool        crlf;       ///< terminate lines with CR LF
+};
+
+/// all generated corpora
+static const Corpus CORPORA[] =
+{
+  // name           length markup escapes indent  tabs   crlf
+  { "plain",            60,     0,      0,     0, false, false },
+  { "short-lines",      12,     0,     20,     2, false, false },
+  { "long-lines",      400,    20,     20,     4, false, false },
+  { "markup-dense",     60,   400,     20,     4, false, false },
+  { "escape-dense",     60,    20,    300,     4, false, false },
+  { "crlf",             60,    20,     20,     4, false, true  },
+  { "space-indent",     40,    20,     20,    16, false, false },
+  { "tab-indent",       40,    20,     20,     4, true,  false }
+};
+
+// --------------
+// BenchGenerator
+// --------------
+/**
+ * @brief  This class provides the internal stages of the generator.
+ */
+class BenchGenerator : public LaTeXGenerator
+{
+
+public:
+
+  using LaTeXGenerator::parseLine;
+  using LaTeXGenerator::translate;
+
+};
+
+
+// -----------------------------------------------------------------------------
+// Allocation counting                                       Allocation counting
+// -----------------------------------------------------------------------------
+
+// ------------
+// operator new
+// ------------
+/**
+ * @brief  This operator counts each allocation (new[] ends up here too).
+ */
+void* operator new(size_t size) throw(bad_alloc)
+{
+  s_allocations += 1;
+
+  void* p = malloc((size > 0) ? size : 1);
+
+  if (p == 0) throw bad_alloc();
+
+  return p;
+}
+
+// ---------------
+// operator delete
+// ---------------
+/**
+ * @brief  This operator releases memory allocated by operator new.
+ */
+void operator delete(void* p) throw()
+{
+  free(p);
+}
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ----
+// next
+// ----
+/**
+ * @brief  This function returns the next pseudo-random number.
+ *
+ * A private generator keeps the corpora identical on all platforms.
+ */
+static unsigned next(unsigned& state, unsigned range)
+{
+  state = state * 1103515245u + 12345u;
+
+  return ((state >> 16) & 0x7FFF) % range;
+}
+
+// --------
+// generate
+// --------
+/**
+ * @brief  This function creates a corpus of (at least) the given size.
+ */
+static void generate(const Corpus& corpus, size_t size, string& data)
+{
+  static const char COLORS[] = "RGBCMY";
+  static const char LETTERS[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+  unsigned state = 20191120;
+
+  data.clear();
+  data.reserve(size + 1024);
+
+  while (data.size() < size)
+  {
+    // indentation
+    unsigned indent = (corpus.indent > 0) ? next(state, 2 * corpus.indent + 1) : 0;
+
+    if (corpus.tabs)
+    {
+      data.append(indent / 4 + 1, '\t');
+    }
+
+    else
+    {
+      data.append(indent, ' ');
+    }
+
+    // words
+    size_t   start  = data.size();
+    unsigned length = next(state, 2 * corpus.lineLength + 1);
+
+    while (data.size() - start < length)
+    {
+      bool highlight = (next(state, 1000) < corpus.markup);
+
+      if (highlight)
+      {
+        data += "!!";
+        data += COLORS[next(state, sizeof(COLORS) - 1)];
+        data += '!';
+      }
+
+      unsigned word = 1 + next(state, 8);
+
+      for(unsigned i = 0; i < word; i++)
+      {
+        if (next(state, 1000) < corpus.escapes)
+        {
+          data += ESCAPED[next(state, sizeof(ESCAPED) - 1)];
+        }
+
+        else
+        {
+          data += LETTERS[next(state, sizeof(LETTERS) - 1)];
+        }
+      }
+
+      if (highlight) data += "!!";
+
+      data += ' ';
+    }
+
+    // terminator
+    if (corpus.crlf) data += '\r';
+
+    data += '\n';
+  }
+}
+
+// -------
+// seconds
+// -------
+/**
+ * @brief  This function returns the seconds elapsed since start.
+ */
+static double seconds(const timespec& start)
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+// ---------
+// benchRead
+// ---------
+/**
+ * @brief  This function splits the corpus into lines.
+ */
+static size_t benchRead(const string& data)
+{
+  InputReader reader;
+  reader.open(data.data(), data.size());
+
+  const char* line;
+  size_t      size;
+  size_t      lines = 0;
+
+  while ( reader.readLine(line, size) )
+  {
+    lines += 1;
+  }
+
+  return lines;
+}
+
+// ---------
+// benchSkip
+// ---------
+/**
+ * @brief  This function skips all lines of the corpus (see --lines).
+ */
+static size_t benchSkip(const string& data)
+{
+  InputReader reader;
+  reader.open(data.data(), data.size());
+
+  return reader.skipLines(static_cast<size_t>(-1));
+}
+
+// --------
+// benchLex
+// --------
+/**
+ * @brief  This function splits each line of the corpus into spans.
+ */
+static size_t benchLex(const SpanLexer& lexer, const vector<const char*>& begin, const vector<size_t>& size)
+{
+  vector<SpanLexer::Span> spans;
+
+  for(size_t i = 0; i < begin.size(); i++)
+  {
+    if ( !lexer.lex(begin[i], size[i], spans) )
+    {
+      cerr << "invalid markup in line " << (i + 1) << endl;
+
+      exit(1);
+    }
+  }
+
+  return begin.size();
+}
+
+// --------------
+// benchHighlight
+// --------------
+/**
+ * @brief  This function splits each line into spans and colors them.
+ */
+static size_t benchHighlight(const SpanLexer& lexer, SyntaxHighlighter& highlighter, const vector<const char*>& begin, const vector<size_t>& size)
+{
+  vector<SpanLexer::Span> spans;
+
+  highlighter.reset();
+
+  for(size_t i = 0; i < begin.size(); i++)
+  {
+    if ( !lexer.lex(begin[i], size[i], spans) )
+    {
+      cerr << "invalid markup in line " << (i + 1) << endl;
+
+      exit(1);
+    }
+
+    highlighter.highlight(begin[i], spans);
+  }
+
+  return begin.size();
+}
+
+// ----------
+// benchParse
+// ----------
+/**
+ * @brief  This function parses each line of the corpus (lexer and emitter).
+ */
+static size_t benchParse(BenchGenerator& generator, const vector<const char*>& begin, const vector<size_t>& size)
+{
+  for(size_t i = 0; i < begin.size(); i++)
+  {
+    if ( !generator.parseLine(begin[i], size[i]) )
+    {
+      cerr << "invalid markup in line " << (i + 1) << endl;
+
+      exit(1);
+    }
+  }
+
+  return begin.size();
+}
+
+// --------------
+// benchTranslate
+// --------------
+/**
+ * @brief  This function translates each character of the corpus.
+ */
+static size_t benchTranslate(const BenchGenerator& generator, const string& data, string& out, size_t lines)
+{
+  out.clear();
+
+  for(size_t i = 0; i < data.size(); i++)
+  {
+    generator.translate(data[i], out);
+
+    // keep the target small
+    if (data[i] == '\n')
+    {
+      out.clear();
+    }
+  }
+
+  return lines;
+}
+
+// ---------
+// benchFull
+// ---------
+/**
+ * @brief  This function renders the complete corpus.
+ */
+static size_t benchFull(LaTeXGenerator& generator, const string& data, string& out, size_t lines)
+{
+  if ( !generator.render(data.data(), data.size(), out) )
+  {
+    cerr << "invalid markup" << endl;
+
+    exit(1);
+  }
+
+  return lines;
+}
+
+// ---------
+// benchMemo
+// ---------
+/**
+ * @brief  This function renders the complete corpus with a fresh memo
+ *         (the corpora hardly repeat lines, so this shows what a miss costs).
+ */
+static size_t benchMemo(LaTeXGenerator& generator, const string& data, string& out, size_t lines)
+{
+  LineMemo memo(8 * 1024 * 1024);
+
+  generator.setMemo(&memo);
+
+  benchFull(generator, data, out, lines);
+
+  generator.setMemo(0);
+
+  return lines;
+}
+
+// ----------
+// benchCheck
+// ----------
+/**
+ * @brief  This function checks the markup of the complete corpus.
+ */
+static size_t benchCheck(const MarkupChecker& checker, const string& data, size_t lines)
+{
+  InputReader reader;
+  reader.open(data.data(), data.size());
+
+  vector<MarkupChecker::Problem> problems;
+
+  if ( !checker.check(reader, problems) )
+  {
+    cerr << "invalid markup in line " << problems[0].line << endl;
+
+    exit(1);
+  }
+
+  return lines;
+}
+
+// ------
+// record
+// ------
+/**
+ * @brief  This function reports a single result.
+ */
+static void record(ostringstream& json, const char* corpus, const char* stage, size_t bytes, size_t lines, double best, size_t allocations)
+{
+  double mbps = bytes / best / 1e6;
+  double lps  = lines / best;
+  double nspb = best * 1e9 / bytes;
+  double apb  = static_cast<double>(allocations) / bytes;
+
+  cout << left  << setw(14) << corpus
+       << left  << setw(11) << stage
+       << right << fixed << setprecision(1)
+       << setw(10) << mbps << " MB/s"
+       << setw(14) << setprecision(0) << lps << " lines/s"
+       << setw(10) << setprecision(3) << nspb << " ns/byte"
+       << setw(10) << setprecision(5) << apb << " allocs/byte"
+       << endl;
+
+  if (json.tellp() > 0) json << ",\n";
+
+  json << "    { \"corpus\": \"" << corpus << "\", \"stage\": \"" << stage << "\""
+       << ", \"bytes\": " << bytes
+       << ", \"lines\": " << lines
+       << fixed << setprecision(9)
+       << ", \"seconds\": " << best
+       << setprecision(3)
+       << ", \"mb_per_s\": " << mbps
+       << ", \"lines_per_s\": " << lps
+       << ", \"ns_per_byte\": " << nspb
+       << setprecision(6)
+       << ", \"allocations\": " << allocations
+       << ", \"allocs_per_byte\": " << apb
+       << " }";
+}
+
+// ----
+// main
+// ----
+/**
+ * @brief  The benchmark starts in this function.
+ */
+int main(int argc, char** argv)
+{
+  const char* path = (argc > 1) ? argv[1] : "bench.json";
+  size_t      mib  = (argc > 2) ? strtoul(argv[2], 0, 10) : 8;
+
+  if (mib == 0) mib = 8;
+
+  BenchGenerator    generator;
+  SpanLexer         lexer;
+  SyntaxHighlighter highlighter;
+  MarkupChecker     checker;
+  ostringstream     json;
+  string            data;
+  string            out;
+
+  highlighter.setLanguage(SyntaxHighlighter::C);
+
+  for(size_t c = 0; c < sizeof(CORPORA) / sizeof(CORPORA[0]); c++)
+  {
+    const Corpus& corpus = CORPORA[c];
+
+    generate(corpus, mib * 1024 * 1024, data);
+
+    // split lines once for parseLine()
+    vector<const char*> begin;
+    vector<size_t>      size;
+
+    InputReader reader;
+    reader.open(data.data(), data.size());
+
+    const char* line;
+    size_t      length;
+
+    while ( reader.readLine(line, length) )
+    {
+      begin.push_back(line);
+      size.push_back(length);
+    }
+
+    const char* stages[] = { "readLine", "skipLines", "lex", "highlight", "parseLine", "translate", "render", "renderMemo", "check" };
+
+    for(int s = 0; s < 9; s++)
+    {
+      double best  = 0;
+      size_t lines = 0;
+      size_t count = 0;
+
+      for(int run = 0; run < RUNS; run++)
+      {
+        size_t allocations = s_allocations;
+
+        timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        switch (s)
+        {
+          case 0: lines = benchRead(data);                                    break;
+          case 1: lines = benchSkip(data);                                    break;
+          case 2: lines = benchLex(lexer, begin, size);                       break;
+          case 3: lines = benchHighlight(lexer, highlighter, begin, size);    break;
+          case 4: lines = benchParse(generator, begin, size);                 break;
+          case 5: lines = benchTranslate(generator, data, out, begin.size()); break;
+          case 6: lines = benchFull(generator, data, out, begin.size());      break;
+          case 7: lines = benchMemo(generator, data, out, begin.size());      break;
+          case 8: lines = benchCheck(checker, data, begin.size());            break;
+        }
+
+        double elapsed = seconds(start);
+
+        if ((run == 0) || (elapsed < best)) best = elapsed;
+
+        // buffers have grown by the last run
+        count = s_allocations - allocations;
+      }
+
+      record(json, corpus.name, stages[s], data.size(), lines, best, count);
+    }
+  }
+
+  // write results
+  ofstream file(path);
+
+  file << "{\n  \"mib_per_corpus\": " << mib << ",\n  \"runs\": " << RUNS
+       << ",\n  \"results\": [\n" << json.str() << "\n  ]\n}\n";
+
+  if ( !file )
+  {
+    cerr << "cannot write " << path << endl;
+
+    return 1;
+  }
+
+  cout << "results written to " << path << endl;
+
+  return 0;
+}
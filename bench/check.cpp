@@ -0,0 +1,734 @@
+// -----------------------------------------------------------------------------
+// check.cpp                                                           check.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the differential check run by 'make check'.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ *
+ * Usage: parcolor-check [CASES]
+ *
+ * Random inputs are passed through ByteScanner::find() and skip() with
+ * each implementation the processor supports (scalar, SSE2 and AVX2) and
+ * the results are compared with a plain loop.  Random lines are parsed by
+ * LaTeXGenerator::parseLine() on each implementation and compared with the
+ * original scalar parser (the five-state machine, one byte at a time).
+ * Random code is highlighted in each language on each implementation and
+ * compared with the scalar result.  The first difference is reported and
+ * the check fails.  Finally, a
+ * server with a single worker must still answer a client while another
+ * client never reads its reply.
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>    /* fork(), alarm(), usleep(), _exit() */
+#include <sys/socket.h>
+#include <sys/un.h>    /* sockaddr_un */
+#include <sys/wait.h>  /* waitpid() */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ByteScanner.h"
+#include "LaTeXGenerator.h"
+#include "RenderClient.h"
+#include "RenderServer.h"
+#include "SpanLexer.h"
+#include "SyntaxHighlighter.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the implementations and their names
+static const ByteScanner::Level LEVELS[] = { ByteScanner::SCALAR, ByteScanner::SSE2, ByteScanner::AVX2 };
+static const char*              NAMES[]  = { "scalar", "sse2", "avx2" };
+
+/// the syntactic characters used by the parser check
+static const char TRIGGERS[] = "!@|#-\\a";
+
+/// the characters of code used by the highlighter check
+static const char CODE[] = "__09.\"'/*#$\\%{}  \t\033[;m";
+
+/// characters that need escaping (besides control characters)
+static const char ESCAPED[] = "\\{}$&#^_%~\"<>- ";
+
+/// the number of seconds the server waits for a client
+static const unsigned TIMEOUT = 1;
+
+/// the number of seconds the server check may take
+static const unsigned DEADLINE = 20;
+
+
+// -----------------------------------------------------------------------------
+// Signals                                                               Signals
+// -----------------------------------------------------------------------------
+
+/// the process running the server of the server check
+static pid_t s_server = 0;
+
+/// the socket of that server
+static sockaddr_un s_address;
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// --------------
+// CheckGenerator
+// --------------
+/**
+ * @brief  This class provides the internal stages of the generator.
+ */
+class CheckGenerator : public LaTeXGenerator
+{
+
+public:
+
+  using LaTeXGenerator::parseLine;
+  using LaTeXGenerator::parsed;
+
+};
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// ----
+// next
+// ----
+/**
+ * @brief  This function returns the next pseudo-random number.
+ *
+ * A private generator makes each run check the same inputs.
+ */
+static unsigned next(unsigned& state, unsigned range)
+{
+  state = state * 1103515245u + 12345u;
+
+  return ((state >> 16) & 0x7FFF) % range;
+}
+
+// ----
+// dump
+// ----
+/**
+ * @brief  This function prints the given bytes (non-printable ones in hex).
+ */
+static void dump(const char* label, const char* data, size_t size)
+{
+  cerr << label << " (" << size << " bytes): ";
+
+  for(size_t i = 0; i < size; i++)
+  {
+    unsigned char c = static_cast<unsigned char>(data[i]);
+
+    if ((c >= 32) && (c < 127))
+    {
+      cerr << data[i];
+    }
+
+    else
+    {
+      char hex[8];
+      sprintf(hex, "\\x%02X", c);
+
+      cerr << hex;
+    }
+  }
+
+  cerr << endl;
+}
+
+// ------------
+// oldTranslate
+// ------------
+/**
+ * @brief  This function returns the LaTeX code of a character just like
+ *         the original generator did.
+ */
+static string oldTranslate(char c)
+{
+  // control characters (apart from TAB)
+  if ((static_cast<unsigned char>(c) < 32) && (c != '\t')) return "[CTRL]";
+
+  // translate these characters
+  switch(c)
+  {
+    case '\t': return "\\ \\ ";
+    case '\\': return "\\textbackslash{}";
+    case  '~': return "\\textasciitilde{}";
+    case  '"': return "\\grqq{}";
+    case  '^': return "\\^{}";
+    case  '{': return "\\{";
+    case  '}': return "\\}";
+    case  '&': return "\\&";
+    case  '$': return "\\$";
+    case  '%': return "\\%";
+    case  '#': return "\\#";
+    case  '_': return "\\_";
+    case  '-': return "-{}";
+    case  '<': return "<{}";
+    case  '>': return ">{}";
+    case  ' ': return "\\ ";
+  }
+
+  // identity map
+  return string(1, c);
+}
+
+// ------------
+// oldParseLine
+// ------------
+/**
+ * @brief  This function parses a line just like the original generator did.
+ *
+ * @return  false if the markup is incomplete
+ */
+static bool oldParseLine(const string& line, char trigger, string& parsed)
+{
+  parsed = "";
+
+  // empty line extracted
+  if ( line.empty() )
+  {
+    parsed = "\\rule{0pt}{\\dimen100}";
+
+    return true;
+  }
+
+  // the parser's states
+  enum
+  {
+    PLAINCODE,
+    ENTERMARKUP,
+    COLORNAME,
+    COLORCODE,
+    LEAVEMARKUP
+  }
+  context(PLAINCODE);
+
+  for(string::size_type i = 0; i < line.size(); i++)
+  {
+    const char& c = line[i];
+
+    // PLAINCODE
+    if (context == PLAINCODE)
+    {
+      if (c == trigger) context = ENTERMARKUP;
+      else              parsed += oldTranslate(c);
+    }
+
+    // ENTERMARKUP
+    else if (context == ENTERMARKUP)
+    {
+      if (c == trigger)
+      {
+        parsed += "\\textcolor{";
+
+        context = COLORNAME;
+      }
+
+      else
+      {
+        parsed += oldTranslate(trigger);
+        parsed += oldTranslate(c);
+
+        context = PLAINCODE;
+      }
+    }
+
+    // COLORNAME
+    else if (context == COLORNAME)
+    {
+      if (c == trigger)
+      {
+        parsed += "}{\\textbf{";
+
+        context = COLORCODE;
+      }
+
+      else
+      {
+        parsed += c;
+      }
+    }
+
+    // COLORCODE
+    else if (context == COLORCODE)
+    {
+      if (c == trigger) context = LEAVEMARKUP;
+      else              parsed += oldTranslate(c);
+    }
+
+    // LEAVEMARKUP
+    else if (context == LEAVEMARKUP)
+    {
+      if (c == trigger)
+      {
+        parsed += "}}";
+
+        context = PLAINCODE;
+      }
+
+      else
+      {
+        parsed += oldTranslate(trigger);
+        parsed += oldTranslate(c);
+
+        context = COLORCODE;
+      }
+    }
+  }
+
+  return (context == PLAINCODE);
+}
+
+// -------
+// onAlarm
+// -------
+/**
+ * @brief  This function fails the check if the server doesn't answer.
+ */
+static void onAlarm(int)
+{
+  static const char REASON[] = "server: a client that doesn't read its reply stalls the server\n";
+
+  if (s_server > 0)
+  {
+    kill(s_server, SIGKILL);
+
+    unlink(s_address.sun_path);
+  }
+
+  // async-signal-safe output only
+  ssize_t written = write(2, REASON, sizeof(REASON) - 1);
+
+  _exit((written < 0) ? 2 : 1);
+}
+
+// ----------
+// randomByte
+// ----------
+/**
+ * @brief  This function returns a random byte, mostly one of the given
+ *         interesting ones.
+ */
+static char randomByte(unsigned& state, const string& interesting)
+{
+  unsigned r = next(state, 100);
+
+  // any byte
+  if (r < 10) return static_cast<char>(next(state, 256));
+
+  // letters
+  if ((r < 55) || interesting.empty()) return static_cast<char>('a' + next(state, 26));
+
+  return interesting[ next(state, interesting.size()) ];
+}
+
+// ------------
+// checkScanner
+// ------------
+/**
+ * @brief  This function compares find() and skip() with a plain loop.
+ *
+ * The inputs start at all offsets of a buffer, so unaligned loads and
+ * the tails behind the last whole block are covered.
+ *
+ * @return  false if an implementation differs
+ */
+static bool checkScanner(unsigned cases)
+{
+  unsigned state = 20191120;
+
+  for(unsigned n = 0; n < cases; n++)
+  {
+    // random set
+    ByteScanner scanner;
+    string      members;
+
+    unsigned count = next(state, ByteScanner::MAXBYTES + 1);
+    unsigned below = (next(state, 2) == 0) ? 0 : next(state, 129);
+
+    for(unsigned i = 0; i < count; i++)
+    {
+      char c = static_cast<char>(next(state, 256));
+
+      scanner.add(c);
+
+      members += c;
+    }
+
+    scanner.addBelow(static_cast<unsigned char>(below));
+
+    for(unsigned i = 0; i < below; i++) members += static_cast<char>(i);
+
+    // random input with some members (and sometimes none at all)
+    unsigned offset = next(state, 32);
+    unsigned size   = next(state, (next(state, 4) == 0) ? 1024 : 96);
+    bool     sparse = (next(state, 4) == 0);
+
+    string buffer(offset, 'x');
+
+    for(unsigned i = 0; i < size; i++)
+    {
+      char c = randomByte(state, sparse ? "" : members);
+
+      buffer += (sparse && (next(state, 200) > 0) && scanner.contains(c)) ? 'x' : c;
+    }
+
+    const char* begin = buffer.data() + offset;
+    const char* end   = buffer.data() + buffer.size();
+
+    // expected results
+    const char* found = begin;
+
+    while ((found != end) && !scanner.contains(*found)) ++found;
+
+    size_t      passes = next(state, 12);
+    size_t      left   = passes;
+    const char* passed = begin;
+
+    while ((passed != end) && (left > 0))
+    {
+      if ( scanner.contains(*passed++) ) left -= 1;
+    }
+
+    for(unsigned l = 0; l < sizeof(LEVELS) / sizeof(LEVELS[0]); l++)
+    {
+      ByteScanner::setLevel(LEVELS[l]);
+
+      if (ByteScanner::getLevel() != LEVELS[l]) continue;
+
+      size_t remaining = passes;
+
+      const char* f = scanner.find(begin, end);
+      const char* s = scanner.skip(begin, end, remaining);
+
+      if ((f != found) || (s != passed) || (remaining != left))
+      {
+        cerr << "scanner: " << NAMES[l] << " differs in case " << n
+             << ": find " << (f - begin) << " instead of " << (found - begin)
+             << ", skip(" << passes << ") " << (s - begin) << "/" << remaining
+             << " instead of " << (passed - begin) << "/" << left << endl;
+
+        dump("set", members.data(), members.size());
+        dump("input", begin, end - begin);
+
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// ----------
+// checkParse
+// ----------
+/**
+ * @brief  This function compares parseLine() with the original parser.
+ *
+ * @return  false if the parsers differ
+ */
+static bool checkParse(unsigned cases)
+{
+  unsigned state = 11202019;
+
+  for(unsigned n = 0; n < cases; n++)
+  {
+    char trigger = TRIGGERS[ next(state, sizeof(TRIGGERS) - 1) ];
+
+    CheckGenerator generator;
+    generator.setSyntaxCharacter(trigger);
+
+    // random line with lots of triggers
+    string interesting = ESCAPED + string(4, trigger) + "\t\x01\x7F\xC3\xA4";
+    string line;
+
+    unsigned size = next(state, (next(state, 4) == 0) ? 400 : 40);
+
+    for(unsigned i = 0; i < size; i++)
+    {
+      char c = randomByte(state, interesting);
+
+      // the parser gets lines without terminator
+      if ((c == '\n') || (c == '\r')) c = ' ';
+
+      line += c;
+    }
+
+    string expected;
+    bool   valid = oldParseLine(line, trigger, expected);
+
+    for(unsigned l = 0; l < sizeof(LEVELS) / sizeof(LEVELS[0]); l++)
+    {
+      ByteScanner::setLevel(LEVELS[l]);
+
+      if (ByteScanner::getLevel() != LEVELS[l]) continue;
+
+      bool success = generator.parseLine(line.data(), line.size());
+
+      if ((success != valid) || (success && (generator.parsed() != expected)))
+      {
+        cerr << "parser: " << NAMES[l] << " differs in case " << n
+             << " (trigger '" << trigger << "', "
+             << (success ? "accepted" : "rejected") << " instead of "
+             << (valid ? "accepted" : "rejected") << ")" << endl;
+
+        dump("line", line.data(), line.size());
+        dump("expected", expected.data(), expected.size());
+
+        if (success) dump("parsed", generator.parsed().data(), generator.parsed().size());
+
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// --------------
+// checkHighlight
+// --------------
+/**
+ * @brief  This function compares the spans of highlight() on each
+ *         implementation with the scalar ones.
+ *
+ * A few lines are highlighted in a row, so strings and comments are
+ * continued.  Long words cross the chunks of scanWords().
+ *
+ * @return  false if an implementation differs
+ */
+static bool checkHighlight(unsigned cases)
+{
+  unsigned state = 20112019;
+
+  SpanLexer lexer('!');
+
+  for(unsigned n = 0; n < cases; n++)
+  {
+    SyntaxHighlighter::Language language = static_cast<SyntaxHighlighter::Language>(next(state, SyntaxHighlighter::ANSI + 1));
+
+    // random lines (without triggers)
+    vector<string> lines(1 + next(state, 4));
+
+    for(size_t k = 0; k < lines.size(); k++)
+    {
+      unsigned size = next(state, (next(state, 4) == 0) ? 200 : 24);
+
+      for(unsigned i = 0; i < size; i++)
+      {
+        char c = randomByte(state, CODE);
+
+        if ((c == '!') || (c == '\n') || (c == '\r')) c = ' ';
+
+        lines[k] += c;
+      }
+    }
+
+    vector< vector<SpanLexer::Span> > expected;
+
+    for(unsigned l = 0; l < sizeof(LEVELS) / sizeof(LEVELS[0]); l++)
+    {
+      ByteScanner::setLevel(LEVELS[l]);
+
+      if (ByteScanner::getLevel() != LEVELS[l]) continue;
+
+      SyntaxHighlighter highlighter;
+      highlighter.setLanguage(language);
+
+      for(size_t k = 0; k < lines.size(); k++)
+      {
+        vector<SpanLexer::Span> spans;
+
+        lexer.lex(lines[k].data(), lines[k].size(), spans);
+
+        highlighter.highlight(lines[k].data(), spans);
+
+        // the scalar result
+        if (l == 0)
+        {
+          expected.push_back(spans);
+
+          continue;
+        }
+
+        bool same = (spans.size() == expected[k].size());
+
+        for(size_t i = 0; same && (i < spans.size()); i++)
+        {
+          same = (spans[i].offset == expected[k][i].offset) && (spans[i].length == expected[k][i].length) &&
+                 (spans[i].kind   == expected[k][i].kind)   && (spans[i].color  == expected[k][i].color);
+        }
+
+        if ( !same )
+        {
+          cerr << "highlighter: " << NAMES[l] << " differs in case " << n
+               << " (" << highlighter.name() << ", line " << (k + 1) << ")" << endl;
+
+          dump("line", lines[k].data(), lines[k].size());
+
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+// -----------
+// checkServer
+// -----------
+/**
+ * @brief  This function sends a large request to a server with a single
+ *         worker and never reads the reply.  The worker must give up on
+ *         that client, so the request of a second client is answered.
+ *
+ * @return  false if the second client isn't answered
+ */
+static bool checkServer()
+{
+  ostringstream name;
+  name << "/tmp/parcolor-check-" << getpid() << ".sock";
+
+  string path = name.str();
+
+  memset(&s_address, 0, sizeof(s_address));
+
+  s_address.sun_family = AF_UNIX;
+  strcpy(s_address.sun_path, path.c_str());
+
+  s_server = fork();
+
+  if (s_server < 0)
+  {
+    cerr << "server: cannot start the server" << endl;
+
+    return false;
+  }
+
+  // the server (its messages would clutter the check)
+  if (s_server == 0)
+  {
+    if (freopen("/dev/null", "w", stderr) == 0) _exit(1);
+
+    RenderServer server(1, TIMEOUT);
+
+    _exit(server.serve(path) ? 0 : 1);
+  }
+
+  // fail instead of waiting forever
+  signal(SIGALRM, onAlarm);
+  alarm(DEADLINE);
+
+  // wait for the socket
+  RenderClient client;
+
+  for(int i = 0; (i < 500) && !client.connect(path); i++) usleep(10000);
+
+  RenderServer::Request request = { false, false, false, false, '!', 0, 0 };
+
+  // a reply much larger than the socket buffers
+  string code;
+
+  for(int i = 0; i < 100000; i++) code += "!!R!never!! read\n";
+
+  string frame;
+  RenderServer::encode(request, code.data(), code.size(), frame);
+
+  int stalled = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  bool sent = (stalled >= 0)
+           && (connect(stalled, reinterpret_cast<sockaddr*>(&s_address), sizeof(s_address)) == 0)
+           && RenderServer::writeFully(stalled, frame.data(), frame.size());
+
+  // the only worker is busy with the stalled client until the timeout
+  RenderServer::Status status = RenderServer::BAD_REQUEST;
+  string               reply;
+
+  bool answered = sent && client.request(request, "!!R!x!!", 7, status, reply);
+
+  alarm(0);
+
+  if (stalled >= 0) close(stalled);
+
+  kill(s_server, SIGTERM);
+  waitpid(s_server, 0, 0);
+
+  s_server = 0;
+
+  if (!answered || (status != RenderServer::OK) || reply.empty())
+  {
+    cerr << "server: " << (sent ? "the second client wasn't answered" : "cannot send the large request") << endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+// ----
+// main
+// ----
+/**
+ * @brief  The check starts in this function.
+ */
+int main(int argc, char** argv)
+{
+  unsigned cases = (argc > 1) ? strtoul(argv[1], 0, 10) : 100000;
+
+  if (cases == 0) cases = 100000;
+
+  // the implementations available on this processor
+  ByteScanner::Level best = ByteScanner::getLevel();
+
+  cout << "implementations:";
+
+  for(unsigned l = 0; l < sizeof(LEVELS) / sizeof(LEVELS[0]); l++)
+  {
+    if (LEVELS[l] <= best) cout << " " << NAMES[l];
+  }
+
+  cout << endl;
+
+  bool success = checkScanner(cases);
+
+  if (success) cout << "scanner: " << cases << " random inputs ok" << endl;
+
+  success = success && checkParse(cases);
+
+  if (success) cout << "parser:  " << cases << " random lines ok" << endl;
+
+  success = success && checkHighlight(cases);
+
+  if (success) cout << "highlighter: " << cases << " random runs of code ok" << endl;
+
+  success = success && checkServer();
+
+  if (success) cout << "server:  stalled client dropped" << endl;
+
+  ByteScanner::setLevel(best);
+
+  return success ? 0 : 1;
+}
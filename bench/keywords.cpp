@@ -0,0 +1,400 @@
+// -----------------------------------------------------------------------------
+// keywords.cpp                                                     keywords.cpp
+// -----------------------------------------------------------------------------
+/**
+ * @file
+ * @brief      This file holds the generator of the keyword tables run by 'make keywords'.
+ * @author     Col. Walter E. Kurtz
+ * @version    2019-11-20
+ * @copyright  GNU General Public License - Version 3.0
+ *
+ * Usage: parcolor-keywords > SyntaxKeywords.h
+ *
+ * The keywords of each language are placed into a table indexed by
+ * SyntaxHighlighter::keywordSlot().  The factors of the hash function
+ * are searched until no two keywords share a slot, starting with the
+ * smallest table that holds all keywords.  The tables are written as
+ * static data, so the highlighter doesn't build anything at run time.
+ * If no factors are found, nothing is written and the generator fails.
+ */
+
+// -----------------------------------------------------------------------------
+// Includes                                                             Includes
+// -----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "SyntaxHighlighter.h"
+
+
+// -----------------------------------------------------------------------------
+// Used namespaces                                               Used namespaces
+// -----------------------------------------------------------------------------
+using namespace std;
+
+
+// -----------------------------------------------------------------------------
+// Constants                                                           Constants
+// -----------------------------------------------------------------------------
+
+/// the keywords of C and C++
+static const char* const C_KEYWORDS[] =
+{
+  "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char",
+  "char16_t", "char32_t", "class", "const", "const_cast", "constexpr",
+  "continue", "decltype", "default", "delete", "do", "double",
+  "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+  "final", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+  "mutable", "namespace", "new", "noexcept", "nullptr", "operator",
+  "override", "private", "protected", "public", "register",
+  "reinterpret_cast", "restrict", "return", "short", "signed", "sizeof",
+  "static", "static_assert", "static_cast", "struct", "switch", "template",
+  "this", "thread_local", "throw", "true", "try", "typedef", "typename",
+  "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t",
+  "while", 0
+};
+
+/// the keywords and builtins of the shell
+static const char* const SHELL_KEYWORDS[] =
+{
+  "break", "case", "continue", "declare", "do", "done", "echo", "elif",
+  "else", "esac", "eval", "exec", "exit", "export", "fi", "for", "function",
+  "if", "in", "local", "readonly", "return", "select", "set", "shift",
+  "source", "then", "time", "trap", "unset", "until", "while", 0
+};
+
+/// the keywords of Python
+static const char* const PYTHON_KEYWORDS[] =
+{
+  "False", "None", "True", "and", "as", "assert", "async", "await", "break",
+  "class", "continue", "def", "del", "elif", "else", "except", "finally",
+  "for", "from", "global", "if", "import", "in", "is", "lambda", "nonlocal",
+  "not", "or", "pass", "raise", "return", "try", "while", "with", "yield", 0
+};
+
+/// the number of slots of a keyword table is never doubled beyond
+static const unsigned MAXSLOTS = 4096;
+
+/// the factors of the hash function are searched up to
+static const unsigned MAXFACTOR = 31;
+
+// --------
+// Language
+// --------
+/**
+ * @brief  The keywords of a language.
+ */
+struct Language
+{
+  const char*        table;  ///< the name of the table
+  const char* const* words;  ///< the keywords (terminated by 0, 0 if there are none)
+  const char*        name;   ///< the name of the language
+};
+
+/// the languages (in the order of SyntaxHighlighter::Language)
+static const Language LANGUAGES[] =
+{
+  { "NONE_SLOTS",   0,               "none"   },
+  { "C_SLOTS",      C_KEYWORDS,      "c"      },
+  { "SHELL_SLOTS",  SHELL_KEYWORDS,  "sh"     },
+  { "LATEX_SLOTS",  0,               "latex"  },
+  { "PYTHON_SLOTS", PYTHON_KEYWORDS, "python" },
+  { "ANSI_SLOTS",   0,               "ansi"   }
+};
+
+/// the number of languages
+static const unsigned LANGUAGE_COUNT = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+
+
+// -----------------------------------------------------------------------------
+// Types                                                                   Types
+// -----------------------------------------------------------------------------
+
+// -----
+// Table
+// -----
+/**
+ * @brief  A keyword table found by the search.
+ */
+struct Table
+{
+  vector<const char*> slots;      ///< the keyword of each slot (0 if the slot is empty)
+  unsigned            factor[4];  ///< the factors of the hash function
+  size_t              longest;    ///< the number of characters of the longest keyword
+};
+
+
+// -----------------------------------------------------------------------------
+// Functions                                                           Functions
+// -----------------------------------------------------------------------------
+
+// -----
+// place
+// -----
+/**
+ * @brief  This function fills the table with the given hash function.
+ *
+ * @return  false if two keywords share a slot
+ */
+static bool place(const char* const* words, unsigned slots, const unsigned* factor, Table& table)
+{
+  table.slots.assign(slots, static_cast<const char*>(0));
+
+  for(const char* const* word = words; *word != 0; word++)
+  {
+    const char*& slot = table.slots[ SyntaxHighlighter::keywordSlot(*word, strlen(*word), factor, slots - 1) ];
+
+    // collision
+    if (slot != 0) return false;
+
+    slot = *word;
+  }
+
+  for(unsigned i = 0; i < 4; i++) table.factor[i] = factor[i];
+
+  // signalize success
+  return true;
+}
+
+// ------
+// search
+// ------
+/**
+ * @brief  This function searches the smallest table without collisions.
+ *
+ * Two keywords that only differ in characters the hash ignores share a
+ * slot whatever the factors are, so they aren't searched at all.
+ */
+static bool search(const char* const* words, Table& table)
+{
+  unsigned count = 0;
+
+  table.longest = 0;
+
+  for(const char* const* a = words; *a != 0; a++)
+  {
+    size_t size = strlen(*a);
+
+    for(const char* const* b = a + 1; *b != 0; b++)
+    {
+      if ((size == strlen(*b)) && ((*a)[0] == (*b)[0]) && ((*a)[size - 1] == (*b)[size - 1]) && ((*a)[size / 2] == (*b)[size / 2])) return false;
+    }
+
+    if (size > table.longest) table.longest = size;
+
+    count += 1;
+  }
+
+  unsigned slots = 1;
+
+  while (slots < count) slots *= 2;
+
+  for(; slots <= MAXSLOTS; slots *= 2)
+  {
+    unsigned f[4];
+
+    for(f[0] = 1; f[0] <= MAXFACTOR; f[0]++)
+    for(f[1] = 1; f[1] <= MAXFACTOR; f[1]++)
+    for(f[2] = 1; f[2] <= MAXFACTOR; f[2]++)
+    for(f[3] = 1; f[3] <= MAXFACTOR; f[3]++)
+    {
+      if ( place(words, slots, f, table) ) return true;
+    }
+  }
+
+  return false;
+}
+
+// -----------
+// writeHeader
+// -----------
+/**
+ * @brief  This function writes the file header and the types.
+ */
+static void writeHeader(ostream& out)
+{
+  out << "// -----------------------------------------------------------------------------\n"
+         "// SyntaxKeywords.h                                             SyntaxKeywords.h\n"
+         "// -----------------------------------------------------------------------------\n"
+         "/**\n"
+         " * @file\n"
+         " * @brief      This file holds the keyword tables of the @ref SyntaxHighlighter class.\n"
+         " * @author     Col. Walter E. Kurtz\n"
+         " * @version    2019-11-20\n"
+         " * @copyright  GNU General Public License - Version 3.0\n"
+         " *\n"
+         " * This file is generated by bench/keywords.cpp ('make keywords'), so the\n"
+         " * keywords are changed there.  Each keyword lies in the slot given by\n"
+         " * SyntaxHighlighter::keywordSlot(), and no two keywords share a slot.\n"
+         " * It is included by SyntaxHighlighter.cpp only.\n"
+         " */\n"
+         "\n"
+         "// -----------------------------------------------------------------------------\n"
+         "// One-Definition-Rule                                       One-Definition-Rule\n"
+         "// -----------------------------------------------------------------------------\n"
+         "#ifndef SYNTAXKEYWORDS_H_INCLUDE_NO1\n"
+         "#define SYNTAXKEYWORDS_H_INCLUDE_NO1\n"
+         "\n"
+         "\n"
+         "// -----------------------------------------------------------------------------\n"
+         "// Includes                                                             Includes\n"
+         "// -----------------------------------------------------------------------------\n"
+         "#include <cstddef>\n"
+         "\n"
+         "\n"
+         "// -----------------------------------------------------------------------------\n"
+         "// Types                                                                   Types\n"
+         "// -----------------------------------------------------------------------------\n"
+         "\n"
+         "// -----------\n"
+         "// KeywordSlot\n"
+         "// -----------\n"
+         "/**\n"
+         " * @brief  A slot of a keyword table.\n"
+         " */\n"
+         "struct KeywordSlot\n"
+         "{\n"
+         "  const char* word;  ///< the keyword (0 if the slot is empty)\n"
+         "  std::size_t size;  ///< the number of characters (0 if the slot is empty)\n"
+         "};\n"
+         "\n"
+         "// ------------\n"
+         "// KeywordTable\n"
+         "// ------------\n"
+         "/**\n"
+         " * @brief  The keyword table of a language.\n"
+         " */\n"
+         "struct KeywordTable\n"
+         "{\n"
+         "  const KeywordSlot* slots;      ///< the slots (0 if the language has no keywords)\n"
+         "  unsigned           mask;       ///< the number of slots minus one\n"
+         "  unsigned           factor[4];  ///< the factors of the hash function\n"
+         "  std::size_t        longest;    ///< the number of characters of the longest keyword\n"
+         "};\n"
+         "\n"
+         "\n"
+         "// -----------------------------------------------------------------------------\n"
+         "// Constants                                                           Constants\n"
+         "// -----------------------------------------------------------------------------\n";
+}
+
+// ----------
+// writeSlots
+// ----------
+/**
+ * @brief  This function writes the slots of a table (two per line).
+ */
+static void writeSlots(ostream& out, const Language& language, const Table& table)
+{
+  out << "\n/// the keywords of \"" << language.name << "\" (indexed by SyntaxHighlighter::keywordSlot())\n"
+      << "static const KeywordSlot " << language.table << "[" << table.slots.size() << "] =\n"
+      << "{\n";
+
+  for(size_t i = 0; i < table.slots.size(); i += 2)
+  {
+    string row = " ";
+
+    for(size_t j = i; (j < i + 2) && (j < table.slots.size()); j++)
+    {
+      const char* word = table.slots[j];
+
+      char entry[64];
+
+      if (word != 0) sprintf(entry, " { \"%s\", %u }", word, static_cast<unsigned>(strlen(word)));
+      else           sprintf(entry, " { 0, 0 }");
+
+      row += entry;
+
+      if (j + 1 < table.slots.size()) row += ",";
+
+      // align the second column
+      if (j == i) row.resize(32, ' ');
+    }
+
+    // no trailing spaces
+    row.erase(row.find_last_not_of(' ') + 1);
+
+    out << row << "\n";
+  }
+
+  out << "};\n";
+}
+
+// -----------
+// writeTables
+// -----------
+/**
+ * @brief  This function writes the table of all languages.
+ */
+static void writeTables(ostream& out, const Table* tables)
+{
+  out << "\n/// the keyword tables (indexed by SyntaxHighlighter::Language)\n"
+      << "static const KeywordTable KEYWORD_TABLES[] =\n"
+      << "{\n";
+
+  for(unsigned l = 0; l < LANGUAGE_COUNT; l++)
+  {
+    char entry[160];
+
+    if (LANGUAGES[l].words != 0)
+    {
+      const Table& table = tables[l];
+
+      sprintf(entry, "  { %s,%*s %4u, { %2u, %2u, %2u, %2u }, %2u }", LANGUAGES[l].table, static_cast<int>(12 - strlen(LANGUAGES[l].table)), "",
+              static_cast<unsigned>(table.slots.size() - 1), table.factor[0], table.factor[1], table.factor[2], table.factor[3],
+              static_cast<unsigned>(table.longest));
+    }
+
+    else
+    {
+      sprintf(entry, "  { 0,            %4u, { %2u, %2u, %2u, %2u }, %2u }", 0u, 0u, 0u, 0u, 0u, 0u);
+    }
+
+    out << entry << ((l + 1 < LANGUAGE_COUNT) ? "," : " ") << "  // " << LANGUAGES[l].name << "\n";
+  }
+
+  out << "};\n"
+         "\n"
+         "#endif  /* #ifndef SYNTAXKEYWORDS_H_INCLUDE_NO1 */\n";
+}
+
+
+// -----------------------------------------------------------------------------
+// Main                                                                     Main
+// -----------------------------------------------------------------------------
+
+// ----
+// main
+// ----
+/**
+ * @brief  The entry point of the generator.
+ */
+int main()
+{
+  Table tables[LANGUAGE_COUNT];
+
+  for(unsigned l = 0; l < LANGUAGE_COUNT; l++)
+  {
+    if (LANGUAGES[l].words == 0) continue;
+
+    if ( !search(LANGUAGES[l].words, tables[l]) )
+    {
+      cerr << LANGUAGES[l].name << ": keywords share a slot whatever the factors are" << endl;
+
+      return 1;
+    }
+  }
+
+  writeHeader(cout);
+
+  for(unsigned l = 0; l < LANGUAGE_COUNT; l++)
+  {
+    if (LANGUAGES[l].words != 0) writeSlots(cout, LANGUAGES[l], tables[l]);
+  }
+
+  writeTables(cout, tables);
+
+  return 0;
+}
@@ -12,9 +12,10 @@
 // -----------------------------------------------------------------------------
 // Includes                                                             Includes
 // -----------------------------------------------------------------------------
-#include <unistd.h>  /* getopt() */
+#include <getopt.h>  /* getopt_long() */
 #include <sstream>   /* optarg to string */
 #include "message.h"
+#include "SyntaxHighlighter.h"
 #include "cli.h"
 
 
@@ -83,23 +84,87 @@ bool cli::parse(int argc, char** argv)
    * v  show version
    * x  show example
    * b  blank
+   * c  compact
    * d  document
    * i  lines in the initial paragraph
+   * j  number of worker threads
+   * m  manifest file
+   * o  output file
    * p  lines in each paragraph
    * s  syntactical character
+   * u  flush output after each paragraph
+   * w  collapse runs of spaces and tabs
    */
-  const char* optstring = ":hvxbdi:p:s:";
+  const char* optstring = ":hvxbcdi:j:m:o:p:s:uw";
+
+  // long options without a short equivalent
+  enum
+  {
+    OPT_SERVE = 256,
+    OPT_CONNECT,
+    OPT_CACHE,
+    OPT_CACHE_LIMIT,
+    OPT_INCREMENTAL,
+    OPT_VERIFY,
+    OPT_STATS,
+    OPT_FORMAT,
+    OPT_EMIT,
+    OPT_HIGHLIGHT,
+    OPT_KEYWORDS,
+    OPT_CHECK,
+    OPT_RECOVER,
+    OPT_LINES,
+    OPT_MEMO
+  };
+
+  // set valid long options
+  /*
+   * serve        answer render requests on the given socket
+   * connect      send stdin as a render request to the given socket
+   * cache        reuse generated code stored in the given directory
+   * cache-limit  the maximum size of the cache directory in MiB
+   * incremental  reuse the unchanged parts of the output file
+   * verify       compare incremental output with a full render
+   * stats        report counters and timings at exit (=json for JSON)
+   * format       the format of the output
+   * emit         write an additional output (FORMAT:FILE)
+   * highlight    color the code of the given language automatically
+   * keywords     color the keywords listed in the given file
+   * check        report incomplete markup without rendering
+   * recover      display lines with incomplete markup as plain code
+   * lines        render only the given line ranges of stdin
+   * memo         reuse the code of repeated lines (MiB per thread)
+   */
+  const option longopts[] =
+  {
+    { "serve",       required_argument, 0, OPT_SERVE       },
+    { "connect",     required_argument, 0, OPT_CONNECT     },
+    { "cache",       required_argument, 0, OPT_CACHE       },
+    { "cache-limit", required_argument, 0, OPT_CACHE_LIMIT },
+    { "incremental", no_argument,       0, OPT_INCREMENTAL },
+    { "verify",      no_argument,       0, OPT_VERIFY      },
+    { "stats",       optional_argument, 0, OPT_STATS       },
+    { "format",      required_argument, 0, OPT_FORMAT      },
+    { "emit",        required_argument, 0, OPT_EMIT        },
+    { "highlight",   required_argument, 0, OPT_HIGHLIGHT   },
+    { "keywords",    required_argument, 0, OPT_KEYWORDS    },
+    { "check",       no_argument,       0, OPT_CHECK       },
+    { "recover",     no_argument,       0, OPT_RECOVER     },
+    { "lines",       required_argument, 0, OPT_LINES       },
+    { "memo",        required_argument, 0, OPT_MEMO        },
+    { 0,             0,                 0, 0               }
+  };
 
   // the ASCII code of the current option character
   int optchar;
 
   // parse all given options
-  while ((optchar = getopt(argc, argv, optstring)) != -1)
+  while ((optchar = getopt_long(argc, argv, optstring, longopts, 0)) != -1)
   {
     // use this object to convert arguments
     stringstream argstream((optarg == 0) ? "" : optarg);
 
-    // analyze (short) options
+    // analyze options
     switch (optchar)
     {
       case 'h':
@@ -134,6 +199,14 @@ bool cli::parse(int argc, char** argv)
         // next argument
         break;
 
+      case 'c':
+
+        // set flag
+        compact = true;
+
+        // next argument
+        break;
+
       case 'd':
 
         // set flag
@@ -157,6 +230,37 @@ bool cli::parse(int argc, char** argv)
         // next argument
         break;
 
+      case 'j':
+
+        // convert string to unsigned
+        if ( !(argstream >> jobs) )
+        {
+          // notify user
+          msg::err( msg::cat("invalid number given: -", int2alnum(optopt)) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case 'm':
+
+        // set manifest file
+        manifest = optarg;
+
+        // next argument
+        break;
+
+      case 'o':
+
+        // set output file
+        output = optarg;
+
+        // next argument
+        break;
+
       case 'p':
 
         // convert string to unsigned
@@ -180,10 +284,217 @@ bool cli::parse(int argc, char** argv)
         // next argument
         break;
 
+      case 'u':
+
+        // set flag
+        interactive = true;
+
+        // next argument
+        break;
+
+      case 'w':
+
+        // set flag
+        compactSpaces = true;
+
+        // next argument
+        break;
+
+      case OPT_SERVE:
+
+        // set operation
+        operation = SERVE;
+
+        // set socket
+        socket = optarg;
+
+        // next argument
+        break;
+
+      case OPT_CONNECT:
+
+        // set operation
+        operation = CONNECT;
+
+        // set socket
+        socket = optarg;
+
+        // next argument
+        break;
+
+      case OPT_CACHE:
+
+        // set cache directory
+        cache = optarg;
+
+        // next argument
+        break;
+
+      case OPT_CACHE_LIMIT:
+
+        // convert string to unsigned
+        if ( !(argstream >> cacheLimit) )
+        {
+          // notify user
+          msg::err("invalid number given: --cache-limit");
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case OPT_INCREMENTAL:
+
+        // set flag
+        incremental = true;
+
+        // next argument
+        break;
+
+      case OPT_VERIFY:
+
+        // set flag
+        verify = true;
+
+        // next argument
+        break;
+
+      case OPT_STATS:
+
+        // set flags
+        stats     = true;
+        statsJson = (optarg != 0) && (string(optarg) == "json");
+
+        // only JSON is supported
+        if ((optarg != 0) && !statsJson)
+        {
+          // notify user
+          msg::err( msg::catq("invalid format given: --stats=", optarg) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case OPT_FORMAT:
+
+        // set output format
+        format = optarg;
+
+        if ( !isFormat(format) )
+        {
+          // notify user
+          msg::err( msg::catq("invalid format given: --format=", optarg) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case OPT_EMIT:
+      {
+        // split FORMAT:FILE
+        string            target(optarg);
+        string::size_type colon = target.find(':');
+
+        if ((colon == string::npos) || !isFormat(target.substr(0, colon)) || (colon + 1 == target.size()))
+        {
+          // notify user
+          msg::err( msg::catq("invalid target given: --emit=", optarg) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // add output
+        emitFormats.push_back( target.substr(0, colon) );
+        emitFiles.push_back( target.substr(colon + 1) );
+
+        // next argument
+        break;
+      }
+
+      case OPT_HIGHLIGHT:
+
+        // set language
+        highlight = optarg;
+
+        if ( !SyntaxHighlighter().setLanguage(highlight) )
+        {
+          // notify user
+          msg::err( msg::catq("invalid language given: --highlight=", optarg) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case OPT_KEYWORDS:
+
+        // set keyword list
+        keywords = optarg;
+
+        // next argument
+        break;
+
+      case OPT_CHECK:
+
+        // set operation
+        operation = CHECK;
+
+        // next argument
+        break;
+
+      case OPT_RECOVER:
+
+        // set flag
+        recover = true;
+
+        // next argument
+        break;
+
+      case OPT_LINES:
+
+        // add ranges
+        if ( !addRanges(optarg) )
+        {
+          // notify user
+          msg::err( msg::catq("invalid range given: --lines=", optarg) );
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
+      case OPT_MEMO:
+
+        // convert string to unsigned
+        if ( !(argstream >> memoLimit) )
+        {
+          // notify user
+          msg::err("invalid number given: --memo");
+
+          // signalize trouble
+          return false;
+        }
+
+        // next argument
+        break;
+
       case ':':
 
         // notify user
-        msg::err( msg::cat("missing argument: -", int2alnum(optopt)) );
+        msg::err( msg::cat("missing argument: ", optionName(argv[optind - 1], optopt)) );
 
         // signalize trouble
         return false;
@@ -191,7 +502,7 @@ bool cli::parse(int argc, char** argv)
       case '?':
 
         // notify user
-        msg::err( msg::cat("unknown option: -", int2alnum(optopt)) );
+        msg::err( msg::cat("unknown option: ", optionName(argv[optind - 1], optopt)) );
 
         // signalize trouble
         return false;
@@ -272,9 +583,116 @@ void cli::reset()
   // flags
   blank             = false;
   document          = false;
+  interactive       = false;
+  compact           = false;
+  compactSpaces     = false;
   synchar           = '!';
   maxLinesInitial   = 0;
   maxLinesParagraph = 0;
+  jobs              = 0;
+  manifest          = "";
+  socket            = "";
+  cache             = "";
+  cacheLimit        = 0;
+  output            = "";
+  incremental       = false;
+  verify            = false;
+  stats             = false;
+  statsJson         = false;
+  format            = "latex";
+  highlight         = "none";
+  keywords          = "";
+  recover           = false;
+  memoLimit         = 0;
+
+  // line ranges
+  rangeFirst.clear();
+  rangeLast.clear();
+
+  // additional outputs
+  emitFormats.clear();
+  emitFiles.clear();
+}
+
+// ----------
+// optionName
+// ----------
+/*
+ * Long options are named as given, short ones by their character.
+ */
+string cli::optionName(const char* arg, int ascii) const
+{
+  if ((ascii == 0) || ((arg[0] == '-') && (arg[1] == '-')))
+  {
+    string name(arg);
+
+    // drop attached argument
+    return name.substr(0, name.find('='));
+  }
+
+  return "-" + int2alnum(ascii);
+}
+
+// --------
+// isFormat
+// --------
+/*
+ *
+ */
+bool cli::isFormat(const string& name) const
+{
+  return (name == "latex") || (name == "html") || (name == "ansi");
+}
+
+// ---------
+// addRanges
+// ---------
+/*
+ *
+ */
+bool cli::addRanges(const string& list)
+{
+  string::size_type begin = 0;
+
+  while (begin <= list.size())
+  {
+    // next comma-separated range
+    string::size_type comma = list.find(',', begin);
+
+    if (comma == string::npos) comma = list.size();
+
+    string range = list.substr(begin, comma - begin);
+
+    // A-B or A
+    string::size_type dash = range.find('-');
+
+    string first = range.substr(0, dash);
+    string last  = (dash == string::npos) ? first : range.substr(dash + 1);
+
+    // digits only (no signs or blanks)
+    if (first.empty() || last.empty()) return false;
+
+    if (first.find_first_not_of("0123456789") != string::npos) return false;
+    if (last.find_first_not_of("0123456789")  != string::npos) return false;
+
+    size_t a = 0;
+    size_t b = 0;
+
+    // too many digits
+    if (!(stringstream(first) >> a) || !(stringstream(last) >> b)) return false;
+
+    // lines start with 1, ranges ascend
+    if ((a == 0) || (b < a)) return false;
+
+    if (!rangeLast.empty() && (a <= rangeLast.back())) return false;
+
+    rangeFirst.push_back(a);
+    rangeLast.push_back(b);
+
+    begin = comma + 1;
+  }
+
+  return true;
 }
 
 // ---------
@@ -19,6 +19,7 @@
 // -----------------------------------------------------------------------------
 // Includes                                                             Includes
 // -----------------------------------------------------------------------------
+#include <cstddef>
 #include <vector>
 #include <string>
 
@@ -44,16 +45,49 @@ public:
     DEFAULT,       ///< execute default operation
     SHOW_HELP,     ///< show help and exit
     SHOW_VERSION,  ///< show version and exit
-    SHOW_EXAMPLE   ///< show example code and exit
+    SHOW_EXAMPLE,  ///< show example code and exit
+    SERVE,         ///< answer render requests on a socket
+    CONNECT,       ///< send a render request to a socket
+    CHECK          ///< check the markup without rendering
   }
   operation;
 
   // flags
   bool        blank;             ///< no background color
   bool        document;          ///< full LaTeX document
+  bool        interactive;       ///< flush output after each paragraph
+  bool        compact;           ///< define colors and layout only once
+  bool        compactSpaces;     ///< collapse runs of spaces and tabs
   char        synchar;           ///< syntactical character
   unsigned    maxLinesInitial;   ///< maximum number of lines in the first paragraph
   unsigned    maxLinesParagraph; ///< maximum number of lines in each paragraph
+  unsigned    jobs;              ///< number of worker threads (0 means automatic)
+  std::string manifest;          ///< file listing input and output files
+  std::string socket;            ///< the socket used by --serve and --connect
+  std::string cache;             ///< the cache directory (empty means none)
+  unsigned    cacheLimit;        ///< the maximum size of the cache in MiB (0 means unlimited)
+  std::string output;            ///< the output file (empty means stdout)
+  bool        incremental;       ///< reuse the unchanged parts of the output file
+  bool        verify;            ///< compare incremental output with a full render
+  bool        stats;             ///< report counters and timings at exit
+  bool        statsJson;         ///< report them as a JSON object
+  std::string format;            ///< the format of the output (latex, html or ansi)
+  std::string highlight;         ///< the language colored automatically (none by default)
+  std::string keywords;          ///< the keyword list (empty means none)
+  bool        recover;           ///< display lines with incomplete markup as plain code
+  unsigned    memoLimit;         ///< the memory for repeated lines in MiB per thread (0 means none)
+
+  /// the formats of the additional outputs (see emitFiles)
+  std::vector< std::string > emitFormats;
+
+  /// the files of the additional outputs
+  std::vector< std::string > emitFiles;
+
+  /// the first line of each range of stdin to render (see rangeLast)
+  std::vector< std::size_t > rangeFirst;
+
+  /// the last line of each range of stdin to render
+  std::vector< std::size_t > rangeLast;
 
   /// the list of positional parameters
   std::vector< std::string > pparams;
@@ -80,7 +114,7 @@ public:
   // parse
   // -----
   /**
-   * @brief  This method uses getopt() to parse the given arguments.
+   * @brief  This method uses getopt_long() to parse the given arguments.
    */
   bool parse(int argc, char** argv);
 
@@ -109,6 +143,37 @@ protected:
    */
   void reset();
 
+  // ----------
+  // optionName
+  // ----------
+  /**
+   * @brief  This method names the option that caused an error.
+   *
+   * @param arg    holds the command-line argument of the option.
+   * @param ascii  holds the option character (0 for long options).
+   */
+  std::string optionName(const char* arg, int ascii) const;
+
+  // --------
+  // isFormat
+  // --------
+  /**
+   * @brief  This method checks whether the given name is a supported
+   *         output format.
+   */
+  bool isFormat(const std::string& name) const;
+
+  // ---------
+  // addRanges
+  // ---------
+  /**
+   * @brief  This method adds the line ranges of a list like "5-9,12,20-30".
+   *
+   * @return  false if the list is invalid or the ranges aren't in
+   *          ascending order without overlap
+   */
+  bool addRanges(const std::string& list);
+
   // ---------
   // int2alnum
   // ---------
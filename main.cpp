@@ -18,10 +18,23 @@
 // -----------------------------------------------------------------------------
 // Includes                                                             Includes
 // -----------------------------------------------------------------------------
+#include <fcntl.h>   /* open() */
+#include <unistd.h>  /* STDIN_FILENO */
+#include <memory>    /* auto_ptr */
 #include <string>
 #include <iostream>
 #include "cli.h"
+#include "message.h"
 #include "LaTeXGenerator.h"
+#include "BatchRenderer.h"
+#include "RenderServer.h"
+#include "RenderClient.h"
+#include "RenderCache.h"
+#include "IncrementalRenderer.h"
+#include "KeywordMatcher.h"
+#include "LineMemo.h"
+#include "MultiRenderer.h"
+#include "MarkupChecker.h"
 
 
 // -----------------------------------------------------------------------------
@@ -50,21 +63,55 @@ void showHelp(const cli& cmdl)
   cout << endl;
   cout << "SYNOPSIS" << endl;
   cout << indent << "parcolor [options]" << endl;
+  cout << indent << "parcolor [options] <FILE>..." << endl;
+  cout << indent << "parcolor [-j <N>] --serve <SOCKET>" << endl;
+  cout << indent << "parcolor [options] --connect <SOCKET>" << endl;
+  cout << indent << "parcolor [-s <A>] [-j <N>] [-m <M>] --check [<FILE>...]" << endl;
   cout << endl;
   cout << "OPTIONS" << endl;
   cout << indent << "-h      show this help screen and exit" << endl;
   cout << indent << "-v      show the program's version end exit" << endl;
   cout << indent << "-x      show an exemplary input file and exit" << endl;
   cout << indent << "-b      no background color" << endl;
+  cout << indent << "-c      define paragraph layout and colors only once" << endl;
   cout << indent << "-d      create complete tex file" << endl;
   cout << indent << "-i <N>  use at most <N> lines in the initial paragraph" << endl;
+  cout << indent << "-j <N>  use <N> worker threads (see below)" << endl;
+  cout << indent << "-m <M>  render all input/output pairs listed in file <M>" << endl;
+  cout << indent << "-o <F>  write to file <F> instead of stdout" << endl;
   cout << indent << "-p <N>  use at most <N> lines in each paragraph" << endl;
   cout << indent << "-s <A>  use <A> as syntactic character ('" << cmdl.synchar << "' by default)" << endl;
+  cout << indent << "-u      flush output after each paragraph" << endl;
+  cout << indent << "-w      collapse runs of spaces and tabs" << endl;
+  cout << indent << "--serve <SOCKET>    answer render requests on Unix socket <SOCKET>" << endl;
+  cout << indent << "--connect <SOCKET>  render stdin on the server listening on <SOCKET>" << endl;
+  cout << indent << "--cache <DIR>       reuse generated code stored in directory <DIR>" << endl;
+  cout << indent << "--cache-limit <N>   keep at most <N> MiB in the cache directory" << endl;
+  cout << indent << "--incremental       rerender only the changed paragraphs of file <F> (see -o)" << endl;
+  cout << indent << "--verify            compare the result of --incremental with a full render" << endl;
+  cout << indent << "--stats[=json]      report counters and timings via stderr at exit" << endl;
+  cout << indent << "--format <FMT>      write format <FMT> instead of LaTeX (latex, html or ansi)" << endl;
+  cout << indent << "--emit <FMT>:<FILE> also write format <FMT> to file <FILE> (repeatable)" << endl;
+  cout << indent << "--highlight <LANG>  color plain code of <LANG> (c, sh, latex, python or ansi)" << endl;
+  cout << indent << "--keywords <FILE>   color the keywords listed in <FILE> (lines of KEYWORD COLOR)" << endl;
+  cout << indent << "--check             report each line with incomplete markup, write nothing" << endl;
+  cout << indent << "--recover           render lines with incomplete markup as plain code" << endl;
+  cout << indent << "--lines <A-B,...>   render only lines <A> to <B> (and further ranges) of stdin" << endl;
+  cout << indent << "--memo <N>          reuse the code of repeated lines (at most <N> MiB per thread)" << endl;
   cout << endl;
   cout << "DESCRIPTION" << endl;
   cout << indent << "parcolor translates the passed input to LaTeX code." << endl;
   cout << indent << "Following sequences will be highlighted: !!COLOR!CODE!!" << endl;
   cout << indent << "All data is read from stdin and written to stdout." << endl;
+  cout << indent << "If files are given, each <FILE> is rendered to <FILE>.tex instead." << endl;
+  cout << indent << "Files are rendered on one thread per processor unless -j is given." << endl;
+  cout << indent << "With -j and -p, the paragraphs of stdin are rendered in parallel." << endl;
+  cout << indent << "With --serve, requests are answered on <N> threads until SIGINT or SIGTERM." << endl;
+  cout << indent << "With --format or --emit, stdin is parsed once for all formats on one thread." << endl;
+  cout << indent << "With --highlight, each input is rendered on one thread." << endl;
+  cout << indent << "With --highlight ansi, SGR colors are kept and other escape sequences dropped." << endl;
+  cout << indent << "With --check, stdin or the input files (not the output files) are checked only." << endl;
+  cout << indent << "With --lines, paragraphs are counted from the first selected line." << endl;
   cout << endl;
 }
 
@@ -114,6 +161,73 @@ void showExample()
   cout << "!!B!\\end!!{!!R!document!!}" << endl;
 }
 
+// ---------
+// openStdin
+// ---------
+/**
+ * @brief  This function attaches a reader to stdin (or to the lines of
+ *         stdin selected by --lines).
+ *
+ * The lines in front of each range are skipped without being looked at,
+ * the selected ones are copied to @p excerpt, so paragraphs are counted
+ * from the beginning of the excerpt.
+ */
+void openStdin(const cli& cmdl, InputReader& reader, string& excerpt)
+{
+  reader.open(STDIN_FILENO);
+
+  if ( cmdl.rangeFirst.empty() ) return;
+
+  // the next unread line
+  size_t line = 1;
+
+  for(vector<size_t>::size_type i = 0; i < cmdl.rangeFirst.size(); i++)
+  {
+    line += reader.skipLines(cmdl.rangeFirst[i] - line);
+
+    // stdin ends in front of the range
+    if (line < cmdl.rangeFirst[i]) break;
+
+    line += reader.copyLines(cmdl.rangeLast[i] - cmdl.rangeFirst[i] + 1, excerpt);
+  }
+
+  reader.open(excerpt.data(), excerpt.size());
+}
+
+// -----------
+// reportStdin
+// -----------
+/**
+ * @brief  This function prints the problems found in stdin with the
+ *         line numbers of stdin (not of the excerpt selected by --lines).
+ */
+void reportStdin(const cli& cmdl, const vector<MarkupChecker::Problem>& problems, bool recovered)
+{
+  vector<MarkupChecker::Problem> located(problems);
+
+  for(vector<MarkupChecker::Problem>::size_type i = 0; i < located.size(); i++)
+  {
+    // the line within the excerpt
+    size_t line = located[i].line;
+
+    for(vector<size_t>::size_type k = 0; k < cmdl.rangeFirst.size(); k++)
+    {
+      size_t count = cmdl.rangeLast[k] - cmdl.rangeFirst[k] + 1;
+
+      if (line <= count)
+      {
+        located[i].line = cmdl.rangeFirst[k] + line - 1;
+
+        break;
+      }
+
+      line -= count;
+    }
+  }
+
+  MarkupChecker::report("stdin", located, recovered);
+}
+
 // ----
 // main
 // ----
@@ -155,6 +269,136 @@ int main(int argc, char** argv)
       showExample();
     }
 
+    // SERVE
+    else if (cmdl.operation == cli::SERVE)
+    {
+      RenderServer server(cmdl.jobs);
+
+      if ( !server.serve(cmdl.socket) )
+      {
+        // signalize trouble
+        return 1;
+      }
+    }
+
+    // CONNECT
+    else if (cmdl.operation == cli::CONNECT)
+    {
+      RenderServer::Request request;
+
+      request.blank         = cmdl.blank;
+      request.document      = cmdl.document;
+      request.compact       = cmdl.compact;
+      request.compactSpaces = cmdl.compactSpaces;
+      request.synchar       = cmdl.synchar;
+      request.maxLinesFirst = cmdl.maxLinesInitial;
+      request.maxLinesEach  = cmdl.maxLinesParagraph;
+
+      // read stdin completely
+      InputReader reader;
+      string      excerpt;
+
+      openStdin(cmdl, reader, excerpt);
+
+      const char* data;
+      size_t      size;
+
+      reader.contents(data, size);
+
+      RenderClient         client;
+      RenderServer::Status status;
+      string               reply;
+
+      if (!client.connect(cmdl.socket) || !client.request(request, data, size, status, reply))
+      {
+        // notify user
+        msg::err( msg::catq("cannot reach server: ", cmdl.socket) );
+
+        // signalize trouble
+        return 1;
+      }
+
+      if (status != RenderServer::OK)
+      {
+        // notify user
+        msg::err(reply);
+
+        // signalize trouble
+        return 1;
+      }
+
+      FdSink sink(STDOUT_FILENO);
+
+      if ( !sink.write(reply.data(), reply.size()) )
+      {
+        // signalize trouble
+        return 1;
+      }
+    }
+
+    // CHECK
+    else if (cmdl.operation == cli::CHECK)
+    {
+      MarkupChecker checker(cmdl.synchar);
+
+      bool success;
+
+      bool batchMode = (!cmdl.pparams.empty() || !cmdl.manifest.empty());
+
+      if (batchMode && !cmdl.rangeFirst.empty())
+      {
+        // notify user
+        msg::err("--lines can't be used with input files");
+
+        // signalize trouble
+        return 1;
+      }
+
+      // batch mode
+      if (batchMode)
+      {
+        BatchRenderer batch;
+
+        // files listed in manifest
+        if (!cmdl.manifest.empty() && !batch.readManifest(cmdl.manifest))
+        {
+          // signalize trouble
+          return 1;
+        }
+
+        // files given on the command-line
+        for(vector<string>::size_type i = 0; i < cmdl.pparams.size(); i++)
+        {
+          batch.add(cmdl.pparams[i], cmdl.pparams[i] + ".tex");
+        }
+
+        // check all files
+        success = batch.check(checker, cmdl.jobs);
+      }
+
+      // filter mode
+      else
+      {
+        InputReader reader;
+        string      excerpt;
+
+        openStdin(cmdl, reader, excerpt);
+
+        vector<MarkupChecker::Problem> problems;
+
+        success = checker.check(reader, problems);
+
+        // notify user
+        reportStdin(cmdl, problems, false);
+      }
+
+      if ( !success )
+      {
+        // signalize trouble
+        return 1;
+      }
+    }
+
     // DEFAULT
     else if (cmdl.operation == cli::DEFAULT)
     {
@@ -164,11 +408,302 @@ int main(int argc, char** argv)
       generator.setSyntaxCharacter(cmdl.synchar);
       generator.enableBackgroundColor(!cmdl.blank);
       generator.enableDocument(cmdl.document);
+      generator.enableInteractive(cmdl.interactive);
+      generator.enableCompact(cmdl.compact);
+      generator.enableCompactSpaces(cmdl.compactSpaces);
       generator.setMaxLinesFirst(cmdl.maxLinesInitial);
       generator.setMaxLinesEach(cmdl.maxLinesParagraph);
+      generator.setLanguage(cmdl.highlight);
+      generator.enableRecover(cmdl.recover);
+
+      // optional counters
+      RenderStats stats;
+
+      if (cmdl.stats)
+      {
+        generator.setStats(&stats);
+
+        stats.start();
+      }
+
+      // optional cache
+      auto_ptr<RenderCache> cache;
+
+      if ( !cmdl.cache.empty() )
+      {
+        cache.reset( new RenderCache(cmdl.cache, static_cast<off_t>(cmdl.cacheLimit) * 1024 * 1024) );
+      }
+
+      else if (cmdl.cacheLimit > 0)
+      {
+        // notify user
+        msg::wrn("--cache-limit has no effect without --cache");
+      }
+
+      // optional memo of repeated lines
+      LineMemo memo(static_cast<size_t>(cmdl.memoLimit) * 1024 * 1024);
+
+      if (cmdl.memoLimit > 0) generator.setMemo(&memo);
+
+      // optional keyword list (compiled once per cache)
+      KeywordMatcher keywords;
+
+      if ( !cmdl.keywords.empty() )
+      {
+        // signalize trouble
+        if ( !keywords.load(cmdl.keywords, cache.get()) ) return 1;
+
+        generator.setKeywords(&keywords);
+      }
+
+      bool success;
+
+      // batch mode
+      bool batchMode = (!cmdl.pparams.empty() || !cmdl.manifest.empty());
+
+      if (cmdl.incremental && (batchMode || cmdl.output.empty()))
+      {
+        // notify user
+        msg::err("--incremental needs an output file (-o) and no input files");
+
+        // signalize trouble
+        return 1;
+      }
+
+      if (cmdl.incremental && (cmdl.highlight != "none"))
+      {
+        // notify user
+        msg::err("--incremental can't be used with --highlight");
+
+        // signalize trouble
+        return 1;
+      }
+
+      if (batchMode && !cmdl.output.empty())
+      {
+        // notify user
+        msg::err("-o can't be used with input files");
+
+        // signalize trouble
+        return 1;
+      }
+
+      if (batchMode && !cmdl.rangeFirst.empty())
+      {
+        // notify user
+        msg::err("--lines can't be used with input files");
+
+        // signalize trouble
+        return 1;
+      }
+
+      // other formats or additional outputs
+      bool multiMode = ((cmdl.format != "latex") || !cmdl.emitFiles.empty());
+
+      if (multiMode && (batchMode || cmdl.incremental || (cache.get() != 0)))
+      {
+        // notify user
+        msg::err("--format and --emit can't be used with input files, --cache or --incremental");
+
+        // signalize trouble
+        return 1;
+      }
+
+      if (multiMode && (cmdl.memoLimit > 0))
+      {
+        // notify user
+        msg::err("--memo can't be used with --format or --emit");
+
+        // signalize trouble
+        return 1;
+      }
+
+      // output of filter mode
+      int fd = STDOUT_FILENO;
+
+      if (!batchMode && !cmdl.incremental && !cmdl.output.empty())
+      {
+        fd = open(cmdl.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+        if (fd < 0)
+        {
+          // notify user
+          msg::err( msg::catq("cannot create output file: ", cmdl.output) );
+
+          // signalize trouble
+          return 1;
+        }
+      }
+
+      if (batchMode)
+      {
+        BatchRenderer batch;
+
+        // files listed in manifest
+        if (!cmdl.manifest.empty() && !batch.readManifest(cmdl.manifest))
+        {
+          // signalize trouble
+          return 1;
+        }
+
+        // files given on the command-line
+        for(vector<string>::size_type i = 0; i < cmdl.pparams.size(); i++)
+        {
+          batch.add(cmdl.pparams[i], cmdl.pparams[i] + ".tex");
+        }
+
+        batch.setCache( cache.get() );
+
+        // generate LaTeX code
+        success = batch.render(generator, cmdl.jobs);
+      }
+
+      // incremental mode
+      else if (cmdl.incremental)
+      {
+        // read stdin completely
+        InputReader reader;
+        reader.setStats( generator.stats() );
+
+        string excerpt;
+
+        openStdin(cmdl, reader, excerpt);
+
+        const char* data;
+        size_t      size;
+
+        reader.contents(data, size);
+
+        IncrementalRenderer renderer(cmdl.output);
+
+        renderer.enableVerify(cmdl.verify);
+
+        // generate changed LaTeX code only
+        success = renderer.render(generator, data, size);
+
+        reportStdin(cmdl, renderer.problems(), cmdl.recover);
+
+        renderer.report();
+      }
+
+      // several formats from one parse
+      else if (multiMode)
+      {
+        MultiRenderer renderer(generator);
+
+        // stdout (or the output file)
+        renderer.add(cmdl.format, fd);
+
+        // additional outputs
+        vector<int> fds;
+
+        success = true;
+
+        for(vector<string>::size_type i = 0; success && (i < cmdl.emitFiles.size()); i++)
+        {
+          int emitFd = open(cmdl.emitFiles[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+          if (emitFd < 0)
+          {
+            // notify user
+            msg::err( msg::catq("cannot create output file: ", cmdl.emitFiles[i]) );
+
+            success = false;
+          }
+
+          else
+          {
+            fds.push_back(emitFd);
+
+            renderer.add(cmdl.emitFormats[i], emitFd);
+          }
+        }
+
+        // generate all formats
+        if (success)
+        {
+          InputReader reader;
+          reader.setStats( generator.stats() );
+
+          string excerpt;
+
+          openStdin(cmdl, reader, excerpt);
+
+          success = renderer.render(reader);
+        }
+
+        reportStdin(cmdl, renderer.problems(), cmdl.recover);
+
+        for(vector<int>::size_type i = 0; i < fds.size(); i++)
+        {
+          if (close(fds[i]) != 0) success = false;
+        }
+      }
+
+      // filter mode with cache
+      else if (cache.get() != 0)
+      {
+        // read stdin completely
+        InputReader reader;
+        reader.setStats( generator.stats() );
+
+        string excerpt;
+
+        openStdin(cmdl, reader, excerpt);
+
+        const char* data;
+        size_t      size;
+
+        reader.contents(data, size);
+
+        // write to stdout (or the output file)
+        FdSink    sink(fd);
+        StatsSink counted(sink, stats);
+
+        bool written;
+
+        // generate LaTeX code (or replay it)
+        if (cmdl.stats) success = cache->render(generator, data, size, counted, written, cmdl.jobs) && written;
+        else            success = cache->render(generator, data, size, sink, written, cmdl.jobs) && written;
+
+        reportStdin(cmdl, generator.problems(), cmdl.recover);
+      }
+
+      // filter mode
+      else
+      {
+        InputReader reader;
+        reader.setStats( generator.stats() );
+
+        string excerpt;
+
+        openStdin(cmdl, reader, excerpt);
+
+        // write to stdout (or the output file)
+        FdSink    sink(fd);
+        StatsSink counted(sink, stats);
+
+        // generate LaTeX code
+        if (cmdl.stats) success = generator.render(reader, counted, cmdl.jobs);
+        else            success = generator.render(reader, sink, cmdl.jobs);
+
+        reportStdin(cmdl, generator.problems(), cmdl.recover);
+      }
+
+      if ((fd != STDOUT_FILENO) && (close(fd) != 0)) success = false;
+
+      // print counters
+      if (cache.get() != 0) cache->report();
+
+      if (cmdl.memoLimit > 0) memo.report();
+
+      if (cmdl.stats)
+      {
+        stats.stop();
+        stats.report(cmdl.statsJson);
+      }
 
-      // generate LaTeX code
-      if ( !generator.parse() ) 
+      if ( !success )
       {
         // signalize trouble
         return 1;